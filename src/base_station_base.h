@@ -16,6 +16,8 @@
 #include "command_type.h"
 #include "viewport_type.h"
 #include "station_map.h"
+#include "order_type.h"
+#include "core/smallvec_type.hpp"
 
 typedef Pool<BaseStation, StationID, 32, 64000> StationPool;
 extern StationPool _station_pool;
@@ -27,6 +29,13 @@ struct StationSpecList {
 };
 
 
+/** An order list with orders to a station, see BaseStation::order_lists. */
+struct StationOrderListRef {
+	OrderList *list;      ///< The order list.
+	uint16 num_orders;    ///< Number of manual orders of the list to the station.
+	uint16 num_implicit;  ///< Number of implicit orders of the list to the station.
+};
+
 /** StationRect - used to track station spread out rectangle - cheaper than scanning whole map */
 struct StationRect : public Rect {
 	enum StationRectMode
@@ -74,6 +83,7 @@ struct BaseStation : StationPool::PoolItem<&_station_pool> {
 
 	TileArea train_station;         ///< Tile area the train 'station' part covers
 	StationRect rect;               ///< NOSAVE: Station spread out rectangle maintained by StationRect::xxx() functions
+	SmallVector<StationOrderListRef, 2> order_lists; ///< NOSAVE: Order lists with orders to this station, see UpdateStationOrderLists()
 
 	/**
 	 * Initialize the base station.
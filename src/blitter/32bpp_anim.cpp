@@ -18,6 +18,12 @@
 /** Instantiation of the 32bpp with animation blitter factory. */
 static FBlitter_32bppAnim iFBlitter_32bppAnim;
 
+Blitter_32bppAnim::~Blitter_32bppAnim()
+{
+	free(this->anim_buf);
+	free(this->anim_lines);
+}
+
 template <BlitterMode mode>
 inline void Blitter_32bppAnim::Draw(const Blitter::BlitterParams *bp, ZoomLevel zoom)
 {
@@ -33,6 +39,8 @@ inline void Blitter_32bppAnim::Draw(const Blitter::BlitterParams *bp, ZoomLevel
 
 	uint32 *dst = (uint32 *)bp->dst + bp->top * bp->pitch + bp->left;
 	uint16 *anim = this->anim_buf + ((uint32 *)bp->dst - (uint32 *)_screen.dst_ptr) + bp->top * this->anim_buf_width + bp->left;
+	const uint16 *anim_first = anim;
+	bool animated = false; // whether any pixel is drawn in an animated colour
 
 	const byte *remap = bp->remap; // store so we don't have to access it via bp everytime
 
@@ -107,6 +115,7 @@ inline void Blitter_32bppAnim::Draw(const Blitter::BlitterParams *bp, ZoomLevel
 							} else {
 								uint r = remap[GB(m, 0, 8)];
 								*anim = r | (m & 0xFF00);
+								if (r >= PALETTE_ANIM_START) animated = true;
 								if (r != 0) *dst = this->AdjustBrightness(this->LookupColourInPalette(r), GB(m, 8, 8));
 							}
 							anim++;
@@ -166,7 +175,12 @@ inline void Blitter_32bppAnim::Draw(const Blitter::BlitterParams *bp, ZoomLevel
 							uint m = GB(*src_n, 0, 8);
 							/* Above PALETTE_ANIM_START is palette animation */
 							*anim++ = *src_n;
-							*dst++ = (m >= PALETTE_ANIM_START) ? this->AdjustBrightness(this->LookupColourInPalette(m), GB(*src_n, 8, 8)) : src_px->data;
+							if (m >= PALETTE_ANIM_START) {
+								*dst++ = this->AdjustBrightness(this->LookupColourInPalette(m), GB(*src_n, 8, 8));
+								animated = true;
+							} else {
+								*dst++ = src_px->data;
+							}
 							src_px++;
 							src_n++;
 						} while (--n != 0);
@@ -193,6 +207,8 @@ inline void Blitter_32bppAnim::Draw(const Blitter::BlitterParams *bp, ZoomLevel
 		src_px = src_px_ln;
 		src_n  = src_n_ln;
 	}
+
+	if (animated) this->MarkAnimated(anim_first, bp->width, bp->height);
 }
 
 void Blitter_32bppAnim::Draw(Blitter::BlitterParams *bp, BlitterMode mode, ZoomLevel zoom)
@@ -260,7 +276,9 @@ void Blitter_32bppAnim::SetPixel(void *video, int x, int y, uint8 colour)
 
 	/* Set the colour in the anim-buffer too, if we are rendering to the screen */
 	if (_screen_disable_anim) return;
-	this->anim_buf[((uint32 *)video - (uint32 *)_screen.dst_ptr) + x + y * this->anim_buf_width] = colour | (DEFAULT_BRIGHTNESS << 8);
+	uint16 *anim = this->anim_buf + ((uint32 *)video - (uint32 *)_screen.dst_ptr) + x + y * this->anim_buf_width;
+	*anim = colour | (DEFAULT_BRIGHTNESS << 8);
+	if (colour >= PALETTE_ANIM_START) this->MarkAnimated(anim, 1, 1);
 }
 
 void Blitter_32bppAnim::DrawRect(void *video, int width, int height, uint8 colour)
@@ -275,6 +293,7 @@ void Blitter_32bppAnim::DrawRect(void *video, int width, int height, uint8 colou
 	uint16 *anim_line;
 
 	anim_line = ((uint32 *)video - (uint32 *)_screen.dst_ptr) + this->anim_buf;
+	if (colour >= PALETTE_ANIM_START) this->MarkAnimated(anim_line, width, height);
 
 	do {
 		uint32 *dst = (uint32 *)video;
@@ -299,8 +318,10 @@ void Blitter_32bppAnim::CopyFromBuffer(void *video, const void *src, int width,
 	uint32 *dst = (uint32 *)video;
 	const uint32 *usrc = (const uint32 *)src;
 	uint16 *anim_line = ((uint32 *)video - (uint32 *)_screen.dst_ptr) + this->anim_buf;
+	const uint16 *anim_first = anim_line;
+	bool animated = false;
 
-	for (; height > 0; height--) {
+	for (int y = height; y > 0; y--) {
 		/* We need to keep those for palette animation. */
 		uint32 *dst_pal = dst;
 		uint16 *anim_pal = anim_line;
@@ -321,15 +342,13 @@ void Blitter_32bppAnim::CopyFromBuffer(void *video, const void *src, int width,
 		 * for just the cursor. This just copies the implementation of
 		 * palette animation, much cheaper though slightly nastier. */
 		for (int i = 0; i < width; i++) {
-			uint colour = GB(*anim_pal, 0, 8);
-			if (colour >= PALETTE_ANIM_START) {
-				/* Update this pixel */
-				*dst_pal = this->AdjustBrightness(LookupColourInPalette(colour), GB(*anim_pal, 8, 8));
-			}
+			if (this->PaletteAnimatePixel(dst_pal, *anim_pal)) animated = true;
 			dst_pal++;
 			anim_pal++;
 		}
 	}
+
+	if (animated) this->MarkAnimated(anim_first, width, height);
 }
 
 void Blitter_32bppAnim::CopyToBuffer(const void *video, void *dst, int width, int height)
@@ -403,6 +422,24 @@ void Blitter_32bppAnim::ScrollBuffer(void *video, int &left, int &top, int &widt
 		}
 	}
 
+	/* The animated parts of the scrolled lines move along; as the ranges
+	 * only have to contain all animated pixels, merge them with the ranges
+	 * already there. Process the lines in the same order as above, so the
+	 * ranges of the source lines are used before they are changed. */
+	int first = scroll_y > 0 ? top + height - 1 : top;
+	int step = scroll_y > 0 ? -1 : 1;
+	for (int th = height - abs(scroll_y), y = first; th > 0; th--, y += step) {
+		const AnimLine *src_line = &this->anim_lines[y - scroll_y];
+		AnimLine *dst_line = &this->anim_lines[y];
+
+		int line_left = max(max(src_line->left, left) + scroll_x, left);
+		int line_right = min(min(src_line->right, left + width) + scroll_x, left + width);
+		if (line_left >= line_right) continue;
+
+		if (dst_line->left > line_left) dst_line->left = line_left;
+		if (dst_line->right < line_right) dst_line->right = line_right;
+	}
+
 	Blitter_32bppBase::ScrollBuffer(video, left, top, width, height, scroll_x, scroll_y);
 }
 
@@ -421,25 +458,50 @@ void Blitter_32bppAnim::PaletteAnimate(const Palette &palette)
 	 *  Especially when going between toyland and non-toyland. */
 	assert(this->palette.first_dirty == PALETTE_ANIM_START || this->palette.first_dirty == 0);
 
-	const uint16 *anim = this->anim_buf;
-	uint32 *dst = (uint32 *)_screen.dst_ptr;
+	/* Only walk the parts of the anim buffer that may contain animated pixels */
+	int left = this->anim_buf_width;
+	int top = this->anim_buf_height;
+	int right = 0;
+	int bottom = 0;
+	for (int y = 0; y < this->anim_buf_height; y++) {
+		const AnimLine *line = &this->anim_lines[y];
+		if (line->left >= line->right) continue;
+
+		this->PaletteAnimateLine(y);
+		if (line->left >= line->right) continue;
+
+		left = min(left, line->left);
+		right = max(right, line->right);
+		top = min(top, y);
+		bottom = y + 1;
+	}
 
-	/* Let's walk the anim buffer and try to find the pixels */
-	for (int y = this->anim_buf_height; y != 0 ; y--) {
-		for (int x = this->anim_buf_width; x != 0 ; x--) {
-			uint colour = GB(*anim, 0, 8);
-			if (colour >= PALETTE_ANIM_START) {
-				/* Update this pixel */
-				*dst = this->AdjustBrightness(LookupColourInPalette(colour), GB(*anim, 8, 8));
-			}
-			dst++;
-			anim++;
-		}
-		dst += _screen.pitch - this->anim_buf_width;
+	/* Make sure the backend redraws the animated part of the screen */
+	if (left < right) _video_driver->MakeDirty(left, top, right - left, bottom - top);
+}
+
+/**
+ * Update the pixels in animated colours of a line of the screen, and
+ * shrink the range of the line that may contain them to the pixels found.
+ * @param y The line to update.
+ */
+void Blitter_32bppAnim::PaletteAnimateLine(int y)
+{
+	AnimLine *line = &this->anim_lines[y];
+	const uint16 *anim = this->anim_buf + y * this->anim_buf_width;
+	uint32 *dst = (uint32 *)_screen.dst_ptr + y * _screen.pitch;
+
+	int left = this->anim_buf_width;
+	int right = 0;
+	for (int x = line->left; x < min(line->right, this->anim_buf_width); x++) {
+		if (!this->PaletteAnimatePixel(dst + x, anim[x])) continue;
+
+		if (left > x) left = x;
+		right = x + 1;
 	}
 
-	/* Make sure the backend redraws the whole screen */
-	_video_driver->MakeDirty(0, 0, _screen.width, _screen.height);
+	line->left = left;
+	line->right = right;
 }
 
 Blitter::PaletteAnimation Blitter_32bppAnim::UsePaletteAnimation()
@@ -452,8 +514,16 @@ void Blitter_32bppAnim::PostResize()
 	if (_screen.width != this->anim_buf_width || _screen.height != this->anim_buf_height) {
 		/* The size of the screen changed; we can assume we can wipe all data from our buffer */
 		free(this->anim_buf);
+		free(this->anim_lines);
 		this->anim_buf = CallocT<uint16>(_screen.width * _screen.height);
+		this->anim_lines = MallocT<AnimLine>(_screen.height);
 		this->anim_buf_width = _screen.width;
 		this->anim_buf_height = _screen.height;
+
+		/* Nothing is animated in the cleared buffer */
+		for (int y = 0; y < this->anim_buf_height; y++) {
+			this->anim_lines[y].left = this->anim_buf_width;
+			this->anim_lines[y].right = 0;
+		}
 	}
 }
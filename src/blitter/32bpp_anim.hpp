@@ -15,20 +15,65 @@
 #include "32bpp_optimized.hpp"
 
 /** The optimised 32 bpp blitter with palette animation. */
-class Blitter_32bppAnim FINAL : public Blitter_32bppOptimized {
-private:
+class Blitter_32bppAnim : public Blitter_32bppOptimized {
+protected:
+	/** Horizontal range of a line of the screen that may contain pixels in animated colours. */
+	struct AnimLine {
+		int left;  ///< First pixel of the range.
+		int right; ///< One past the last pixel of the range; the range is empty when it is not larger than left.
+	};
+
 	uint16 *anim_buf;    ///< In this buffer we keep track of the 8bpp indexes so we can do palette animation
+	AnimLine *anim_lines; ///< For every line of the animation buffer, the part that may have to be animated.
 	int anim_buf_width;  ///< The width of the animation buffer.
 	int anim_buf_height; ///< The height of the animation buffer.
 	Palette palette;     ///< The current palette.
 
+	/**
+	 * Mark a rectangle of the screen as possibly containing pixels in animated colours.
+	 * @param anim   The entry in the animation buffer of the top left pixel.
+	 * @param width  The width of the rectangle.
+	 * @param height The height of the rectangle.
+	 */
+	inline void MarkAnimated(const uint16 *anim, int width, int height)
+	{
+		int offset = (int)(anim - this->anim_buf);
+		int left = offset % this->anim_buf_width;
+		int right = left + width;
+
+		for (AnimLine *line = this->anim_lines + offset / this->anim_buf_width; height > 0; height--, line++) {
+			if (line->left > left) line->left = left;
+			if (line->right < right) line->right = right;
+		}
+	}
+
+	/**
+	 * Update a pixel of the screen if it is drawn in an animated colour.
+	 * @param dst  The pixel on the screen.
+	 * @param anim The entry of the pixel in the animation buffer.
+	 * @return True iff the pixel is drawn in an animated colour.
+	 */
+	inline bool PaletteAnimatePixel(uint32 *dst, uint16 anim)
+	{
+		uint colour = GB(anim, 0, 8);
+		if (colour < PALETTE_ANIM_START) return false;
+
+		*dst = this->AdjustBrightness(this->LookupColourInPalette(colour), GB(anim, 8, 8));
+		return true;
+	}
+
+	virtual void PaletteAnimateLine(int y);
+
 public:
 	Blitter_32bppAnim() :
 		anim_buf(NULL),
+		anim_lines(NULL),
 		anim_buf_width(0),
 		anim_buf_height(0)
 	{}
 
+	~Blitter_32bppAnim();
+
 	/* virtual */ void Draw(Blitter::BlitterParams *bp, BlitterMode mode, ZoomLevel zoom);
 	/* virtual */ void DrawColourMappingRect(void *dst, int width, int height, PaletteID pal);
 	/* virtual */ void SetPixel(void *video, int x, int y, uint8 colour);
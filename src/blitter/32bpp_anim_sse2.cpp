@@ -0,0 +1,233 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file 32bpp_anim_sse2.cpp Implementation of the SSE2 32 bpp blitter with animation support. */
+
+#include "../stdafx.h"
+#include "../video/video_driver.hpp"
+#include "32bpp_anim_sse2.hpp"
+
+#ifdef WITH_SSE2_BLITTER
+
+/** Instantiation of the SSE2 32bpp with animation blitter factory. */
+static FBlitter_32bppSSE2_Anim iFBlitter_32bppSSE2_Anim;
+
+/**
+ * Draws a sprite to the screen and the animation buffer.
+ * Only #BM_NORMAL and #BM_TRANSPARENT are supported; colour remapping is done per pixel anyway.
+ *
+ * @tparam mode blitter mode
+ * @param bp further blitting parameters
+ * @param zoom zoom level at which we are drawing
+ */
+template <BlitterMode mode>
+inline void Blitter_32bppSSE2_Anim::Draw(const Blitter::BlitterParams *bp, ZoomLevel zoom)
+{
+	assert_compile(mode == BM_NORMAL || mode == BM_TRANSPARENT);
+
+	const SpriteData *src = (const SpriteData *)bp->sprite;
+
+	const Colour *src_px = (const Colour *)(src->data + src->offset[zoom][0]);
+	const uint16 *src_n  = (const uint16 *)(src->data + src->offset[zoom][1]);
+
+	for (uint i = bp->skip_top; i != 0; i--) {
+		src_px = (const Colour *)((const byte *)src_px + *(const uint32 *)src_px);
+		src_n  = (const uint16 *)((const byte *)src_n  + *(const uint32 *)src_n);
+	}
+
+	uint32 *dst = (uint32 *)bp->dst + bp->top * bp->pitch + bp->left;
+	uint16 *anim = this->anim_buf + ((uint32 *)bp->dst - (uint32 *)_screen.dst_ptr) + bp->top * this->anim_buf_width + bp->left;
+	const uint16 *anim_first = anim;
+	bool animated = false; // whether any pixel is drawn in an animated colour
+
+	for (int y = 0; y < bp->height; y++) {
+		uint32 *dst_ln = dst + bp->pitch;
+		uint16 *anim_ln = anim + this->anim_buf_width;
+
+		const Colour *src_px_ln = (const Colour *)((const byte *)src_px + *(const uint32 *)src_px);
+		src_px++;
+
+		const uint16 *src_n_ln = (const uint16 *)((const byte *)src_n + *(const uint32 *)src_n);
+		src_n += 2;
+
+		uint32 *dst_end = dst + bp->skip_left;
+
+		uint n;
+
+		while (dst < dst_end) {
+			n = *src_n++;
+
+			if (src_px->a == 0) {
+				dst += n;
+				src_px ++;
+				src_n++;
+
+				if (dst > dst_end) anim += dst - dst_end;
+			} else {
+				if (dst + n > dst_end) {
+					uint d = dst_end - dst;
+					src_px += d;
+					src_n += d;
+
+					dst = dst_end - bp->skip_left;
+					dst_end = dst + bp->width;
+
+					n = min<uint>(n - d, (uint)bp->width);
+					goto draw;
+				}
+				dst += n;
+				src_px += n;
+				src_n += n;
+			}
+		}
+
+		dst -= bp->skip_left;
+		dst_end -= bp->skip_left;
+
+		dst_end += bp->width;
+
+		while (dst < dst_end) {
+			n = min<uint>(*src_n++, (uint)(dst_end - dst));
+
+			if (src_px->a == 0) {
+				anim += n;
+				dst += n;
+				src_px++;
+				src_n++;
+				continue;
+			}
+
+			draw:;
+
+			switch (mode) {
+				case BM_TRANSPARENT:
+					/* Make the current colour a bit more black, so it looks like this image is transparent */
+					if (src_px->a == 255) {
+						Blitter_32bppSSE2_Base::DarkenPixels(dst, n);
+					} else {
+						Blitter_32bppSSE2_Base::DarkenPixels(dst, src_px, n);
+					}
+					memset(anim, 0, n * sizeof(*anim));
+					anim += n;
+					dst += n;
+					src_px += n;
+					src_n += n;
+					break;
+
+				default:
+					if (src_px->a == 255) {
+						/* Above PALETTE_ANIM_START is palette animation */
+						memcpy(anim, src_n, n * sizeof(*anim));
+						anim += n;
+						for (; n >= 4 && !HasAnimatedColour(src_n); n -= 4) {
+							Blitter_32bppSSE2_Base::CopyPixels(dst, src_px, 4);
+							dst += 4;
+							src_px += 4;
+							src_n += 4;
+						}
+						for (; n != 0; n--) {
+							uint m = GB(*src_n, 0, 8);
+							if (m >= PALETTE_ANIM_START) {
+								*dst++ = this->AdjustBrightness(this->LookupColourInPalette(m), GB(*src_n, 8, 8));
+								animated = true;
+							} else {
+								*dst++ = src_px->data;
+							}
+							src_px++;
+							src_n++;
+						}
+					} else {
+						memset(anim, 0, n * sizeof(*anim));
+						anim += n;
+						for (; n >= 4 && !HasAnimatedColour(src_n); n -= 4) {
+							Blitter_32bppSSE2_Base::BlendPixels(dst, src_px, 4);
+							dst += 4;
+							src_px += 4;
+							src_n += 4;
+						}
+						for (; n != 0; n--) {
+							uint m = GB(*src_n, 0, 8);
+							if (m >= PALETTE_ANIM_START) {
+								*dst = ComposeColourPANoCheck(this->AdjustBrightness(this->LookupColourInPalette(m), GB(*src_n, 8, 8)), src_px->a, *dst);
+							} else {
+								*dst = ComposeColourRGBANoCheck(src_px->r, src_px->g, src_px->b, src_px->a, *dst);
+							}
+							dst++;
+							src_px++;
+							src_n++;
+						}
+					}
+					break;
+			}
+		}
+
+		anim = anim_ln;
+		dst = dst_ln;
+		src_px = src_px_ln;
+		src_n  = src_n_ln;
+	}
+
+	if (animated) this->MarkAnimated(anim_first, bp->width, bp->height);
+}
+
+void Blitter_32bppSSE2_Anim::Draw(Blitter::BlitterParams *bp, BlitterMode mode, ZoomLevel zoom)
+{
+	if (_screen_disable_anim) {
+		/* This means our output is not to the screen, so we can't be doing any animation stuff, so use the plain SSE2 blitter */
+		if (mode == BM_COLOUR_REMAP) {
+			Blitter_32bppOptimized::Draw(bp, mode, zoom);
+		} else {
+			Blitter_32bppSSE2_Base::Draw(bp, mode, zoom);
+		}
+		return;
+	}
+
+	switch (mode) {
+		default: NOT_REACHED();
+		case BM_NORMAL:       Draw<BM_NORMAL>     (bp, zoom); return;
+		case BM_COLOUR_REMAP: Blitter_32bppAnim::Draw(bp, mode, zoom); return;
+		case BM_TRANSPARENT:  Draw<BM_TRANSPARENT>(bp, zoom); return;
+	}
+}
+
+void Blitter_32bppSSE2_Anim::PaletteAnimateLine(int y)
+{
+	AnimLine *line = &this->anim_lines[y];
+	const uint16 *anim = this->anim_buf + y * this->anim_buf_width;
+	uint32 *dst = (uint32 *)_screen.dst_ptr + y * _screen.pitch;
+
+	const __m128i colour_mask = _mm_set1_epi16(0xFF);
+	const __m128i last_static_colour = _mm_set1_epi16(PALETTE_ANIM_START - 1);
+
+	int left = this->anim_buf_width;
+	int right = 0;
+	int end = min(line->right, this->anim_buf_width);
+	for (int x = line->left; x < end;) {
+		/* Skip eight pixels at a time while none of them is animated */
+		if (x + 8 <= end) {
+			__m128i colours = _mm_and_si128(_mm_loadu_si128((const __m128i *)(anim + x)), colour_mask);
+			if (_mm_movemask_epi8(_mm_cmpgt_epi16(colours, last_static_colour)) == 0) {
+				x += 8;
+				continue;
+			}
+		}
+
+		for (int group_end = min(x + 8, end); x < group_end; x++) {
+			if (!this->PaletteAnimatePixel(dst + x, anim[x])) continue;
+
+			if (left > x) left = x;
+			right = x + 1;
+		}
+	}
+
+	line->left = left;
+	line->right = right;
+}
+
+#endif /* WITH_SSE2_BLITTER */
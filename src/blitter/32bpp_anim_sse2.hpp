@@ -0,0 +1,56 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file 32bpp_anim_sse2.hpp A SSE2 32 bpp blitter with animation support. */
+
+#ifndef BLITTER_32BPP_ANIM_SSE2_HPP
+#define BLITTER_32BPP_ANIM_SSE2_HPP
+
+#include "32bpp_sse2.hpp"
+
+#ifdef WITH_SSE2_BLITTER
+
+#include "32bpp_anim.hpp"
+
+/** The optimised 32 bpp blitter with palette animation, using SSE2 instructions. */
+class Blitter_32bppSSE2_Anim FINAL : public Blitter_32bppAnim {
+protected:
+	/* virtual */ void PaletteAnimateLine(int y);
+
+public:
+	/* virtual */ void Draw(Blitter::BlitterParams *bp, BlitterMode mode, ZoomLevel zoom);
+
+	/* virtual */ const char *GetName() { return "32bpp-sse2-anim"; }
+
+	/**
+	 * Check whether any of four pixels is drawn in an animated palette colour.
+	 * @param src_n The 'm' channel of the pixels.
+	 * @return True iff any of the pixels is animated.
+	 */
+	static inline bool HasAnimatedColour(const uint16 *src_n)
+	{
+		__m128i m = _mm_and_si128(_mm_loadl_epi64((const __m128i *)src_n), _mm_set1_epi16(0xFF));
+		return _mm_movemask_epi8(_mm_cmpgt_epi16(m, _mm_set1_epi16(PALETTE_ANIM_START - 1))) != 0;
+	}
+
+	template <BlitterMode mode> void Draw(const Blitter::BlitterParams *bp, ZoomLevel zoom);
+};
+
+/** Factory for the SSE2 32bpp blitter with animation. */
+class FBlitter_32bppSSE2_Anim: public BlitterFactory<FBlitter_32bppSSE2_Anim> {
+public:
+	/* virtual */ const char *GetName() { return "32bpp-sse2-anim"; }
+	/* virtual */ const char *GetDescription() { return "32bpp SSE2 Animation Blitter (palette animation)"; }
+	/* virtual */ Blitter *CreateInstance() { return new Blitter_32bppSSE2_Anim(); }
+	/* virtual */ bool IsUsable() { return Blitter_32bppSSE2_Base::IsCPUSupported(); }
+};
+
+#endif /* WITH_SSE2_BLITTER */
+
+#endif /* BLITTER_32BPP_ANIM_SSE2_HPP */
@@ -11,7 +11,6 @@
 
 #include "../stdafx.h"
 #include "../zoom_func.h"
-#include "../settings_type.h"
 #include "32bpp_optimized.hpp"
 
 /** Instantiation of the optimized 32bpp blitter factory. */
@@ -207,7 +206,7 @@ void Blitter_32bppOptimized::Draw(Blitter::BlitterParams *bp, BlitterMode mode,
 	}
 }
 
-Sprite *Blitter_32bppOptimized::Encode(SpriteLoader::Sprite *sprite, AllocatorProc *allocator)
+Sprite *Blitter_32bppOptimized::Encode(SpriteLoader::Sprite *sprite, AllocatorProc *allocator, uint8 zoom_levels)
 {
 	/* streams of pixels (a, r, g, b channels)
 	 *
@@ -225,19 +224,9 @@ Sprite *Blitter_32bppOptimized::Encode(SpriteLoader::Sprite *sprite, AllocatorPr
 	/* lengths of streams */
 	uint32 lengths[ZOOM_LVL_COUNT][2];
 
-	ZoomLevel zoom_min;
-	ZoomLevel zoom_max;
+	for (ZoomLevel z = ZOOM_LVL_BEGIN; z != ZOOM_LVL_END; z++) {
+		if (!HasBit(zoom_levels, z)) continue;
 
-	if (sprite->type == ST_FONT) {
-		zoom_min = ZOOM_LVL_NORMAL;
-		zoom_max = ZOOM_LVL_NORMAL;
-	} else {
-		zoom_min = _settings_client.gui.zoom_min;
-		zoom_max = _settings_client.gui.zoom_max;
-		if (zoom_max == zoom_min) zoom_max = ZOOM_LVL_MAX;
-	}
-
-	for (ZoomLevel z = zoom_min; z <= zoom_max; z++) {
 		const SpriteLoader::Sprite *src_orig = &sprite[z];
 
 		uint size = src_orig->height * src_orig->width;
@@ -325,8 +314,8 @@ Sprite *Blitter_32bppOptimized::Encode(SpriteLoader::Sprite *sprite, AllocatorPr
 	}
 
 	uint len = 0; // total length of data
-	for (ZoomLevel z = zoom_min; z <= zoom_max; z++) {
-		len += lengths[z][0] + lengths[z][1];
+	for (ZoomLevel z = ZOOM_LVL_BEGIN; z != ZOOM_LVL_END; z++) {
+		if (HasBit(zoom_levels, z)) len += lengths[z][0] + lengths[z][1];
 	}
 
 	Sprite *dest_sprite = (Sprite *)allocator(sizeof(*dest_sprite) + sizeof(SpriteData) + len);
@@ -339,9 +328,13 @@ Sprite *Blitter_32bppOptimized::Encode(SpriteLoader::Sprite *sprite, AllocatorPr
 	SpriteData *dst = (SpriteData *)dest_sprite->data;
 	memset(dst, 0, sizeof(*dst));
 
-	for (ZoomLevel z = zoom_min; z <= zoom_max; z++) {
-		dst->offset[z][0] = z == zoom_min ? 0 : lengths[z - 1][1] + dst->offset[z - 1][1];
+	uint offset = 0;
+	for (ZoomLevel z = ZOOM_LVL_BEGIN; z != ZOOM_LVL_END; z++) {
+		if (!HasBit(zoom_levels, z)) continue;
+
+		dst->offset[z][0] = offset;
 		dst->offset[z][1] = lengths[z][0] + dst->offset[z][0];
+		offset = lengths[z][1] + dst->offset[z][1];
 
 		memcpy(dst->data + dst->offset[z][0], dst_px_orig[z], lengths[z][0]);
 		memcpy(dst->data + dst->offset[z][1], dst_n_orig[z],  lengths[z][1]);
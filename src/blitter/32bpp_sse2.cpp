@@ -0,0 +1,165 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file 32bpp_sse2.cpp Implementation of the SSE2 32 bpp blitter. */
+
+#include "../stdafx.h"
+#include "32bpp_sse2.hpp"
+
+#ifdef WITH_SSE2_BLITTER
+
+/** Instantiation of the SSE2 32bpp blitter factory. */
+static FBlitter_32bppSSE2 iFBlitter_32bppSSE2;
+
+/**
+ * Draws a sprite in the format of the optimised 32 bpp blitter to a (screen) buffer.
+ * Only #BM_NORMAL and #BM_TRANSPARENT are supported, as only those do not depend on the palette.
+ *
+ * @tparam mode blitter mode
+ * @param bp further blitting parameters
+ * @param zoom zoom level at which we are drawing
+ */
+template <BlitterMode mode>
+inline void Blitter_32bppSSE2_Base::Draw(const Blitter::BlitterParams *bp, ZoomLevel zoom)
+{
+	assert_compile(mode == BM_NORMAL || mode == BM_TRANSPARENT);
+
+	const Blitter_32bppOptimized::SpriteData *src = (const Blitter_32bppOptimized::SpriteData *)bp->sprite;
+
+	/* For the layout of the streams, see Blitter_32bppOptimized::Draw. */
+	const Colour *src_px = (const Colour *)(src->data + src->offset[zoom][0]);
+	const uint16 *src_n  = (const uint16 *)(src->data + src->offset[zoom][1]);
+
+	/* skip upper lines in src_px and src_n */
+	for (uint i = bp->skip_top; i != 0; i--) {
+		src_px = (const Colour *)((const byte *)src_px + *(const uint32 *)src_px);
+		src_n = (const uint16 *)((const byte *)src_n + *(const uint32 *)src_n);
+	}
+
+	/* skip lines in dst */
+	uint32 *dst = (uint32 *)bp->dst + bp->top * bp->pitch + bp->left;
+
+	for (int y = 0; y < bp->height; y++) {
+		/* next dst line begins here */
+		uint32 *dst_ln = dst + bp->pitch;
+
+		/* next src line begins here */
+		const Colour *src_px_ln = (const Colour *)((const byte *)src_px + *(const uint32 *)src_px);
+		src_px++;
+
+		/* next src_n line begins here */
+		const uint16 *src_n_ln = (const uint16 *)((const byte *)src_n + *(const uint32 *)src_n);
+		src_n += 2;
+
+		/* we will end this line when we reach this point */
+		uint32 *dst_end = dst + bp->skip_left;
+
+		/* number of pixels with the same aplha channel class */
+		uint n;
+
+		while (dst < dst_end) {
+			n = *src_n++;
+
+			if (src_px->a == 0) {
+				dst += n;
+				src_px ++;
+				src_n++;
+			} else {
+				if (dst + n > dst_end) {
+					uint d = dst_end - dst;
+					src_px += d;
+					src_n += d;
+
+					dst = dst_end - bp->skip_left;
+					dst_end = dst + bp->width;
+
+					n = min<uint>(n - d, (uint)bp->width);
+					goto draw;
+				}
+				dst += n;
+				src_px += n;
+				src_n += n;
+			}
+		}
+
+		dst -= bp->skip_left;
+		dst_end -= bp->skip_left;
+
+		dst_end += bp->width;
+
+		while (dst < dst_end) {
+			n = min<uint>(*src_n++, (uint)(dst_end - dst));
+
+			if (src_px->a == 0) {
+				dst += n;
+				src_px++;
+				src_n++;
+				continue;
+			}
+
+			draw:;
+
+			switch (mode) {
+				case BM_TRANSPARENT:
+					/* Make the current colour a bit more black, so it looks like this image is transparent */
+					if (src_px->a == 255) {
+						DarkenPixels(dst, n);
+					} else {
+						DarkenPixels(dst, src_px, n);
+					}
+					break;
+
+				default:
+					if (src_px->a == 255) {
+						CopyPixels(dst, src_px, n);
+					} else {
+						BlendPixels(dst, src_px, n);
+					}
+					break;
+			}
+
+			dst += n;
+			src_px += n;
+			src_n += n;
+		}
+
+		dst = dst_ln;
+		src_px = src_px_ln;
+		src_n  = src_n_ln;
+	}
+}
+
+/**
+ * Draws a sprite in the format of the optimised 32 bpp blitter to a (screen) buffer.
+ * Calls adequate templated function.
+ *
+ * @param bp further blitting parameters
+ * @param mode blitter mode, either #BM_NORMAL or #BM_TRANSPARENT
+ * @param zoom zoom level at which we are drawing
+ */
+void Blitter_32bppSSE2_Base::Draw(const Blitter::BlitterParams *bp, BlitterMode mode, ZoomLevel zoom)
+{
+	switch (mode) {
+		default: NOT_REACHED();
+		case BM_NORMAL:      Draw<BM_NORMAL>     (bp, zoom); return;
+		case BM_TRANSPARENT: Draw<BM_TRANSPARENT>(bp, zoom); return;
+	}
+}
+
+void Blitter_32bppSSE2::Draw(Blitter::BlitterParams *bp, BlitterMode mode, ZoomLevel zoom)
+{
+	/* Remapping looks up every pixel in the palette; there is nothing to gain there. */
+	if (mode == BM_COLOUR_REMAP) {
+		Blitter_32bppOptimized::Draw(bp, mode, zoom);
+	} else {
+		Blitter_32bppSSE2_Base::Draw(bp, mode, zoom);
+	}
+}
+
+#endif /* WITH_SSE2_BLITTER */
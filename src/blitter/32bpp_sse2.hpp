@@ -0,0 +1,178 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file 32bpp_sse2.hpp SSE2 32 bpp blitter. */
+
+#ifndef BLITTER_32BPP_SSE2_HPP
+#define BLITTER_32BPP_SSE2_HPP
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+/** The compiler can generate SSE2 instructions, so the SSE2 blitters can be built. */
+#define WITH_SSE2_BLITTER
+
+#include "32bpp_optimized.hpp"
+#include "../cpu.h"
+#include <emmintrin.h>
+
+/**
+ * Drawing of runs of pixels in the sprite format of the optimised 32 bpp
+ * blitter, four pixels at a time. The results are exactly the same as those
+ * of the colour functions of #Blitter_32bppBase.
+ */
+class Blitter_32bppSSE2_Base {
+public:
+	/**
+	 * Check whether the CPU supports SSE2.
+	 * @return True iff SSE2 instructions can be used.
+	 */
+	static inline bool IsCPUSupported()
+	{
+		return HasCPUIDFlag(1, 3, 26);
+	}
+
+	/**
+	 * Copy opaque pixels to the screen.
+	 * @param dst The first pixel on the screen.
+	 * @param src The first pixel to copy.
+	 * @param n   The number of pixels.
+	 */
+	static inline void CopyPixels(uint32 *dst, const Colour *src, uint n)
+	{
+		for (; n >= 4; n -= 4, dst += 4, src += 4) {
+			_mm_storeu_si128((__m128i *)dst, _mm_loadu_si128((const __m128i *)src));
+		}
+		for (; n != 0; n--) *dst++ = (src++)->data;
+	}
+
+	/**
+	 * Blend two pixels, unpacked to 16 bits per channel, with the screen.
+	 * The difference of both colours is scaled by alpha / 256 and rounded
+	 * down. #Blitter_32bppBase::ComposeColourRGBANoCheck rounds down too:
+	 * its multiplication by the unsigned alpha is done unsigned, and of the
+	 * wrapped quotient only the low byte is kept.
+	 * @param src The pixels to draw.
+	 * @param dst The pixels on the screen.
+	 * @return The blended pixels; the alpha channel is undefined.
+	 */
+	static inline __m128i BlendTwoPixels(__m128i src, __m128i dst)
+	{
+		__m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src, 0xFF), 0xFF);
+		__m128i diff  = _mm_sub_epi16(src, dst);
+		/* (diff * 128 * alpha * 2) >> 16 == (diff * alpha) >> 8, without overflowing 16 bits. */
+		return _mm_add_epi16(dst, _mm_mulhi_epi16(_mm_slli_epi16(diff, 7), _mm_slli_epi16(alpha, 1)));
+	}
+
+	/**
+	 * Blend semi-transparent pixels with the screen.
+	 * @param dst The first pixel on the screen.
+	 * @param src The first pixel to draw.
+	 * @param n   The number of pixels.
+	 */
+	static inline void BlendPixels(uint32 *dst, const Colour *src, uint n)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i alpha_mask = _mm_set1_epi32(0xFF000000);
+
+		for (; n >= 4; n -= 4, dst += 4, src += 4) {
+			__m128i s = _mm_loadu_si128((const __m128i *)src);
+			__m128i d = _mm_loadu_si128((const __m128i *)dst);
+			__m128i lo = BlendTwoPixels(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero));
+			__m128i hi = BlendTwoPixels(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero));
+			_mm_storeu_si128((__m128i *)dst, _mm_or_si128(_mm_packus_epi16(lo, hi), alpha_mask));
+		}
+		for (; n != 0; n--, dst++, src++) {
+			*dst = Blitter_32bppBase::ComposeColourRGBANoCheck(src->r, src->g, src->b, src->a, *dst);
+		}
+	}
+
+	/**
+	 * Scale two pixels, unpacked to 16 bits per channel, by a factor / 1024.
+	 * @param px     The pixels to scale.
+	 * @param factor The factor of each channel, at most 1024.
+	 * @return The scaled pixels, rounded down; the alpha channel is undefined.
+	 */
+	static inline __m128i ScaleTwoPixels(__m128i px, __m128i factor)
+	{
+		/* (px * 64 * factor) >> 16 == (px * factor) >> 10, without overflowing 16 bits. */
+		return _mm_mulhi_epu16(_mm_slli_epi16(px, 6), factor);
+	}
+
+	/**
+	 * Make the screen behind an opaque transparent sprite darker,
+	 * like #Blitter_32bppBase::MakeTransparent with 3 / 4.
+	 * @param dst The first pixel on the screen.
+	 * @param n   The number of pixels.
+	 */
+	static inline void DarkenPixels(uint32 *dst, uint n)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i alpha_mask = _mm_set1_epi32(0xFF000000);
+		const __m128i factor = _mm_set1_epi16(3 * 1024 / 4);
+
+		for (; n >= 4; n -= 4, dst += 4) {
+			__m128i d = _mm_loadu_si128((const __m128i *)dst);
+			__m128i lo = ScaleTwoPixels(_mm_unpacklo_epi8(d, zero), factor);
+			__m128i hi = ScaleTwoPixels(_mm_unpackhi_epi8(d, zero), factor);
+			_mm_storeu_si128((__m128i *)dst, _mm_or_si128(_mm_packus_epi16(lo, hi), alpha_mask));
+		}
+		for (; n != 0; n--, dst++) *dst = Blitter_32bppBase::MakeTransparent(*dst, 3, 4);
+	}
+
+	/**
+	 * Make the screen behind a semi-transparent transparent sprite darker,
+	 * like #Blitter_32bppBase::MakeTransparent with (1024 - alpha) / 1024.
+	 * @param dst The first pixel on the screen.
+	 * @param src The first pixel of the sprite.
+	 * @param n   The number of pixels.
+	 */
+	static inline void DarkenPixels(uint32 *dst, const Colour *src, uint n)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i alpha_mask = _mm_set1_epi32(0xFF000000);
+		const __m128i max_factor = _mm_set1_epi16(1024);
+
+		for (; n >= 4; n -= 4, dst += 4, src += 4) {
+			__m128i s = _mm_loadu_si128((const __m128i *)src);
+			__m128i d = _mm_loadu_si128((const __m128i *)dst);
+			__m128i s_lo = _mm_unpacklo_epi8(s, zero);
+			__m128i s_hi = _mm_unpackhi_epi8(s, zero);
+			__m128i f_lo = _mm_sub_epi16(max_factor, _mm_shufflehi_epi16(_mm_shufflelo_epi16(s_lo, 0xFF), 0xFF));
+			__m128i f_hi = _mm_sub_epi16(max_factor, _mm_shufflehi_epi16(_mm_shufflelo_epi16(s_hi, 0xFF), 0xFF));
+			__m128i lo = ScaleTwoPixels(_mm_unpacklo_epi8(d, zero), f_lo);
+			__m128i hi = ScaleTwoPixels(_mm_unpackhi_epi8(d, zero), f_hi);
+			_mm_storeu_si128((__m128i *)dst, _mm_or_si128(_mm_packus_epi16(lo, hi), alpha_mask));
+		}
+		for (; n != 0; n--, dst++, src++) *dst = Blitter_32bppBase::MakeTransparent(*dst, 256 * 4 - src->a, 256 * 4);
+	}
+
+	static void Draw(const Blitter::BlitterParams *bp, BlitterMode mode, ZoomLevel zoom);
+
+	template <BlitterMode mode> static void Draw(const Blitter::BlitterParams *bp, ZoomLevel zoom);
+};
+
+/** The optimised 32 bpp blitter (without palette animation), using SSE2 instructions. */
+class Blitter_32bppSSE2 : public Blitter_32bppOptimized {
+public:
+	/* virtual */ void Draw(Blitter::BlitterParams *bp, BlitterMode mode, ZoomLevel zoom);
+
+	/* virtual */ const char *GetName() { return "32bpp-sse2"; }
+};
+
+/** Factory for the SSE2 32 bpp blitter (without palette animation). */
+class FBlitter_32bppSSE2: public BlitterFactory<FBlitter_32bppSSE2> {
+public:
+	/* virtual */ const char *GetName() { return "32bpp-sse2"; }
+	/* virtual */ const char *GetDescription() { return "32bpp SSE2 Blitter (no palette animation)"; }
+	/* virtual */ Blitter *CreateInstance() { return new Blitter_32bppSSE2(); }
+	/* virtual */ bool IsUsable() { return Blitter_32bppSSE2_Base::IsCPUSupported(); }
+};
+
+#endif /* SSE2 */
+
+#endif /* BLITTER_32BPP_SSE2_HPP */
@@ -11,7 +11,6 @@
 
 #include "../stdafx.h"
 #include "../zoom_func.h"
-#include "../settings_type.h"
 #include "../core/math_func.hpp"
 #include "8bpp_optimized.hpp"
 
@@ -112,40 +111,29 @@ void Blitter_8bppOptimized::Draw(Blitter::BlitterParams *bp, BlitterMode mode, Z
 	}
 }
 
-Sprite *Blitter_8bppOptimized::Encode(SpriteLoader::Sprite *sprite, AllocatorProc *allocator)
+Sprite *Blitter_8bppOptimized::Encode(SpriteLoader::Sprite *sprite, AllocatorProc *allocator, uint8 zoom_levels)
 {
-	/* Make memory for all zoom-levels */
+	/* Make memory for the requested zoom-levels */
 	uint memory = sizeof(SpriteData);
 
-	ZoomLevel zoom_min;
-	ZoomLevel zoom_max;
-
-	if (sprite->type == ST_FONT) {
-		zoom_min = ZOOM_LVL_NORMAL;
-		zoom_max = ZOOM_LVL_NORMAL;
-	} else {
-		zoom_min = _settings_client.gui.zoom_min;
-		zoom_max = _settings_client.gui.zoom_max;
-		if (zoom_max == zoom_min) zoom_max = ZOOM_LVL_MAX;
-	}
-
-	for (ZoomLevel i = zoom_min; i <= zoom_max; i++) {
-		memory += sprite[i].width * sprite[i].height;
+	for (ZoomLevel i = ZOOM_LVL_BEGIN; i != ZOOM_LVL_END; i++) {
+		if (HasBit(zoom_levels, i)) memory += sprite[i].width * sprite[i].height;
 	}
 
 	/* We have no idea how much memory we really need, so just guess something */
 	memory *= 5;
 
-	/* Don't allocate memory each time, but just keep some
-	 * memory around as this function is called quite often
-	 * and the memory usage is quite low. */
-	static ReusableBuffer<byte> temp_buffer;
+	/* Sprites may be encoded by several threads at once,
+	 * so each encoding needs its own temporary memory. */
+	ReusableBuffer<byte> temp_buffer;
 	SpriteData *temp_dst = (SpriteData *)temp_buffer.Allocate(memory);
 	memset(temp_dst, 0, sizeof(*temp_dst));
 	byte *dst = temp_dst->data;
 
 	/* Make the sprites per zoom-level */
-	for (ZoomLevel i = zoom_min; i <= zoom_max; i++) {
+	for (ZoomLevel i = ZOOM_LVL_BEGIN; i != ZOOM_LVL_END; i++) {
+		if (!HasBit(zoom_levels, i)) continue;
+
 		/* Store the index table */
 		uint offset = dst - temp_dst->data;
 		temp_dst->offset[i] = offset;
@@ -25,7 +25,8 @@ public:
 	};
 
 	/* virtual */ void Draw(Blitter::BlitterParams *bp, BlitterMode mode, ZoomLevel zoom);
-	/* virtual */ Sprite *Encode(SpriteLoader::Sprite *sprite, AllocatorProc *allocator);
+	/* virtual */ Sprite *Encode(SpriteLoader::Sprite *sprite, AllocatorProc *allocator, uint8 zoom_levels);
+	/* virtual */ uint8 GetSpriteZoomLevels(ZoomLevel zoom) { return 1 << zoom; }
 
 	/* virtual */ const char *GetName() { return "8bpp-optimized"; }
 };
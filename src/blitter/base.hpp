@@ -76,8 +76,23 @@ public:
 
 	/**
 	 * Convert a sprite from the loader to our own format.
+	 * @param sprite      The sprite per zoom level, as loaded by the sprite loader.
+	 * @param allocator   Function to allocate the memory of the converted sprite with.
+	 * @param zoom_levels Bit mask of the zoom levels to convert, see #GetSpriteZoomLevels. Other zoom levels of \a sprite might not be filled.
+	 * @return The converted sprite.
 	 */
-	virtual Sprite *Encode(SpriteLoader::Sprite *sprite, AllocatorProc *allocator) = 0;
+	virtual Sprite *Encode(SpriteLoader::Sprite *sprite, AllocatorProc *allocator, uint8 zoom_levels) = 0;
+
+	/**
+	 * Get the zoom levels a sprite has to be converted for, to be able to draw it at the given zoom level.
+	 * By default sprites are scaled while drawing them, so only the normal zoom level is needed.
+	 * @param zoom The zoom level the sprite is drawn at.
+	 * @return Bit mask of the zoom levels.
+	 */
+	virtual uint8 GetSpriteZoomLevels(ZoomLevel zoom)
+	{
+		return 1 << ZOOM_LVL_NORMAL;
+	}
 
 	/**
 	 * Move the destination pointer the requested amount x and y, keeping in mind
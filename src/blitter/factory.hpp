@@ -109,7 +109,7 @@ public:
 		Blitters::iterator it = GetBlitters().begin();
 		for (; it != GetBlitters().end(); it++) {
 			BlitterFactoryBase *b = (*it).second;
-			if (strcasecmp(bname, b->name) == 0) {
+			if (strcasecmp(bname, b->name) == 0 && b->IsUsable()) {
 				Blitter *newb = b->CreateInstance();
 				delete *GetActiveBlitter();
 				*GetActiveBlitter() = newb;
@@ -141,6 +141,7 @@ public:
 		Blitters::iterator it = GetBlitters().begin();
 		for (; it != GetBlitters().end(); it++) {
 			BlitterFactoryBase *b = (*it).second;
+			if (!b->IsUsable()) continue;
 			p += seprintf(p, last, "%18s: %s\n", b->name, b->GetDescription());
 		}
 		p += seprintf(p, last, "\n");
@@ -157,6 +158,13 @@ public:
 	 * Create an instance of this Blitter-class.
 	 */
 	virtual Blitter *CreateInstance() = 0;
+
+	/**
+	 * Check whether this blitter can be used on the current machine,
+	 * e.g. whether the CPU supports the instructions it uses.
+	 * @return True iff the blitter can be used.
+	 */
+	virtual bool IsUsable() { return true; }
 };
 
 /**
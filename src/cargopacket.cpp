@@ -214,27 +214,20 @@ void CargoList<Tinst>::Append(CargoPacket *cp)
 template <class Tinst>
 void CargoList<Tinst>::Truncate(uint max_remaining)
 {
-	for (Iterator it(packets.begin()); it != packets.end(); /* done during loop*/) {
-		CargoPacket *cp = *it;
-		if (max_remaining == 0) {
-			/* Nothing should remain, just remove the packets. */
-			it = this->packets.erase(it);
+	/* Work from the back, so only the packets that are (partially) removed are visited. */
+	while (this->count > max_remaining && !this->packets.empty()) {
+		CargoPacket *cp = this->packets.back();
+		uint diff = this->count - max_remaining;
+		if (cp->count <= diff) {
+			/* Nothing should remain of this packet, just remove it. */
+			this->packets.pop_back();
 			static_cast<Tinst *>(this)->RemoveFromCache(cp);
 			delete cp;
-			continue;
-		}
-
-		uint local_count = cp->count;
-		if (local_count > max_remaining) {
-			uint diff = local_count - max_remaining;
+		} else {
 			this->count -= diff;
 			this->cargo_days_in_transit -= cp->days_in_transit * diff;
-			cp->count = max_remaining;
-			max_remaining = 0;
-		} else {
-			max_remaining -= local_count;
+			cp->count -= diff;
 		}
-		++it;
 	}
 }
 
@@ -266,11 +259,14 @@ bool CargoList<Tinst>::MoveTo(Tother_inst *dest, uint max_move, MoveToAction mta
 	assert(mta == MTA_FINAL_DELIVERY || dest != NULL);
 	assert(mta == MTA_UNLOAD || mta == MTA_CARGO_LOAD || payment != NULL);
 
+	/* Packets that stay are moved to the front, the moved ones are erased all at once at the end. */
 	Iterator it(this->packets.begin());
+	Iterator kept(it);
 	while (it != this->packets.end() && max_move > 0) {
 		CargoPacket *cp = *it;
 		if (cp->source == data && mta == MTA_FINAL_DELIVERY) {
 			/* Skip cargo that originated from this station. */
+			*kept++ = cp;
 			++it;
 			continue;
 		}
@@ -278,7 +274,7 @@ bool CargoList<Tinst>::MoveTo(Tother_inst *dest, uint max_move, MoveToAction mta
 		if (cp->count <= max_move) {
 			/* Can move the complete packet */
 			max_move -= cp->count;
-			it = this->packets.erase(it);
+			++it;
 			static_cast<Tinst *>(this)->RemoveFromCache(cp);
 			switch (mta) {
 				case MTA_FINAL_DELIVERY:
@@ -320,7 +316,10 @@ bool CargoList<Tinst>::MoveTo(Tother_inst *dest, uint max_move, MoveToAction mta
 			CargoPacket *cp_new = cp->Split(max_move);
 
 			/* We could not allocate a CargoPacket? Is the map that full? */
-			if (cp_new == NULL) return false;
+			if (cp_new == NULL) {
+				this->packets.erase(kept, it);
+				return false;
+			}
 
 			static_cast<Tinst *>(this)->RemoveFromCache(cp_new); // this reflects the changes in cp.
 
@@ -337,7 +336,8 @@ bool CargoList<Tinst>::MoveTo(Tother_inst *dest, uint max_move, MoveToAction mta
 		max_move = 0;
 	}
 
-	return it != packets.end();
+	it = this->packets.erase(kept, it);
+	return it != this->packets.end();
 }
 
 /** Invalidates the cached data and rebuilds it. */
@@ -17,7 +17,7 @@
 #include "station_type.h"
 #include "cargo_type.h"
 #include "vehicle_type.h"
-#include <list>
+#include <deque>
 
 /** Unique identifier for a single cargo packet. */
 typedef uint32 CargoPacketID;
@@ -166,8 +166,8 @@ public:
 template <class Tinst>
 class CargoList {
 public:
-	/** Container with cargo packets. */
-	typedef std::list<CargoPacket *> List;
+	/** Container with cargo packets; kept in contiguous chunks so walking over it stays cheap. */
+	typedef std::deque<CargoPacket *> List;
 	/** The iterator for our container. */
 	typedef List::iterator Iterator;
 	/** The const iterator for our container. */
@@ -123,6 +123,9 @@ struct Company : CompanyPool::PoolItem<&_company_pool>, CompanyProperties {
 
 	CompanyInfrastructure infrastructure; ///< NOSAVE: Counts of company owned infrastructure.
 
+	Money vehicle_value;                  ///< NOSAVE: Sum of the values of the vehicles for the company value, see CountVehicleValue().
+	uint32 station_facilities;            ///< NOSAVE: Number of facilities of the stations for the company value, see CountStationFacilities().
+
 	/**
 	 * Is this company a valid company, controlled by the computer (a NoAI program)?
 	 * @param index Index in the pool.
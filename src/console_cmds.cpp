@@ -25,6 +25,7 @@
 #include "fios.h"
 #include "fileio_func.h"
 #include "screenshot.h"
+#include "spritecache.h"
 #include "genworld.h"
 #include "strings_func.h"
 #include "viewport_func.h"
@@ -38,6 +39,7 @@
 #include "console_func.h"
 #include "engine_base.h"
 #include "game/game.hpp"
+#include "gfx_func.h"
 
 #ifdef ENABLE_NETWORK
 	#include "table/strings.h"
@@ -1328,6 +1330,38 @@ DEF_CONSOLE_CMD(ConGetDate)
 	return true;
 }
 
+DEF_CONSOLE_CMD(ConSpriteCache)
+{
+	if (argc == 0) {
+		IConsoleHelp("Show the statistics of the sprite cache. Usage: 'spritecache'");
+		return true;
+	}
+
+	const SpriteCacheStats &stats = GetSpriteCacheStats();
+	IConsolePrintF(CC_DEFAULT, "Hits:       " OTTD_PRINTF64, stats.hits);
+	IConsolePrintF(CC_DEFAULT, "Misses:     " OTTD_PRINTF64, stats.misses);
+	IConsolePrintF(CC_DEFAULT, "Evictions:  " OTTD_PRINTF64, stats.evictions);
+	IConsolePrintF(CC_DEFAULT, "Prefetched: " OTTD_PRINTF64, stats.prefetched);
+	IConsolePrintF(CC_DEFAULT, "In use:     " PRINTF_SIZE " of %u bytes (" PRINTF_SIZE " bytes allocated)", stats.used, _sprite_cache_size * 1024 * 1024, stats.allocated);
+	return true;
+}
+
+DEF_CONSOLE_CMD(ConLayoutCache)
+{
+	if (argc == 0) {
+		IConsoleHelp("Show the statistics of the string layout cache. Usage: 'layoutcache'");
+		return true;
+	}
+
+	const StringLayoutCacheStats &stats = GetStringLayoutCacheStats();
+	uint64 lookups = stats.hits + stats.misses;
+	IConsolePrintF(CC_DEFAULT, "Hits:      " OTTD_PRINTF64 " (%u%%)", stats.hits, lookups == 0 ? 0 : (uint)(stats.hits * 100 / lookups));
+	IConsolePrintF(CC_DEFAULT, "Misses:    " OTTD_PRINTF64, stats.misses);
+	IConsolePrintF(CC_DEFAULT, "Evictions: " OTTD_PRINTF64, stats.evictions);
+	IConsolePrintF(CC_DEFAULT, "Entries:   %u", stats.entries);
+	return true;
+}
+
 
 DEF_CONSOLE_CMD(ConAlias)
 {
@@ -1895,6 +1929,8 @@ void IConsoleStdLibRegister()
 	IConsoleCmdRegister("restart",      ConRestart);
 	IConsoleCmdRegister("getseed",      ConGetSeed);
 	IConsoleCmdRegister("getdate",      ConGetDate);
+	IConsoleCmdRegister("spritecache",  ConSpriteCache);
+	IConsoleCmdRegister("layoutcache",  ConLayoutCache);
 	IConsoleCmdRegister("quit",         ConExit);
 	IConsoleCmdRegister("resetengines", ConResetEngines, ConHookNoNetwork);
 	IConsoleCmdRegister("reset_enginepool", ConResetEnginePool, ConHookNoNetwork);
@@ -182,6 +182,21 @@ public:
 		*item = this->data[--this->items];
 	}
 
+	/**
+	 * Remove items from the vector while preserving the order of other items.
+	 * @param pos First position to remove.
+	 * @param count Number of consecutive items to remove.
+	 */
+	inline void ErasePreservingOrder(uint pos, uint count = 1)
+	{
+		if (count == 0) return;
+		assert(pos < this->items);
+		assert(pos + count <= this->items);
+		this->items -= count;
+		uint to_move = this->items - pos;
+		if (to_move > 0) MemMoveT(this->data + pos, this->data + pos + count, to_move);
+	}
+
 	/**
 	 * Tests whether a item is present in the vector, and appends it to the end if not.
 	 * The '!=' operator of T is used for comparison.
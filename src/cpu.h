@@ -0,0 +1,24 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file cpu.h Functions related to CPU specific instructions. */
+
+#ifndef CPU_H
+#define CPU_H
+
+/**
+ * Check whether the current CPU has the given flag.
+ * @param type  The type to pass to cpuid (usually 1).
+ * @param index The register of the returned info to check: 0 = eax, 1 = ebx, 2 = ecx and 3 = edx.
+ * @param bit   The bit index that needs to be set.
+ * @return The value of the bit (flag).
+ */
+bool HasCPUIDFlag(uint type, uint index, uint bit);
+
+#endif /* CPU_H */
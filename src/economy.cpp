@@ -93,6 +93,86 @@ Prices _price;
 Money _additional_cash_required;
 static PriceMultipliers _price_base_multiplier;
 
+/**
+ * Whether the value of a vehicle counts for the value of its owner.
+ * @param v The vehicle to check.
+ * @return True iff the vehicle is a train, road vehicle, ship or normal aircraft.
+ */
+static bool IsCompanyValueVehicle(const Vehicle *v)
+{
+	switch (v->type) {
+		case VEH_TRAIN:
+		case VEH_ROAD:
+		case VEH_SHIP:
+			return true;
+
+		case VEH_AIRCRAFT:
+			return Aircraft::From(v)->IsNormalAircraft();
+
+		default:
+			return false;
+	}
+}
+
+/**
+ * Add or remove a vehicle to or from the vehicle value of its owner.
+ * Call it with -1 before and with 1 after changing the value or owner of the vehicle.
+ * @param v     The vehicle.
+ * @param delta 1 to add the vehicle, -1 to remove it.
+ */
+void CountVehicleValue(const Vehicle *v, int delta)
+{
+	assert(delta == 1 || delta == -1);
+
+	Company *c = Company::GetIfValid(v->owner);
+	if (c == NULL || !IsCompanyValueVehicle(v)) return;
+
+	Money value = v->value * 3 >> 1;
+	if (delta > 0) {
+		c->vehicle_value += value;
+	} else {
+		c->vehicle_value -= value;
+	}
+}
+
+/**
+ * Add or remove the facilities of a station to or from the station facility count of its owner.
+ * Call it with -1 before and with 1 after changing the facilities or owner of the station.
+ * @param st    The station; waypoints are ignored.
+ * @param delta 1 to add the facilities, -1 to remove them.
+ */
+void CountStationFacilities(const BaseStation *st, int delta)
+{
+	assert(delta == 1 || delta == -1);
+
+	if (!Station::IsExpected(st)) return;
+
+	Company *c = Company::GetIfValid(st->owner);
+	if (c == NULL) return;
+
+	c->station_facilities += delta * (int)CountBits((byte)st->facilities);
+}
+
+/**
+ * Recount the vehicle values and station facilities of all companies.
+ * These are kept up to date as vehicles and stations change, so this
+ * is only needed after loading and to validate the counts.
+ */
+void RebuildCompanyValueCounts()
+{
+	Company *c;
+	FOR_ALL_COMPANIES(c) {
+		c->vehicle_value = 0;
+		c->station_facilities = 0;
+	}
+
+	const Station *st;
+	FOR_ALL_STATIONS(st) CountStationFacilities(st, 1);
+
+	const Vehicle *v;
+	FOR_ALL_VEHICLES(v) CountVehicleValue(v, 1);
+}
+
 /**
  * Calculate the value of the company. That is the value of all
  * assets (vehicles, stations, etc) and money minus the loan,
@@ -104,45 +184,70 @@ static PriceMultipliers _price_base_multiplier;
  */
 Money CalculateCompanyValue(const Company *c, bool including_loan)
 {
-	Owner owner = c->index;
+	Money value = c->station_facilities * _price[PR_STATION_VALUE] * 25;
+	value += c->vehicle_value;
 
-	Station *st;
-	uint num = 0;
+	/* Add real money value */
+	if (including_loan) value -= c->current_loan;
+	value += c->money;
 
-	FOR_ALL_STATIONS(st) {
-		if (st->owner == owner) num += CountBits((byte)st->facilities);
-	}
+	return max(value, (Money)1);
+}
 
-	Money value = num * _price[PR_STATION_VALUE] * 25;
+/** Parts of the performance rating of a company that are counted over its vehicles and stations. */
+struct CompanyScoreCounts {
+	uint num_vehicles;   ///< Number of profitable vehicles.
+	Money min_profit;    ///< Lowest profit last year of the vehicles older than two years.
+	bool has_min_profit; ///< Whether there are vehicles older than two years, i.e. whether #min_profit is set.
+	uint num_stations;   ///< Number of facilities of the serviced stations.
+};
 
-	Vehicle *v;
-	FOR_ALL_VEHICLES(v) {
-		if (v->owner != owner) continue;
+/**
+ * Count the score parts of the vehicles and stations of all companies in one go.
+ * @param counts The counts of each company, indexed by company.
+ */
+static void CountCompanyScores(CompanyScoreCounts *counts)
+{
+	for (CompanyID c = COMPANY_FIRST; c < MAX_COMPANIES; c++) {
+		counts[c].num_vehicles = 0;
+		counts[c].min_profit = 0;
+		counts[c].has_min_profit = false;
+		counts[c].num_stations = 0;
+	}
 
-		if (v->type == VEH_TRAIN ||
-				v->type == VEH_ROAD ||
-				(v->type == VEH_AIRCRAFT && Aircraft::From(v)->IsNormalAircraft()) ||
-				v->type == VEH_SHIP) {
-			value += v->value * 3 >> 1;
+	const Vehicle *v;
+	FOR_ALL_VEHICLES(v) {
+		if (v->owner >= MAX_COMPANIES) continue;
+		if (IsCompanyBuildableVehicleType(v->type) && v->IsPrimaryVehicle()) {
+			CompanyScoreCounts &count = counts[v->owner];
+			if (v->profit_last_year > 0) count.num_vehicles++; // For the vehicle score only count profitable vehicles
+			if (v->age > 730) {
+				/* Find the vehicle with the lowest amount of profit */
+				if (!count.has_min_profit || count.min_profit > v->profit_last_year) {
+					count.min_profit = v->profit_last_year;
+					count.has_min_profit = true;
+				}
+			}
 		}
 	}
 
-	/* Add real money value */
-	if (including_loan) value -= c->current_loan;
-	value += c->money;
-
-	return max(value, (Money)1);
+	const Station *st;
+	FOR_ALL_STATIONS(st) {
+		/* Only count stations that are actually serviced */
+		if (st->owner < MAX_COMPANIES && (st->time_since_load <= 20 || st->time_since_unload <= 20)) {
+			counts[st->owner].num_stations += CountBits((byte)st->facilities);
+		}
+	}
 }
 
 /**
- * if update is set to true, the economy is updated with this score
- *  (also the house is updated, should only be true in the on-tick event)
- * @param update the economy with calculated score
+ * Calculate the performance rating of a company with the counts of its vehicles and stations.
  * @param c company been evaluated
+ * @param update the economy with calculated score
+ * @param counts the score parts counted over the vehicles and stations of the company
  * @return actual score of this company
- *
  */
-int UpdateCompanyRatingAndValue(Company *c, bool update)
+static int UpdateCompanyRatingAndValue(Company *c, bool update, const CompanyScoreCounts &counts)
 {
 	Owner owner = c->index;
 	int score = 0;
@@ -151,28 +256,10 @@ int UpdateCompanyRatingAndValue(Company *c, bool update)
 
 	/* Count vehicles */
 	{
-		Vehicle *v;
-		Money min_profit = 0;
-		bool min_profit_first = true;
-		uint num = 0;
-
-		FOR_ALL_VEHICLES(v) {
-			if (v->owner != owner) continue;
-			if (IsCompanyBuildableVehicleType(v->type) && v->IsPrimaryVehicle()) {
-				if (v->profit_last_year > 0) num++; // For the vehicle score only count profitable vehicles
-				if (v->age > 730) {
-					/* Find the vehicle with the lowest amount of profit */
-					if (min_profit_first || min_profit > v->profit_last_year) {
-						min_profit = v->profit_last_year;
-						min_profit_first = false;
-					}
-				}
-			}
-		}
-
+		Money min_profit = counts.has_min_profit ? counts.min_profit : (Money)0;
 		min_profit >>= 8; // remove the fract part
 
-		_score_part[owner][SCORE_VEHICLES] = num;
+		_score_part[owner][SCORE_VEHICLES] = counts.num_vehicles;
 		/* Don't allow negative min_profit to show */
 		if (min_profit > 0) {
 			_score_part[owner][SCORE_MIN_PROFIT] = ClampToI32(min_profit);
@@ -181,14 +268,7 @@ int UpdateCompanyRatingAndValue(Company *c, bool update)
 
 	/* Count stations */
 	{
-		uint num = 0;
-		const Station *st;
-
-		FOR_ALL_STATIONS(st) {
-			/* Only count stations that are actually serviced */
-			if (st->owner == owner && (st->time_since_load <= 20 || st->time_since_unload <= 20)) num += CountBits((byte)st->facilities);
-		}
-		_score_part[owner][SCORE_STATIONS] = num;
+		_score_part[owner][SCORE_STATIONS] = counts.num_stations;
 	}
 
 	/* Generate statistics depending on recent income statistics */
@@ -273,6 +353,21 @@ int UpdateCompanyRatingAndValue(Company *c, bool update)
 	return score;
 }
 
+/**
+ * if update is set to true, the economy is updated with this score
+ *  (also the house is updated, should only be true in the on-tick event)
+ * @param update the economy with calculated score
+ * @param c company been evaluated
+ * @return actual score of this company
+ *
+ */
+int UpdateCompanyRatingAndValue(Company *c, bool update)
+{
+	CompanyScoreCounts counts[MAX_COMPANIES];
+	CountCompanyScores(counts);
+	return UpdateCompanyRatingAndValue(c, update, counts[c->index]);
+}
+
 /**
  * Change the ownership of all the items of a company.
  * @param old_owner The company that gets removed.
@@ -389,6 +484,7 @@ void ChangeOwnershipOfCompanyItems(Owner old_owner, Owner new_owner)
 				} else {
 					if (v->IsEngineCountable()) GroupStatistics::CountEngine(v, -1);
 					if (v->IsPrimaryVehicle()) GroupStatistics::CountVehicle(v, -1);
+					CountVehicleValue(v, -1);
 				}
 			}
 		}
@@ -431,6 +527,7 @@ void ChangeOwnershipOfCompanyItems(Owner old_owner, Owner new_owner)
 					GroupStatistics::CountVehicle(v, 1);
 					v->unitnumber = unitidgen[v->type].NextID();
 				}
+				CountVehicleValue(v, 1);
 
 				/* Invalidate the vehicle's cargo payment "owner cache". */
 				if (v->cargo_payment != NULL) v->cargo_payment->owner = NULL;
@@ -480,7 +577,9 @@ void ChangeOwnershipOfCompanyItems(Owner old_owner, Owner new_owner)
 		if (st->owner == old_owner) {
 			/* if a company goes bankrupt, set owner to OWNER_NONE so the sign doesn't disappear immediately
 			 * also, drawing station window would cause reading invalid company's colour */
+			CountStationFacilities(st, -1);
 			st->owner = new_owner == INVALID_OWNER ? OWNER_NONE : new_owner;
+			CountStationFacilities(st, 1);
 		}
 	}
 
@@ -617,6 +716,9 @@ static void CompaniesGenStatistics()
 	/* Only run the economic statics and update company stats every 3rd month (1st of quarter). */
 	if (!HasBit(1 << 0 | 1 << 3 | 1 << 6 | 1 << 9, _cur_month)) return;
 
+	CompanyScoreCounts counts[MAX_COMPANIES];
+	CountCompanyScores(counts);
+
 	FOR_ALL_COMPANIES(c) {
 		memmove(&c->old_economy[1], &c->old_economy[0], sizeof(c->old_economy) - sizeof(c->old_economy[0]));
 		c->old_economy[0] = c->cur_economy;
@@ -624,7 +726,7 @@ static void CompaniesGenStatistics()
 
 		if (c->num_valid_stat_ent != MAX_HISTORY_QUARTERS) c->num_valid_stat_ent++;
 
-		UpdateCompanyRatingAndValue(c, true);
+		UpdateCompanyRatingAndValue(c, true, counts[c->index]);
 		if (c->block_preview != 0) c->block_preview--;
 		CompanyCheckBankrupt(c);
 	}
@@ -846,12 +948,20 @@ void StartupEconomy()
 
 }
 
+/** Stations that (may) have vehicles loading or unloading, sorted by index. */
+static SmallVector<StationID, 32> _loading_stations;
+/** Whether #_loading_stations contains all stations with loading vehicles; it has to be rebuilt after loading a game. */
+static bool _loading_stations_valid = false;
+
 /**
  * Resets economy to initial values
  */
 void InitializeEconomy()
 {
 	_economy.inflation_prices = _economy.inflation_payment = 1 << 16;
+
+	_loading_stations.Clear();
+	_loading_stations_valid = false;
 }
 
 /**
@@ -932,13 +1042,13 @@ static SmallIndustryList _cargo_delivery_destinations;
 /**
  * Transfer goods from station to industry.
  * All cargo is delivered to the nearest (Manhattan) industry to the station sign, which is inside the acceptance rectangle and actually accepts the cargo.
- * @param st The station that accepted the cargo
+ * @param industries The industries near the station that accept the cargo, see #CargoPayment::GetAcceptingIndustries.
  * @param cargo_type Type of cargo delivered
  * @param num_pieces Amount of cargo delivered
  * @param source The source of the cargo
  * @return actually accepted pieces of cargo
  */
-static uint DeliverGoodsToIndustry(const Station *st, CargoID cargo_type, uint num_pieces, IndustryID source)
+static uint DeliverGoodsToIndustry(const SmallVector<CargoPayment::AcceptingIndustry, 4> &industries, CargoID cargo_type, uint num_pieces, IndustryID source)
 {
 	/* Find the nearest industrytile to the station sign inside the catchment area, whose industry accepts the cargo.
 	 * This fails in three cases:
@@ -949,16 +1059,11 @@ static uint DeliverGoodsToIndustry(const Station *st, CargoID cargo_type, uint n
 
 	uint accepted = 0;
 
-	for (uint i = 0; i < st->industries_near.Length() && num_pieces != 0; i++) {
-		Industry *ind = st->industries_near[i];
+	for (uint i = 0; i < industries.Length() && num_pieces != 0; i++) {
+		Industry *ind = industries[i].ind;
 		if (ind->index == source) continue;
 
-		uint cargo_index;
-		for (cargo_index = 0; cargo_index < lengthof(ind->accepts_cargo); cargo_index++) {
-			if (cargo_type == ind->accepts_cargo[cargo_index]) break;
-		}
-		/* Check if matching cargo has been found */
-		if (cargo_index >= lengthof(ind->accepts_cargo)) continue;
+		uint cargo_index = industries[i].cargo_index;
 
 		/* Check if industry temporarily refuses acceptance */
 		if (IndustryTemporarilyRefusesCargo(ind, cargo_type)) continue;
@@ -977,25 +1082,25 @@ static uint DeliverGoodsToIndustry(const Station *st, CargoID cargo_type, uint n
 
 /**
  * Delivers goods to industries/towns and calculates the payment
+ * @param payment The payment of the vehicle delivering the cargo; it knows the cargo type, station and company.
  * @param num_pieces amount of cargo delivered
- * @param cargo_type the type of cargo that is delivered
- * @param dest Station the cargo has been unloaded
  * @param source_tile The origin of the cargo for distance calculation
  * @param days_in_transit Travel time
- * @param company The company delivering the cargo
  * @param src_type Type of source of cargo (industry, town, headquarters)
  * @param src Index of source of cargo
  * @return Revenue for delivering cargo
  * @note The cargo is just added to the stockpile of the industry. It is due to the caller to trigger the industry's production machinery
  */
-static Money DeliverGoods(int num_pieces, CargoID cargo_type, StationID dest, TileIndex source_tile, byte days_in_transit, Company *company, SourceType src_type, SourceID src)
+static Money DeliverGoods(CargoPayment *payment, int num_pieces, TileIndex source_tile, byte days_in_transit, SourceType src_type, SourceID src)
 {
 	assert(num_pieces > 0);
 
-	Station *st = Station::Get(dest);
+	CargoID cargo_type = payment->ct;
+	Company *company = payment->owner;
+	Station *st = Station::Get(payment->current_station);
 
 	/* Give the goods to the industry. */
-	uint accepted = DeliverGoodsToIndustry(st, cargo_type, num_pieces, src_type == ST_INDUSTRY ? src : INVALID_INDUSTRY);
+	uint accepted = DeliverGoodsToIndustry(payment->GetAcceptingIndustries(), cargo_type, num_pieces, src_type == ST_INDUSTRY ? src : INVALID_INDUSTRY);
 
 	/* If this cargo type is always accepted, accept all */
 	if (HasBit(st->always_accepted, cargo_type)) accepted = num_pieces;
@@ -1018,7 +1123,7 @@ static Money DeliverGoods(int num_pieces, CargoID cargo_type, StationID dest, Ti
 	Money profit = GetTransportedGoodsIncome(accepted, DistanceManhattan(source_tile, st->xy), days_in_transit, cargo_type);
 
 	/* Modify profit if a subsidy is in effect */
-	if (CheckSubsidised(cargo_type, company->index, src_type, src, st))  {
+	if (payment->IsSubsidised(src_type, src)) {
 		switch (_settings_game.difficulty.subsidy_multiplier) {
 			case 0:  profit += profit >> 1; break;
 			case 1:  profit *= 2; break;
@@ -1071,7 +1176,8 @@ static void TriggerIndustryProduction(Industry *i)
  */
 CargoPayment::CargoPayment(Vehicle *front) :
 	front(front),
-	current_station(front->last_station_visited)
+	current_station(front->last_station_visited),
+	accepting_ct(CT_INVALID)
 {
 }
 
@@ -1113,13 +1219,80 @@ void CargoPayment::PayFinalDelivery(const CargoPacket *cp, uint count)
 	}
 
 	/* Handle end of route payment */
-	Money profit = DeliverGoods(count, this->ct, this->current_station, cp->SourceStationXY(), cp->DaysInTransit(), this->owner, cp->SourceSubsidyType(), cp->SourceSubsidyID());
+	Money profit = DeliverGoods(this, count, cp->SourceStationXY(), cp->DaysInTransit(), cp->SourceSubsidyType(), cp->SourceSubsidyID());
 	this->route_profit += profit;
 
 	/* The vehicle's profit is whatever route profit there is minus feeder shares. */
 	this->visual_profit += profit - cp->FeederShare();
 }
 
+/**
+ * Get the industries near the current station that accept the currently
+ * handled cargo type. They are only looked up once for all cargo packets
+ * the vehicle delivers in one go, see #ClearDeliveryLookups.
+ * @return The industries, nearest to the station sign first.
+ */
+const SmallVector<CargoPayment::AcceptingIndustry, 4> &CargoPayment::GetAcceptingIndustries()
+{
+	if (this->accepting_ct == this->ct) return this->accepting;
+
+	this->accepting_ct = this->ct;
+	this->accepting.Clear();
+
+	const Station *st = Station::Get(this->current_station);
+	for (uint i = 0; i < st->industries_near.Length(); i++) {
+		Industry *ind = st->industries_near[i];
+
+		uint cargo_index;
+		for (cargo_index = 0; cargo_index < lengthof(ind->accepts_cargo); cargo_index++) {
+			if (this->ct == ind->accepts_cargo[cargo_index]) break;
+		}
+		/* Check if matching cargo has been found */
+		if (cargo_index >= lengthof(ind->accepts_cargo)) continue;
+
+		AcceptingIndustry *ai = this->accepting.Append();
+		ai->ind = ind;
+		ai->cargo_index = cargo_index;
+	}
+	return this->accepting;
+}
+
+/**
+ * Check whether delivering cargo of the currently handled type from the
+ * given source at the current station is subsidised. Every source is only
+ * checked once for all cargo packets the vehicle delivers in one go, see
+ * #ClearDeliveryLookups; checking again would give the same result, as the
+ * first check already awards the subsidy.
+ * @param src_type Type of source of the cargo.
+ * @param src Index of source of the cargo.
+ * @return True iff the delivery is subsidised.
+ */
+bool CargoPayment::IsSubsidised(SourceType src_type, SourceID src)
+{
+	for (const SubsidyCheck *sc = this->subsidy_checks.Begin(); sc != this->subsidy_checks.End(); sc++) {
+		if (sc->ct == this->ct && sc->source_type == src_type && sc->source_id == src) return sc->subsidised;
+	}
+
+	SubsidyCheck *sc = this->subsidy_checks.Append();
+	sc->ct = this->ct;
+	sc->source_type = src_type;
+	sc->source_id = src;
+	sc->subsidised = CheckSubsidised(this->ct, this->owner->index, src_type, src, Station::Get(this->current_station));
+	return sc->subsidised;
+}
+
+/**
+ * Forget the industries and subsidies looked up for the delivered cargo.
+ * Industries and subsidies may change before the vehicle delivers cargo
+ * again, so this has to be called after every round of delivering.
+ */
+void CargoPayment::ClearDeliveryLookups()
+{
+	this->accepting_ct = CT_INVALID;
+	this->accepting.Clear();
+	this->subsidy_checks.Clear();
+}
+
 /**
  * Handle payment for transfer of the given cargo packet.
  * @param cp The cargo packet to pay for; actual payment won't be made!.
@@ -1466,6 +1639,9 @@ static void LoadUnloadVehicle(Vehicle *front, int *cargo_left)
 		}
 	}
 
+	/* The industries and subsidies may have changed by the next time the vehicle delivers. */
+	if (payment != NULL) payment->ClearDeliveryLookups();
+
 	if (anything_loaded || anything_unloaded) {
 		if (front->type == VEH_TRAIN) TriggerStationAnimation(st, st->xy, SAT_TRAIN_LOADS);
 	}
@@ -1569,7 +1745,7 @@ static void LoadUnloadVehicle(Vehicle *front, int *cargo_left)
  * they entered.
  * @param st the station to do the loading/unloading for
  */
-void LoadUnloadStation(Station *st)
+static void LoadUnloadStation(Station *st)
 {
 	/* No vehicle is here... */
 	if (st->loading_vehicles.empty()) return;
@@ -1614,6 +1790,54 @@ void LoadUnloadStation(Station *st)
 	_cargo_delivery_destinations.Clear();
 }
 
+/**
+ * Make sure the vehicles at the given station get loaded and unloaded.
+ * @param st The station a vehicle just started loading at.
+ */
+void AddLoadingStation(const Station *st)
+{
+	/* The station will be found when the list gets rebuilt. */
+	if (!_loading_stations_valid) return;
+
+	/* Keep the list sorted, so the stations are handled in the same order as before. */
+	uint pos = 0;
+	while (pos < _loading_stations.Length() && _loading_stations[pos] < st->index) pos++;
+	if (pos < _loading_stations.Length() && _loading_stations[pos] == st->index) return;
+
+	_loading_stations.Append();
+	MemMoveT(_loading_stations.Begin() + pos + 1, _loading_stations.Begin() + pos, _loading_stations.Length() - pos - 1);
+	_loading_stations[pos] = st->index;
+}
+
+/**
+ * Load/unload the vehicles at all stations, in the order of the stations.
+ * Only the stations that have vehicles loading are visited; stations whose
+ * last vehicle has left are removed from the list.
+ */
+void LoadUnloadStations()
+{
+	if (!_loading_stations_valid) {
+		_loading_stations.Clear();
+
+		const Station *st;
+		FOR_ALL_STATIONS(st) {
+			if (!st->loading_vehicles.empty()) *_loading_stations.Append() = st->index;
+		}
+		_loading_stations_valid = true;
+	}
+
+	for (uint i = 0; i < _loading_stations.Length();) {
+		Station *st = Station::GetIfValid(_loading_stations[i]);
+		if (st == NULL || st->loading_vehicles.empty()) {
+			_loading_stations.ErasePreservingOrder(i);
+			continue;
+		}
+
+		LoadUnloadStation(st);
+		i++;
+	}
+}
+
 /**
  * Monthly update of the economic data (of the companies as well as economic fluctuations).
  */
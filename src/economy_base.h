@@ -14,6 +14,8 @@
 
 #include "cargopacket.h"
 #include "company_type.h"
+#include "industry_type.h"
+#include "core/smallvec_type.hpp"
 
 /** Type of pool to store cargo payments in; little over 1 million. */
 typedef Pool<CargoPayment, CargoPaymentID, 512, 0xFF000> CargoPaymentPool;
@@ -24,6 +26,20 @@ extern CargoPaymentPool _cargo_payment_pool;
  * Helper class to perform the cargo payment.
  */
 struct CargoPayment : CargoPaymentPool::PoolItem<&_cargo_payment_pool> {
+	/** An industry near the current station that accepts the currently handled cargo type. */
+	struct AcceptingIndustry {
+		Industry *ind;    ///< The industry.
+		uint cargo_index; ///< Index of the cargo type in the cargoes the industry accepts.
+	};
+
+	/** Whether cargo of a source is subsidised when delivered at the current station. */
+	struct SubsidyCheck {
+		CargoID ct;                 ///< Type of the delivered cargo.
+		SourceTypeByte source_type; ///< Type of the subsidy source of the cargo.
+		SourceID source_id;         ///< Subsidy source of the cargo.
+		bool subsidised;            ///< Whether delivering the cargo is subsidised.
+	};
+
 	Vehicle *front;      ///< The front vehicle to do the payment of
 	Money route_profit;  ///< The amount of money to add/remove from the bank account
 	Money visual_profit; ///< The visual profit to show
@@ -32,14 +48,20 @@ struct CargoPayment : CargoPaymentPool::PoolItem<&_cargo_payment_pool> {
 	Company *owner;            ///< The owner of the vehicle
 	StationID current_station; ///< The current station
 	CargoID ct;                ///< The currently handled cargo type
+	CargoID accepting_ct;      ///< Cargo type #accepting is made for, or #CT_INVALID when it has to be made.
+	SmallVector<AcceptingIndustry, 4> accepting; ///< Industries near the current station accepting #accepting_ct, in the order of Station::industries_near.
+	SmallVector<SubsidyCheck, 4> subsidy_checks; ///< Subsidy checks done for the current station.
 
 	/** Constructor for pool saveload */
-	CargoPayment() {}
+	CargoPayment() : accepting_ct(CT_INVALID) {}
 	CargoPayment(Vehicle *front);
 	~CargoPayment();
 
 	Money PayTransfer(const CargoPacket *cp, uint count);
 	void PayFinalDelivery(const CargoPacket *cp, uint count);
+	const SmallVector<AcceptingIndustry, 4> &GetAcceptingIndustries();
+	bool IsSubsidised(SourceType src_type, SourceID src);
+	void ClearDeliveryLookups();
 
 	/**
 	 * Sets the currently handled cargo type.
@@ -28,13 +28,17 @@ extern Economy _economy;
 extern Prices _price;
 
 int UpdateCompanyRatingAndValue(Company *c, bool update);
+void CountVehicleValue(const Vehicle *v, int delta);
+void CountStationFacilities(const BaseStation *st, int delta);
+void RebuildCompanyValueCounts();
 void StartupIndustryDailyChanges(bool init_counter);
 
 Money GetTransportedGoodsIncome(uint num_pieces, uint dist, byte transit_days, CargoID cargo_type);
 uint MoveGoodsToStation(CargoID type, uint amount, SourceType source_type, SourceID source_id, const StationList *all_stations);
 
 void PrepareUnload(Vehicle *front_v);
-void LoadUnloadStation(Station *st);
+void AddLoadingStation(const Station *st);
+void LoadUnloadStations();
 
 Money GetPrice(Price index, uint cost_factor, const struct GRFFile *grf_file, int shift = 0);
 
@@ -15,6 +15,7 @@
 #include "fios.h"
 #include "string_func.h"
 #include "tar_type.h"
+#include "thread/thread.h"
 #ifdef WIN32
 #include <windows.h>
 # define access _taccess
@@ -28,6 +29,12 @@
 #include <sys/stat.h>
 #include <algorithm>
 
+#if defined(UNIX) && !defined(__MORPHOS__) && !defined(__OS2__)
+/** Map the slotted files into memory instead of reading them via a FILE. */
+# define WITH_MMAP
+# include <sys/mman.h>
+#endif
+
 /** Size of the #Fio data buffer. */
 #define FIO_BUFFER_SIZE 512
 
@@ -41,6 +48,11 @@ struct Fio {
 	byte buffer_start[FIO_BUFFER_SIZE];    ///< local buffer when read from file
 	const char *filenames[MAX_FILE_SLOTS]; ///< array of filenames we (should) have open
 	char *shortnames[MAX_FILE_SLOTS];      ///< array of short names for spriteloader's use
+#if defined(WITH_MMAP)
+	byte *maps[MAX_FILE_SLOTS];            ///< start of the mapping of the file, if it is mapped into memory
+	size_t map_sizes[MAX_FILE_SLOTS];      ///< size of the mapping of the file
+	byte *cur_map;                         ///< start of the mapping of the current file, or \c NULL when reading via #cur_fh
+#endif /* WITH_MMAP */
 #if defined(LIMITED_FDS)
 	uint open_handles;                     ///< current amount of open handles
 	uint usage_count[MAX_FILE_SLOTS];      ///< count how many times this file has been opened
@@ -48,6 +60,7 @@ struct Fio {
 };
 
 static Fio _fio; ///< #Fio instance.
+static ThreadMutex *_fio_mutex = ThreadMutex::New(); ///< Serialises the use of #_fio by different threads.
 
 /** Whether the working directory should be scanned. */
 static bool _do_scan_working_directory = true;
@@ -82,6 +95,14 @@ const char *FioGetFilename(uint8 slot)
 void FioSeekTo(size_t pos, int mode)
 {
 	if (mode == SEEK_CUR) pos += FioGetPos();
+#if defined(WITH_MMAP)
+	if (_fio.cur_map != NULL) {
+		/* The whole file is the buffer; the system position is its end. */
+		_fio.pos = _fio.buffer_end - _fio.cur_map;
+		_fio.buffer = _fio.cur_map + min(pos, _fio.pos);
+		return;
+	}
+#endif /* WITH_MMAP */
 	_fio.buffer = _fio.buffer_end = _fio.buffer_start + FIO_BUFFER_SIZE;
 	_fio.pos = pos;
 	fseek(_fio.cur_fh, _fio.pos, SEEK_SET);
@@ -107,6 +128,16 @@ static void FioRestoreFile(int slot)
 void FioSeekToFile(uint8 slot, size_t pos)
 {
 	FILE *f;
+#if defined(WITH_MMAP)
+	_fio.cur_map = _fio.maps[slot];
+	if (_fio.cur_map != NULL) {
+		_fio.cur_fh = NULL;
+		_fio.filename = _fio.filenames[slot];
+		_fio.buffer_end = _fio.cur_map + _fio.map_sizes[slot];
+		FioSeekTo(pos, SEEK_SET);
+		return;
+	}
+#endif /* WITH_MMAP */
 #if defined(LIMITED_FDS)
 	/* Make sure we have this file open */
 	FioRestoreFile(slot);
@@ -125,6 +156,10 @@ void FioSeekToFile(uint8 slot, size_t pos)
 byte FioReadByte()
 {
 	if (_fio.buffer == _fio.buffer_end) {
+#if defined(WITH_MMAP)
+		/* A mapped file is read completely from the buffer. */
+		if (_fio.cur_map != NULL) return 0;
+#endif /* WITH_MMAP */
 		_fio.buffer = _fio.buffer_start;
 		size_t size = fread(_fio.buffer, 1, FIO_BUFFER_SIZE, _fio.cur_fh);
 		_fio.pos += size;
@@ -151,6 +186,23 @@ void FioSkipBytes(int n)
 	}
 }
 
+/**
+ * Start using the file slots exclusively.
+ * There is only one current file and buffer, so threads that read from the
+ * file slots while another thread may do so too, have to seek and read
+ * between this and #FioEndCritical.
+ */
+void FioBeginCritical()
+{
+	_fio_mutex->BeginCritical();
+}
+
+/** Stop using the file slots exclusively. */
+void FioEndCritical()
+{
+	_fio_mutex->EndCritical();
+}
+
 /**
  * Read a word (16 bits) from the file (in low endian format).
  * @return Read word.
@@ -178,6 +230,14 @@ uint32 FioReadDword()
  */
 void FioReadBlock(void *ptr, size_t size)
 {
+#if defined(WITH_MMAP)
+	if (_fio.cur_map != NULL) {
+		size = min<size_t>(size, _fio.buffer_end - _fio.buffer);
+		memcpy(ptr, _fio.buffer, size);
+		_fio.buffer += size;
+		return;
+	}
+#endif /* WITH_MMAP */
 	FioSeekTo(FioGetPos(), SEEK_SET);
 	_fio.pos += fread(ptr, 1, size, _fio.cur_fh);
 }
@@ -188,6 +248,16 @@ void FioReadBlock(void *ptr, size_t size)
  */
 static inline void FioCloseFile(int slot)
 {
+#if defined(WITH_MMAP)
+	if (_fio.maps[slot] != NULL) {
+		if (_fio.cur_map == _fio.maps[slot]) _fio.cur_map = NULL;
+		munmap(_fio.maps[slot], _fio.map_sizes[slot]);
+		_fio.maps[slot] = NULL;
+
+		free(_fio.shortnames[slot]);
+		_fio.shortnames[slot] = NULL;
+	}
+#endif /* WITH_MMAP */
 	if (_fio.handles[slot] != NULL) {
 		fclose(_fio.handles[slot]);
 
@@ -242,18 +312,37 @@ static void FioFreeHandle()
 void FioOpenFile(int slot, const char *filename, Subdirectory subdir)
 {
 	FILE *f;
+	size_t size = 0;
 
 #if defined(LIMITED_FDS)
 	FioFreeHandle();
 #endif /* LIMITED_FDS */
-	f = FioFOpenFile(filename, "rb", subdir);
+	f = FioFOpenFile(filename, "rb", subdir, &size);
 	if (f == NULL) usererror("Cannot open file '%s'", filename);
 	uint32 pos = ftell(f);
 
 	FioCloseFile(slot); // if file was opened before, close it
-	_fio.handles[slot] = f;
 	_fio.filenames[slot] = filename;
 
+#if defined(WITH_MMAP)
+	/* Map everything up to the end of the file, so positions within a tar
+	 * are the same as when reading from the FILE. Only the pages that are
+	 * actually read are loaded. When the file is shorter than expected (a
+	 * truncated tar) or mapping fails, just read the FILE. */
+	struct stat st;
+	void *map = MAP_FAILED;
+	if (size != 0 && fstat(fileno(f), &st) == 0 && (size_t)st.st_size >= pos + size) {
+		map = mmap(NULL, pos + size, PROT_READ, MAP_PRIVATE, fileno(f), 0);
+	}
+	if (map != MAP_FAILED) {
+		_fio.maps[slot] = (byte *)map;
+		_fio.map_sizes[slot] = pos + size;
+		fclose(f);
+		f = NULL;
+	}
+#endif /* WITH_MMAP */
+	_fio.handles[slot] = f;
+
 	/* Store the filename without path and extension */
 	const char *t = strrchr(filename, PATHSEPCHAR);
 	_fio.shortnames[slot] = strdup(t == NULL ? filename : t);
@@ -26,6 +26,8 @@ void FioCloseAll();
 void FioOpenFile(int slot, const char *filename, Subdirectory subdir);
 void FioReadBlock(void *ptr, size_t size);
 void FioSkipBytes(int n);
+void FioBeginCritical();
+void FioEndCritical();
 
 /**
  * The search paths OpenTTD could search through.
@@ -1188,7 +1188,7 @@ const Sprite *GetGlyph(FontSize size, WChar key)
 		}
 	}
 
-	new_glyph.sprite = BlitterFactoryBase::GetCurrentBlitter()->Encode(&sprite, AllocateFont);
+	new_glyph.sprite = BlitterFactoryBase::GetCurrentBlitter()->Encode(&sprite, AllocateFont, 1 << ZOOM_LVL_NORMAL);
 	new_glyph.width  = slot->advance.x >> 6;
 
 	SetGlyphPtr(size, key, &new_glyph);
@@ -52,7 +52,7 @@ static byte _stringwidth_table[FS_END][224]; ///< Cache containing width of ofte
 DrawPixelInfo *_cur_dpi;
 byte _colour_gradient[COLOUR_END][8];
 
-static void GfxMainBlitterViewport(const Sprite *sprite, int x, int y, BlitterMode mode, const SubSprite *sub = NULL, SpriteID sprite_id = SPR_CURSOR_MOUSE);
+static void GfxMainBlitterViewport(const DrawPixelInfo *dpi, const Sprite *sprite, int x, int y, BlitterMode mode, const byte *remap, const SubSprite *sub, SpriteID sprite_id);
 static void GfxMainBlitter(const Sprite *sprite, int x, int y, BlitterMode mode, const SubSprite *sub = NULL, SpriteID sprite_id = SPR_CURSOR_MOUSE, ZoomLevel zoom = ZOOM_LVL_NORMAL);
 
 /**
@@ -460,35 +460,178 @@ static int GetStringWidth(const UChar *str, FontSize start_fontsize)
 	return max(max_width, width);
 }
 
+/** Types of layouts kept in the string layout cache. */
+enum StringLayoutType {
+	SLT_NONE,         ///< Unused cache entry.
+	SLT_LINE,         ///< A single line of text as drawn by DrawString.
+	SLT_LINEBREAKS,   ///< Text broken into lines by FormatStringLinebreaks.
+	SLT_BOUNDING_BOX, ///< Bounding box of the text as returned by GetStringBoundingBox.
+};
+
+/** Everything a layout depends on, besides the fonts and the language. */
+struct StringLayoutKey {
+	StringLayoutType type; ///< Type of the layout.
+	const char *text;      ///< The formatted text.
+	FontSize fontsize;     ///< Font size the text starts with.
+	int maxw;              ///< Width the text has to fit in, or INT32_MAX when there is no constraint.
+	uint param;            ///< The alignment for #SLT_LINE, the size of the buffer for #SLT_LINEBREAKS.
+	uint32 hash;           ///< Hash of all of the above.
+
+	/**
+	 * Create the key of a layout.
+	 * @param type     Type of the layout.
+	 * @param text     The formatted text.
+	 * @param fontsize Font size the text starts with.
+	 * @param maxw     Width the text has to fit in, or INT32_MAX.
+	 * @param param    Additional type specific parameter.
+	 */
+	StringLayoutKey(StringLayoutType type, const char *text, FontSize fontsize, int maxw, uint param) :
+			type(type), text(text), fontsize(fontsize), maxw(maxw), param(param)
+	{
+		/* FNV-1a over the text, followed by the other parts of the key. */
+		this->hash = 2166136261U;
+		for (const char *p = text; *p != '\0'; p++) this->hash = (this->hash ^ (byte)*p) * 16777619U;
+		this->hash = (this->hash ^ (type | fontsize << 8)) * 16777619U;
+		this->hash = (this->hash ^ (uint32)maxw) * 16777619U;
+		this->hash = (this->hash ^ param) * 16777619U;
+	}
+};
+
+/** A part of a line of text; lines are split at each SETX(Y). */
+struct StringLayoutRun {
+	uint start; ///< Position of the reordered text of the run in StringLayout::glyphs.
+	int offset; ///< Horizontal offset of the run, as set by SETX(Y).
+	int top;    ///< Vertical offset of the run, as set by SETXY.
+	int width;  ///< Width of the run in pixels.
+};
+
+/** A laid out string in the string layout cache. */
+struct StringLayout {
+	StringLayoutType type; ///< Type of the layout, #SLT_NONE when the entry is unused.
+	char *text;            ///< The formatted text the layout is made of.
+	FontSize fontsize;     ///< Font size the text starts with.
+	int maxw;              ///< Width the text has to fit in, or INT32_MAX.
+	uint param;            ///< Additional type specific parameter of the key.
+	uint32 hash;           ///< Hash of the key.
+
+	UChar *glyphs;                        ///< Text of all runs, after BiDi reordering and shaping (#SLT_LINE).
+	SmallVector<StringLayoutRun, 2> runs; ///< The runs of the line (#SLT_LINE).
+	int realign_width;                    ///< Width of the text to center the line around when SETX(Y) is used without aligning to the left, or -1 (#SLT_LINE).
+
+	char *lines;       ///< The text with a '\0' at each line break (#SLT_LINEBREAKS).
+	size_t lines_size; ///< Number of bytes in #lines (#SLT_LINEBREAKS).
+	uint32 linebreaks; ///< Number of added lines and the font size, as returned by FormatStringLinebreaks (#SLT_LINEBREAKS).
+	int height;        ///< Height of the broken text in pixels (#SLT_LINEBREAKS).
+
+	Dimension box;     ///< The bounding box (#SLT_BOUNDING_BOX).
+
+	/**
+	 * Check whether this is the layout belonging to a key.
+	 * @param key The key to compare with.
+	 * @return True iff the key matches.
+	 */
+	bool Matches(const StringLayoutKey &key) const
+	{
+		return this->type == key.type && this->hash == key.hash && this->fontsize == key.fontsize &&
+				this->maxw == key.maxw && this->param == key.param && strcmp(this->text, key.text) == 0;
+	}
+
+	/** Free the layout and mark the entry as unused. */
+	void Reset()
+	{
+		free(this->text);
+		free(this->glyphs);
+		free(this->lines);
+		this->text = NULL;
+		this->glyphs = NULL;
+		this->lines = NULL;
+		this->runs.Reset();
+		this->type = SLT_NONE;
+	}
+};
+
+static const uint STRING_LAYOUT_CACHE_SIZE = 1024; ///< Number of entries in the string layout cache; must be a power of 2.
+static StringLayout _string_layout_cache[STRING_LAYOUT_CACHE_SIZE]; ///< Cache of laid out strings, indexed by the hash of their key.
+static StringLayoutCacheStats _string_layout_cache_stats;            ///< Statistics of the string layout cache.
+
 /**
- * Draw string, possibly truncated to make it fit in its allocated space
- *
- * @param left   The left most position to draw on.
- * @param right  The right most position to draw on.
- * @param top    The top most position to draw on.
- * @param str    String to draw.
- * @param last   The end of the string buffer to draw.
- * @param params Text drawing parameters.
- * @param align  The alignment of the string when drawing left-to-right. In the
- *               case a right-to-left language is chosen this is inverted so it
- *               will be drawn in the right direction.
- * @param underline Whether to underline what has been drawn or not.
- * @param truncate  Whether to truncate the string or not.
- *
- * @return In case of left or center alignment the right most pixel we have drawn to.
- *         In case of right alignment the left most pixel we have drawn to.
+ * Look up a layout in the string layout cache.
+ * @param key The key of the layout.
+ * @return The layout, or NULL when it is not in the cache.
  */
-static int DrawString(int left, int right, int top, char *str, const char *last, DrawStringParams &params, StringAlignment align, bool underline = false, bool truncate = true)
+static const StringLayout *FindStringLayout(const StringLayoutKey &key)
 {
-	/* We need the outer limits of both left/right */
-	int min_left = INT32_MAX;
-	int max_right = INT32_MIN;
+	const StringLayout *sl = &_string_layout_cache[key.hash & (STRING_LAYOUT_CACHE_SIZE - 1)];
+	if (sl->Matches(key)) {
+		_string_layout_cache_stats.hits++;
+		return sl;
+	}
+	_string_layout_cache_stats.misses++;
+	return NULL;
+}
 
-	int initial_left = left;
-	int initial_right = right;
-	int initial_top = top;
+/**
+ * Claim the entry of the string layout cache for a layout, throwing out
+ * the layout that was stored there before. The caller fills in the layout.
+ * @param key The key of the layout.
+ * @return The (empty) entry.
+ */
+static StringLayout *AddStringLayout(const StringLayoutKey &key)
+{
+	StringLayout *sl = &_string_layout_cache[key.hash & (STRING_LAYOUT_CACHE_SIZE - 1)];
+	if (sl->type != SLT_NONE) {
+		_string_layout_cache_stats.evictions++;
+		sl->Reset();
+	} else {
+		_string_layout_cache_stats.entries++;
+	}
 
-	if (truncate) TruncateString(str, right - left + 1, (align & SA_STRIP) == SA_STRIP, params.fontsize);
+	sl->type     = key.type;
+	sl->text     = strdup(key.text);
+	sl->fontsize = key.fontsize;
+	sl->maxw     = key.maxw;
+	sl->param    = key.param;
+	sl->hash     = key.hash;
+	return sl;
+}
+
+/**
+ * Throw away all laid out strings. Must be called whenever the
+ * fonts, their sizes or the language (text direction) change.
+ */
+void ClearStringLayoutCache()
+{
+	for (uint i = 0; i < STRING_LAYOUT_CACHE_SIZE; i++) _string_layout_cache[i].Reset();
+	_string_layout_cache_stats.entries = 0;
+}
+
+/**
+ * Get the statistics of the string layout cache.
+ * @return The statistics.
+ */
+const StringLayoutCacheStats &GetStringLayoutCacheStats()
+{
+	return _string_layout_cache_stats;
+}
+
+/**
+ * Get the layout of a single line of text: the text is truncated, split
+ * at each SETX(Y), and every part is reordered for BiDi and measured.
+ * @param str      The text to lay out.
+ * @param maxw     Width to truncate the text to, or INT32_MAX to not truncate it.
+ * @param fontsize The size of the initial characters.
+ * @param align    The alignment of the text.
+ * @return The layout, valid until the next layout is made.
+ */
+static const StringLayout *GetLineLayout(const char *str, int maxw, FontSize fontsize, StringAlignment align)
+{
+	StringLayoutKey key(SLT_LINE, str, fontsize, maxw, align);
+	const StringLayout *found = FindStringLayout(key);
+	if (found != NULL) return found;
+
+	char buffer[DRAW_STRING_BUFFER];
+	strecpy(buffer, str, lastof(buffer));
+	if (maxw != INT32_MAX) TruncateString(buffer, maxw, (align & SA_STRIP) == SA_STRIP, fontsize);
 
 	/*
 	 * To support SETX and SETXY properly with RTL languages we have to
@@ -504,7 +647,8 @@ static int DrawString(int left, int right, int top, char *str, const char *last,
 
 	*setx_offsets.Append() = p;
 
-	char *loc = str;
+	int realign_width = -1;
+	char *loc = buffer;
 	for (;;) {
 		WChar c;
 		/* We cannot use Utf8Consume as we need the location of the SETX(Y) */
@@ -530,15 +674,12 @@ static int DrawString(int left, int right, int top, char *str, const char *last,
 			continue;
 		}
 
-		if ((align & SA_HOR_MASK) != SA_LEFT) {
+		if ((align & SA_HOR_MASK) != SA_LEFT && realign_width < 0) {
 			DEBUG(grf, 1, "Using SETX and/or SETXY when not aligned to the left. Fixing alignment...");
 
-			/* For left alignment and change the left so it will roughly be in the
-			 * middle. This will never cause the string to be completely centered,
-			 * but once SETX is used you cannot be sure the actual content of the
-			 * string is centered, so it doesn't really matter. */
-			align = SA_LEFT | SA_FORCE;
-			initial_left = left = max(left, (left + right - (int)GetStringBoundingBox(str).width) / 2);
+			/* The string is drawn left aligned, starting such that it will
+			 * roughly be in the middle; see DrawString. */
+			realign_width = GetStringBoundingBox(buffer).width;
 		}
 
 		/* We add the begin of the string, but don't add it twice */
@@ -556,22 +697,88 @@ static int DrawString(int left, int right, int top, char *str, const char *last,
 		if (c == SCC_SETXY) *p++ = *loc++;
 	}
 
-	/* In case we have a RTL language we swap the alignment. */
-	if (!(align & SA_FORCE) && _current_text_dir == TD_RTL && !(align & SA_STRIP) && (align & SA_HOR_MASK) != SA_HOR_CENTER) align ^= SA_RIGHT;
+	static SmallVector<UChar, 256> glyphs;
+	static SmallVector<StringLayoutRun, 4> runs;
+	glyphs.Clear();
+	runs.Clear();
 
+	int top = 0;
 	for (UChar **iter = setx_offsets.Begin(); iter != setx_offsets.End(); iter++) {
 		UChar *to_draw = *iter;
-		int offset = 0;
+		StringLayoutRun *run = runs.Append();
+		run->offset = 0;
 
 		/* Skip the SETX(Y) and set the appropriate offsets. */
 		if (*to_draw == SCC_SETX || *to_draw == SCC_SETXY) {
 			to_draw++;
-			offset = *to_draw++;
-			if (*to_draw == SCC_SETXY) top = initial_top + *to_draw++;
+			run->offset = *to_draw++;
+			if (*to_draw == SCC_SETXY) top = *to_draw++;
 		}
+		run->top = top;
 
 		to_draw = HandleBiDiAndArabicShapes(to_draw);
-		int w = GetStringWidth(to_draw, params.fontsize);
+		run->width = GetStringWidth(to_draw, fontsize);
+
+		run->start = glyphs.Length();
+		do {
+			*glyphs.Append() = *to_draw;
+		} while (*to_draw++ != '\0');
+	}
+
+	StringLayout *sl = AddStringLayout(key);
+	sl->glyphs = MallocT<UChar>(glyphs.Length());
+	MemCpyT(sl->glyphs, glyphs.Begin(), glyphs.Length());
+	MemCpyT(sl->runs.Append(runs.Length()), runs.Begin(), runs.Length());
+	sl->realign_width = realign_width;
+	return sl;
+}
+
+/**
+ * Draw string, possibly truncated to make it fit in its allocated space
+ *
+ * @param left   The left most position to draw on.
+ * @param right  The right most position to draw on.
+ * @param top    The top most position to draw on.
+ * @param str    String to draw.
+ * @param params Text drawing parameters.
+ * @param align  The alignment of the string when drawing left-to-right. In the
+ *               case a right-to-left language is chosen this is inverted so it
+ *               will be drawn in the right direction.
+ * @param underline Whether to underline what has been drawn or not.
+ * @param truncate  Whether to truncate the string or not.
+ *
+ * @return In case of left or center alignment the right most pixel we have drawn to.
+ *         In case of right alignment the left most pixel we have drawn to.
+ */
+static int DrawString(int left, int right, int top, const char *str, DrawStringParams &params, StringAlignment align, bool underline = false, bool truncate = true)
+{
+	/* We need the outer limits of both left/right */
+	int min_left = INT32_MAX;
+	int max_right = INT32_MIN;
+
+	int initial_left = left;
+	int initial_right = right;
+	int initial_top = top;
+
+	const StringLayout *sl = GetLineLayout(str, truncate ? right - left + 1 : INT32_MAX, params.fontsize, align);
+
+	if (sl->realign_width >= 0) {
+		/* For left alignment and change the left so it will roughly be in the
+		 * middle. This will never cause the string to be completely centered,
+		 * but once SETX is used you cannot be sure the actual content of the
+		 * string is centered, so it doesn't really matter. */
+		align = SA_LEFT | SA_FORCE;
+		initial_left = left = max(left, (left + right - sl->realign_width) / 2);
+	}
+
+	/* In case we have a RTL language we swap the alignment. */
+	if (!(align & SA_FORCE) && _current_text_dir == TD_RTL && !(align & SA_STRIP) && (align & SA_HOR_MASK) != SA_HOR_CENTER) align ^= SA_RIGHT;
+
+	for (const StringLayoutRun *run = sl->runs.Begin(); run != sl->runs.End(); run++) {
+		const UChar *to_draw = sl->glyphs + run->start;
+		int offset = run->offset;
+		int w = run->width;
+		top = initial_top + run->top;
 
 		/* right is the right most position to draw on. In this case we want to do
 		 * calculations with the width of the string. In comparison right can be
@@ -627,10 +834,8 @@ static int DrawString(int left, int right, int top, char *str, const char *last,
  */
 int DrawString(int left, int right, int top, const char *str, TextColour colour, StringAlignment align, bool underline, FontSize fontsize)
 {
-	char buffer[DRAW_STRING_BUFFER];
-	strecpy(buffer, str, lastof(buffer));
 	DrawStringParams params(colour, fontsize);
-	return DrawString(left, right, top, buffer, lastof(buffer), params, align, underline);
+	return DrawString(left, right, top, str, params, align, underline);
 }
 
 /**
@@ -652,30 +857,19 @@ int DrawString(int left, int right, int top, StringID str, TextColour colour, St
 	char buffer[DRAW_STRING_BUFFER];
 	GetString(buffer, str, lastof(buffer));
 	DrawStringParams params(colour, fontsize);
-	return DrawString(left, right, top, buffer, lastof(buffer), params, align, underline);
+	return DrawString(left, right, top, buffer, params, align, underline);
 }
 
 /**
- * 'Correct' a string to a maximum length. Longer strings will be cut into
- * additional lines at whitespace characters if possible. The string parameter
- * is modified with terminating characters mid-string which are the
- * placeholders for the newlines.
- * The string WILL be truncated if there was no whitespace for the current
- * line's maximum width.
- *
- * @note To know if the terminating '\0' is the string end or just a
- * newline, the returned 'num' value should be consulted. The num'th '\0',
- * starting with index 0 is the real string end.
- *
- * @param str string to check and correct for length restrictions
- * @param last the last valid location (for '\0') in the buffer of str
- * @param maxw the maximum width the string can have on one line
- * @param size Fontsize to start the text with
- * @return return a 32bit wide number consisting of 2 packed values:
- *  0 - 15 the number of lines ADDED to the string
- * 16 - 31 the fontsize in which the length calculation was done at
+ * Insert the line breaks into a string. This does the actual work for
+ * FormatStringLinebreaks, without looking in the string layout cache.
+ * @param str  String to check and correct for length restrictions.
+ * @param last The last valid location (for '\0') in the buffer of str.
+ * @param maxw The maximum width the string can have on one line.
+ * @param size Fontsize to start the text with.
+ * @return The number of added lines and the font size, see FormatStringLinebreaks.
  */
-uint32 FormatStringLinebreaks(char *str, const char *last, int maxw, FontSize size)
+static uint32 BreakStringLines(char *str, const char *last, int maxw, FontSize size)
 {
 	int num = 0;
 
@@ -794,6 +988,73 @@ static int GetMultilineStringHeight(const char *src, int num, FontSize start_fon
 }
 
 
+/**
+ * Get the layout of a string broken into lines.
+ * @param str  String to break into lines.
+ * @param size Size of the buffer the lines have to fit in.
+ * @param maxw The maximum width the string can have on one line.
+ * @param fontsize Fontsize to start the text with.
+ * @return The layout, valid until the next layout is made.
+ */
+static const StringLayout *GetLinebreakLayout(const char *str, size_t size, int maxw, FontSize fontsize)
+{
+	StringLayoutKey key(SLT_LINEBREAKS, str, fontsize, maxw, (uint)size);
+	const StringLayout *found = FindStringLayout(key);
+	if (found != NULL) return found;
+
+	/* Clear the buffer; a SETX(Y) that is cut off makes the line breaking read beyond the end of the text. */
+	char *lines = CallocT<char>(size);
+	strecpy(lines, str, lines + size - 1);
+	uint32 linebreaks = BreakStringLines(lines, lines + size - 1, maxw, fontsize);
+
+	/* The text ends at the terminator after the last added line. */
+	const char *end = lines;
+	for (int num = GB(linebreaks, 0, 16); num >= 0; num--) {
+		for (;;) {
+			WChar c = Utf8Consume(&end);
+			if (c == '\0') break;
+			if (c == SCC_SETX) end++;
+			if (c == SCC_SETXY) end += 2;
+		}
+	}
+
+	StringLayout *sl = AddStringLayout(key);
+	sl->lines_size = min<size_t>(end - lines, size);
+	sl->lines = ReallocT(lines, sl->lines_size);
+	sl->linebreaks = linebreaks;
+	sl->height = GetMultilineStringHeight(sl->lines, GB(linebreaks, 0, 16), fontsize);
+	return sl;
+}
+
+/**
+ * 'Correct' a string to a maximum length. Longer strings will be cut into
+ * additional lines at whitespace characters if possible. The string parameter
+ * is modified with terminating characters mid-string which are the
+ * placeholders for the newlines.
+ * The string WILL be truncated if there was no whitespace for the current
+ * line's maximum width.
+ *
+ * @note To know if the terminating '\0' is the string end or just a
+ * newline, the returned 'num' value should be consulted. The num'th '\0',
+ * starting with index 0 is the real string end.
+ *
+ * @param str string to check and correct for length restrictions
+ * @param last the last valid location (for '\0') in the buffer of str
+ * @param maxw the maximum width the string can have on one line
+ * @param size Fontsize to start the text with
+ * @return return a 32bit wide number consisting of 2 packed values:
+ *  0 - 15 the number of lines ADDED to the string
+ * 16 - 31 the fontsize in which the length calculation was done at
+ */
+uint32 FormatStringLinebreaks(char *str, const char *last, int maxw, FontSize size)
+{
+	assert(maxw > 0);
+
+	const StringLayout *sl = GetLinebreakLayout(str, last - str + 1, maxw, size);
+	MemCpyT(str, sl->lines, sl->lines_size);
+	return sl->linebreaks;
+}
+
 /**
  * Calculates height of string (in pixels). The string is changed to a multiline string if needed.
  * @param str string to check
@@ -806,9 +1067,7 @@ int GetStringHeight(StringID str, int maxw)
 
 	GetString(buffer, str, lastof(buffer));
 
-	uint32 tmp = FormatStringLinebreaks(buffer, lastof(buffer), maxw);
-
-	return GetMultilineStringHeight(buffer, GB(tmp, 0, 16), FS_NORMAL);
+	return GetLinebreakLayout(buffer, sizeof(buffer), maxw, FS_NORMAL)->height;
 }
 
 /**
@@ -832,13 +1091,7 @@ Dimension GetStringMultiLineBoundingBox(StringID str, const Dimension &suggestio
  */
 int GetStringHeight(const char *str, int maxw)
 {
-	char buffer[DRAW_STRING_BUFFER];
-
-	strecpy(buffer, str, lastof(buffer));
-
-	uint32 tmp = FormatStringLinebreaks(buffer, lastof(buffer), maxw);
-
-	return GetMultilineStringHeight(buffer, GB(tmp, 0, 16), FS_NORMAL);
+	return GetLinebreakLayout(str, DRAW_STRING_BUFFER, maxw, FS_NORMAL)->height;
 }
 
 /**
@@ -919,9 +1172,7 @@ static int DrawStringMultiLine(int left, int right, int top, int bottom, char *s
 	int written_top = bottom; // Uppermost position of rendering a line of text
 	for (;;) {
 		if (skip_lines == 0) {
-			char buf2[DRAW_STRING_BUFFER];
-			strecpy(buf2, src, lastof(buf2));
-			DrawString(left, right, y, buf2, lastof(buf2), params, align, underline, false);
+			DrawString(left, right, y, src, params, align, underline, false);
 			if (written_top > y) written_top = y;
 			y += mt;
 			num--;
@@ -999,16 +1250,13 @@ int DrawStringMultiLine(int left, int right, int top, int bottom, StringID str,
 }
 
 /**
- * Return the string dimension in pixels. The height and width are returned
- * in a single Dimension value. TINYFONT, BIGFONT modifiers are only
- * supported as the first character of the string. The returned dimensions
- * are therefore a rough estimation correct for all the current strings
- * but not every possible combination
+ * Calculate the bounding box of a string. This does the actual work for
+ * GetStringBoundingBox, without looking in the string layout cache.
  * @param str string to calculate pixel-width
  * @param start_fontsize Fontsize to start the text with
  * @return string width and height in pixels
  */
-Dimension GetStringBoundingBox(const char *str, FontSize start_fontsize)
+static Dimension CalcStringBoundingBox(const char *str, FontSize start_fontsize)
 {
 	FontSize size = start_fontsize;
 	Dimension br;
@@ -1044,6 +1292,27 @@ Dimension GetStringBoundingBox(const char *str, FontSize start_fontsize)
 	return br;
 }
 
+/**
+ * Return the string dimension in pixels. The height and width are returned
+ * in a single Dimension value. TINYFONT, BIGFONT modifiers are only
+ * supported as the first character of the string. The returned dimensions
+ * are therefore a rough estimation correct for all the current strings
+ * but not every possible combination
+ * @param str string to calculate pixel-width
+ * @param start_fontsize Fontsize to start the text with
+ * @return string width and height in pixels
+ */
+Dimension GetStringBoundingBox(const char *str, FontSize start_fontsize)
+{
+	StringLayoutKey key(SLT_BOUNDING_BOX, str, start_fontsize, INT32_MAX, 0);
+	const StringLayout *found = FindStringLayout(key);
+	if (found != NULL) return found->box;
+
+	Dimension box = CalcStringBoundingBox(str, start_fontsize);
+	AddStringLayout(key)->box = box;
+	return box;
+}
+
 /**
  * Get bounding box of a string. Uses parameters set by #DParam if needed.
  * Has the same restrictions as #GetStringBoundingBox(const char *str).
@@ -1176,26 +1445,35 @@ Dimension GetSpriteSize(SpriteID sprid, Point *offset, ZoomLevel zoom)
 	return d;
 }
 
+/**
+ * Get the colour remap a sprite is drawn with.
+ * @param img Image number to draw, including the transparency bit.
+ * @param pal Palette to use.
+ * @return The colour remap, or NULL if the sprite is drawn as is.
+ */
+const byte *GetSpriteColourRemap(SpriteID img, PaletteID pal)
+{
+	if (!HasBit(img, PALETTE_MODIFIER_TRANSPARENT) && pal == PAL_NONE) return NULL;
+	return GetNonSprite(GB(pal, 0, PALETTE_WIDTH), ST_RECOLOUR) + 1;
+}
+
 /**
  * Draw a sprite in a viewport.
- * @param img  Image number to draw
- * @param pal  Palette to use.
- * @param x    Left coordinate of image in viewport, scaled by zoom
- * @param y    Top coordinate of image in viewport, scaled by zoom
- * @param sub  If available, draw only specified part of the sprite
+ * The sprite data is looked up by the caller; this does not touch the sprite
+ * cache nor any other global drawing state, so different parts of the screen
+ * can be drawn at the same time.
+ * @param dpi    Part of the viewport to draw in.
+ * @param sprite The sprite data of \a img.
+ * @param remap  Colour remap of the sprite, see #GetSpriteColourRemap.
+ * @param img    Image number to draw
+ * @param x      Left coordinate of image in viewport, scaled by zoom
+ * @param y      Top coordinate of image in viewport, scaled by zoom
+ * @param sub    If available, draw only specified part of the sprite
  */
-void DrawSpriteViewport(SpriteID img, PaletteID pal, int x, int y, const SubSprite *sub)
+void DrawSpriteViewport(const DrawPixelInfo *dpi, const Sprite *sprite, const byte *remap, SpriteID img, int x, int y, const SubSprite *sub)
 {
-	SpriteID real_sprite = GB(img, 0, SPRITE_WIDTH);
-	if (HasBit(img, PALETTE_MODIFIER_TRANSPARENT)) {
-		_colour_remap_ptr = GetNonSprite(GB(pal, 0, PALETTE_WIDTH), ST_RECOLOUR) + 1;
-		GfxMainBlitterViewport(GetSprite(real_sprite, ST_NORMAL), x, y, BM_TRANSPARENT, sub, real_sprite);
-	} else if (pal != PAL_NONE) {
-		_colour_remap_ptr = GetNonSprite(GB(pal, 0, PALETTE_WIDTH), ST_RECOLOUR) + 1;
-		GfxMainBlitterViewport(GetSprite(real_sprite, ST_NORMAL), x, y, BM_COLOUR_REMAP, sub, real_sprite);
-	} else {
-		GfxMainBlitterViewport(GetSprite(real_sprite, ST_NORMAL), x, y, BM_NORMAL, sub, real_sprite);
-	}
+	BlitterMode mode = HasBit(img, PALETTE_MODIFIER_TRANSPARENT) ? BM_TRANSPARENT : (remap != NULL ? BM_COLOUR_REMAP : BM_NORMAL);
+	GfxMainBlitterViewport(dpi, sprite, x, y, mode, remap, sub, GB(img, 0, SPRITE_WIDTH));
 }
 
 /**
@@ -1212,18 +1490,17 @@ void DrawSprite(SpriteID img, PaletteID pal, int x, int y, const SubSprite *sub,
 	SpriteID real_sprite = GB(img, 0, SPRITE_WIDTH);
 	if (HasBit(img, PALETTE_MODIFIER_TRANSPARENT)) {
 		_colour_remap_ptr = GetNonSprite(GB(pal, 0, PALETTE_WIDTH), ST_RECOLOUR) + 1;
-		GfxMainBlitter(GetSprite(real_sprite, ST_NORMAL), x, y, BM_TRANSPARENT, sub, real_sprite, zoom);
+		GfxMainBlitter(GetSprite(real_sprite, ST_NORMAL, zoom), x, y, BM_TRANSPARENT, sub, real_sprite, zoom);
 	} else if (pal != PAL_NONE) {
 		_colour_remap_ptr = GetNonSprite(GB(pal, 0, PALETTE_WIDTH), ST_RECOLOUR) + 1;
-		GfxMainBlitter(GetSprite(real_sprite, ST_NORMAL), x, y, BM_COLOUR_REMAP, sub, real_sprite, zoom);
+		GfxMainBlitter(GetSprite(real_sprite, ST_NORMAL, zoom), x, y, BM_COLOUR_REMAP, sub, real_sprite, zoom);
 	} else {
-		GfxMainBlitter(GetSprite(real_sprite, ST_NORMAL), x, y, BM_NORMAL, sub, real_sprite, zoom);
+		GfxMainBlitter(GetSprite(real_sprite, ST_NORMAL, zoom), x, y, BM_NORMAL, sub, real_sprite, zoom);
 	}
 }
 
-static void GfxMainBlitterViewport(const Sprite *sprite, int x, int y, BlitterMode mode, const SubSprite *sub, SpriteID sprite_id)
+static void GfxMainBlitterViewport(const DrawPixelInfo *dpi, const Sprite *sprite, int x, int y, BlitterMode mode, const byte *remap, const SubSprite *sub, SpriteID sprite_id)
 {
-	const DrawPixelInfo *dpi = _cur_dpi;
 	Blitter::BlitterParams bp;
 
 	/* Amount of pixels to clip from the source sprite */
@@ -1255,7 +1532,7 @@ static void GfxMainBlitterViewport(const Sprite *sprite, int x, int y, BlitterMo
 
 	bp.dst = dpi->dst_ptr;
 	bp.pitch = dpi->pitch;
-	bp.remap = _colour_remap_ptr;
+	bp.remap = remap;
 
 	assert(sprite->width > 0);
 	assert(sprite->height > 0);
@@ -1573,6 +1850,7 @@ void LoadStringWidthTable(bool monospace)
 		_max_char_height = max<int>(_max_char_height, _max_char_size[fs].height);
 	}
 
+	ClearStringLayoutCache();
 	ReInitAllWindows();
 }
 
@@ -266,6 +266,14 @@ enum SpriteType {
 /** The number of milliseconds per game tick. */
 static const uint MILLISECONDS_PER_TICK = 30;
 
+/** Statistics of the cache of laid out strings. */
+struct StringLayoutCacheStats {
+	uint64 hits;      ///< Number of layouts found in the cache.
+	uint64 misses;    ///< Number of layouts that had to be made.
+	uint64 evictions; ///< Number of layouts thrown out of the cache to make room for another one.
+	uint entries;     ///< Number of layouts currently in the cache.
+};
+
 /** Information about the currently used palette. */
 struct Palette {
 	Colour palette[256]; ///< Current palette. Entry 0 has to be always fully transparent!
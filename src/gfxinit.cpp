@@ -241,7 +241,8 @@ static void SwitchNewGRFBlitter()
 	/* A GRF would like a 32 bpp blitter, switch blitter if needed. Never switch if the blitter was specified by the user. */
 	if (_blitter_autodetected && is_32bpp && BlitterFactoryBase::GetCurrentBlitter()->GetScreenDepth() != 0 && BlitterFactoryBase::GetCurrentBlitter()->GetScreenDepth() < 16) {
 		const char *cur_blitter = BlitterFactoryBase::GetCurrentBlitter()->GetName();
-		if (BlitterFactoryBase::SelectBlitter("32bpp-anim") != NULL) {
+		/* Prefer the SSE2 version of the blitter if the CPU supports it. */
+		if (BlitterFactoryBase::SelectBlitter("32bpp-sse2-anim") != NULL || BlitterFactoryBase::SelectBlitter("32bpp-anim") != NULL) {
 			if (!_video_driver->AfterBlitterChange()) {
 				/* Failed to switch blitter, let's hope we can return to the old one. */
 				if (BlitterFactoryBase::SelectBlitter(cur_blitter) == NULL || !_video_driver->AfterBlitterChange()) usererror("Failed to reinitialize video driver for 32 bpp blitter. Specify a fixed blitter in the config");
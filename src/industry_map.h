@@ -154,6 +154,7 @@ static inline void SetIndustryGfx(TileIndex t, IndustryGfx gfx)
 	assert(IsTileType(t, MP_INDUSTRY));
 	_m[t].m5 = GB(gfx, 0, 8);
 	SB(_m[t].m6, 2, 1, GB(gfx, 8, 1));
+	MarkMapBlockChanged(t);
 }
 
 /**
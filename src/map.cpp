@@ -29,6 +29,9 @@ uint _map_tile_mask; ///< _map_size - 1 (to mask the mapsize)
 Tile *_m = NULL;          ///< Tiles of the map
 TileExtended *_me = NULL; ///< Extended Tiles of the map
 
+uint32 *_map_block_generation = NULL; ///< Per block of tiles the generation of the last change of what the tiles are
+uint32 _map_generation = 1;           ///< The current generation of the map
+
 
 /**
  * (Re)allocates a map with the given dimension
@@ -57,9 +60,11 @@ void AllocateMap(uint size_x, uint size_y)
 
 	free(_m);
 	free(_me);
+	free(_map_block_generation);
 
 	_m = CallocT<Tile>(_map_size);
 	_me = CallocT<TileExtended>(_map_size);
+	_map_block_generation = CallocT<uint32>(_map_size >> (2 * MAP_BLOCK_BITS));
 }
 
 
@@ -426,4 +426,49 @@ static inline TileIndex RandomTileSeed(uint32 r)
 
 uint GetClosestWaterDistance(TileIndex tile, bool water);
 
+/** Number of bits of a tile coordinate that select the tile within a block of #_map_block_generation. */
+static const uint MAP_BLOCK_BITS = 4;
+
+/**
+ * Per block of 16x16 tiles the generation of the map in which the type of a
+ * tile, a house or an industry tile in the block was last changed.
+ */
+extern uint32 *_map_block_generation;
+
+/**
+ * The current generation of the map. Caches derived from the map remember
+ * the generation they were made in by calling #NewMapGeneration, so
+ * any later change of the tiles makes them out of date.
+ */
+extern uint32 _map_generation;
+
+/**
+ * Get the index of the block of #_map_block_generation a tile is in.
+ * @param x The X coordinate of the tile.
+ * @param y The Y coordinate of the tile.
+ * @return The index of the block.
+ */
+static inline uint MapBlockIndex(uint x, uint y)
+{
+	return (y >> MAP_BLOCK_BITS) * (MapSizeX() >> MAP_BLOCK_BITS) + (x >> MAP_BLOCK_BITS);
+}
+
+/**
+ * Note that what a tile is has changed, e.g. its tile type.
+ * @param tile The changed tile.
+ */
+static inline void MarkMapBlockChanged(TileIndex tile)
+{
+	_map_block_generation[MapBlockIndex(TileX(tile), TileY(tile))] = _map_generation;
+}
+
+/**
+ * Start a new generation of the map.
+ * @return The generation caches made now belong to.
+ */
+static inline uint32 NewMapGeneration()
+{
+	return ++_map_generation;
+}
+
 #endif /* MAP_FUNC_H */
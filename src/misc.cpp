@@ -27,6 +27,7 @@
 #include "window_func.h"
 #include "core/pool_type.hpp"
 #include "game/game.hpp"
+#include "order_func.h"
 
 
 extern TileIndex _cur_tileloop_tile;
@@ -41,6 +42,8 @@ void InitializeAirportGui();
 void InitializeDockGui();
 void InitializeObjectGui();
 void InitializeIndustries();
+void InitializeStations();
+void InitializeTowns();
 void InitializeObjects();
 void InitializeTrees();
 void InitializeCompanies();
@@ -76,6 +79,7 @@ void InitializeGame(uint size_x, uint size_y, bool reset_date, bool reset_settin
 	InitializeMusic();
 
 	InitializeVehicles();
+	InvalidateStationOrderLists();
 
 	InitNewsItemStructs();
 	InitializeLandscape();
@@ -87,6 +91,8 @@ void InitializeGame(uint size_x, uint size_y, bool reset_date, bool reset_settin
 	InitializeAIGui();
 	InitializeTrees();
 	InitializeIndustries();
+	InitializeStations();
+	InitializeTowns();
 	InitializeObjects();
 	InitializeBuildingCounts();
 
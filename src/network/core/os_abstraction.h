@@ -184,6 +184,14 @@ static inline void OTTDfreeaddrinfo(struct addrinfo *ai)
 #	include <errno.h>
 #	include <sys/time.h>
 #	include <netdb.h>
+
+/* Linux can poll many sockets at once and send many packets with one call */
+#	if defined(__linux__)
+#		include <sys/epoll.h>
+#		include <sys/uio.h>
+#		define HAVE_EPOLL
+#		define HAVE_WRITEV
+#	endif
 #endif /* UNIX */
 
 #ifdef __BEOS__
@@ -25,7 +25,7 @@
 NetworkTCPSocketHandler::NetworkTCPSocketHandler(SOCKET s) :
 		NetworkSocketHandler(),
 		packet_queue(NULL), packet_recv(NULL),
-		sock(s), writable(false)
+		sock(s), writable(false), readable(false)
 {
 }
 
@@ -40,6 +40,7 @@ NetworkTCPSocketHandler::~NetworkTCPSocketHandler()
 NetworkRecvStatus NetworkTCPSocketHandler::CloseConnection(bool error)
 {
 	this->writable = false;
+	this->readable = false;
 	NetworkSocketHandler::CloseConnection(error);
 
 	/* Free all pending and partially received packets */
@@ -105,7 +106,18 @@ SendPacketsState NetworkTCPSocketHandler::SendPackets(bool closing_down)
 
 	p = this->packet_queue;
 	while (p != NULL) {
+#ifdef HAVE_WRITEV
+		/* Hand a batch of packets to the OS at once. */
+		struct iovec iov[16];
+		int count = 0;
+		for (Packet *q = p; q != NULL && count < (int)lengthof(iov); q = q->next, count++) {
+			iov[count].iov_base = q->buffer + q->pos;
+			iov[count].iov_len = q->size - q->pos;
+		}
+		res = writev(this->sock, iov, count);
+#else
 		res = send(this->sock, (const char*)p->buffer + p->pos, p->size - p->pos, 0);
+#endif
 		if (res == -1) {
 			int err = GET_LAST_ERROR();
 			if (err != EWOULDBLOCK) {
@@ -116,6 +128,8 @@ SendPacketsState NetworkTCPSocketHandler::SendPackets(bool closing_down)
 				}
 				return SPS_CLOSED;
 			}
+			/* Wait till the OS tells us we can write again. */
+			this->writable = false;
 			return SPS_PARTLY_SENT;
 		}
 		if (res == 0) {
@@ -124,16 +138,20 @@ SendPacketsState NetworkTCPSocketHandler::SendPackets(bool closing_down)
 			return SPS_CLOSED;
 		}
 
-		p->pos += res;
+		/* Remove the packets that are sent completely. */
+		size_t sent = res;
+		while (sent > 0) {
+			size_t left = p->size - p->pos;
+			if (sent < left) {
+				p->pos += (PacketSize)sent;
+				return SPS_PARTLY_SENT;
+			}
+			sent -= left;
 
-		/* Is this packet sent? */
-		if (p->pos == p->size) {
 			/* Go to the next packet */
 			this->packet_queue = p->next;
 			delete p;
 			p = this->packet_queue;
-		} else {
-			return SPS_PARTLY_SENT;
 		}
 	}
 
@@ -170,6 +188,7 @@ Packet *NetworkTCPSocketHandler::ReceivePacket()
 					return NULL;
 				}
 				/* Connection would block, so stop for now */
+				this->readable = false;
 				return NULL;
 			}
 			if (res == 0) {
@@ -201,6 +220,7 @@ Packet *NetworkTCPSocketHandler::ReceivePacket()
 				return NULL;
 			}
 			/* Connection would block */
+			this->readable = false;
 			return NULL;
 		}
 		if (res == 0) {
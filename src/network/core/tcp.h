@@ -35,6 +35,7 @@ private:
 public:
 	SOCKET sock;              ///< The socket currently connected to
 	bool writable;            ///< Can we write to this socket?
+	bool readable;            ///< Might there be something to receive on this socket?
 
 	/**
 	 * Whether this socket is currently bound to a socket.
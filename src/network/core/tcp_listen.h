@@ -33,6 +33,69 @@ class TCPListenHandler {
 	/** List of sockets we listen on. */
 	static SocketList sockets;
 
+#ifdef HAVE_EPOLL
+	/** The epoll instance watching the listening and accepted sockets, or -1 when using select. */
+	static int epoll_fd;
+
+	/** Marker in the epoll data for the sockets we listen on. */
+	static const uint32 EPOLL_LISTENER = UINT32_MAX;
+
+	/**
+	 * Let the epoll instance watch a socket.
+	 * Accepted sockets are edge-triggered, so their readiness is kept in
+	 * Tsocket::readable and Tsocket::writable until the OS says otherwise.
+	 * @param s     The socket to watch.
+	 * @param index The index of the socket in the pool, or #EPOLL_LISTENER.
+	 */
+	static void EpollAdd(SOCKET s, uint32 index)
+	{
+		struct epoll_event event;
+		memset(&event, 0, sizeof(event));
+		event.events = (index == EPOLL_LISTENER) ? EPOLLIN : (EPOLLIN | EPOLLOUT | EPOLLET);
+		event.data.u64 = ((uint64)index << 32) | (uint32)s;
+		if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, s, &event) != 0) {
+			DEBUG(net, 0, "[%s] epoll_ctl failed with error %d", Tsocket::GetName(), errno);
+		}
+	}
+
+	/**
+	 * Handle the receiving of packets using epoll.
+	 * Only the sockets that have something to receive are read from.
+	 */
+	static void ReceiveEpoll()
+	{
+		struct epoll_event events[64];
+		int n;
+		do {
+			n = epoll_wait(epoll_fd, events, lengthof(events), 0); // don't block at all.
+
+			for (int i = 0; i < n; i++) {
+				uint32 index = (uint32)(events[i].data.u64 >> 32);
+				SOCKET s = (SOCKET)(uint32)events[i].data.u64;
+
+				/* accept clients.. */
+				if (index == EPOLL_LISTENER) {
+					AcceptClient(s);
+					continue;
+				}
+
+				/* The socket might have been closed by an earlier event. */
+				Tsocket *cs = Tsocket::GetIfValid(index);
+				if (cs == NULL || cs->sock != s) continue;
+
+				if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) cs->readable = true;
+				if (events[i].events & EPOLLOUT) cs->writable = true;
+			}
+		} while (n == lengthof(events));
+
+		/* read stuff from clients */
+		Tsocket *cs;
+		FOR_ALL_ITEMS_FROM(Tsocket, idx, cs, 0) {
+			if (cs->readable) cs->ReceivePackets();
+		}
+	}
+#endif /* HAVE_EPOLL */
+
 public:
 	/**
 	 * Accepts clients from the sockets.
@@ -85,6 +148,12 @@ public:
 				continue;
 			}
 
+#ifdef HAVE_EPOLL
+			if (epoll_fd != -1) {
+				EpollAdd(s, (uint32)Tsocket::AcceptConnection(s, address)->index);
+				continue;
+			}
+#endif
 			Tsocket::AcceptConnection(s, address);
 		}
 	}
@@ -95,6 +164,13 @@ public:
 	 */
 	static bool Receive()
 	{
+#ifdef HAVE_EPOLL
+		if (epoll_fd != -1) {
+			ReceiveEpoll();
+			return _networking;
+		}
+#endif
+
 		fd_set read_fd, write_fd;
 		struct timeval tv;
 
@@ -157,6 +233,18 @@ public:
 			return false;
 		}
 
+#ifdef HAVE_EPOLL
+		/* When epoll is not available fall back to select. */
+		epoll_fd = epoll_create(MAX_CLIENT_SLOTS);
+		if (epoll_fd == -1) {
+			DEBUG(net, 1, "[%s] epoll_create failed with error %d, using select", Tsocket::GetName(), errno);
+		} else {
+			for (SocketList::iterator s = sockets.Begin(); s != sockets.End(); s++) {
+				EpollAdd(s->second, EPOLL_LISTENER);
+			}
+		}
+#endif
+
 		return true;
 	}
 
@@ -167,11 +255,18 @@ public:
 			closesocket(s->second);
 		}
 		sockets.Clear();
+#ifdef HAVE_EPOLL
+		if (epoll_fd != -1) close(epoll_fd);
+		epoll_fd = -1;
+#endif
 		DEBUG(net, 1, "[%s] closed listeners", Tsocket::GetName());
 	}
 };
 
 template <class Tsocket, PacketType Tfull_packet, PacketType Tban_packet> SocketList TCPListenHandler<Tsocket, Tfull_packet, Tban_packet>::sockets;
+#ifdef HAVE_EPOLL
+template <class Tsocket, PacketType Tfull_packet, PacketType Tban_packet> int TCPListenHandler<Tsocket, Tfull_packet, Tban_packet>::epoll_fd = -1;
+#endif
 
 #endif /* ENABLE_NETWORK */
 
@@ -491,8 +491,9 @@ void ParseConnectionString(const char **company, const char **port, char *connec
  * Handle the acception of a connection to the server.
  * @param s The socket of the new connection.
  * @param address The address of the peer.
+ * @return The handler of the new connection.
  */
-/* static */ void ServerNetworkGameSocketHandler::AcceptConnection(SOCKET s, const NetworkAddress &address)
+/* static */ ServerNetworkGameSocketHandler *ServerNetworkGameSocketHandler::AcceptConnection(SOCKET s, const NetworkAddress &address)
 {
 	/* Register the login */
 	_network_clients_connected++;
@@ -500,6 +501,7 @@ void ParseConnectionString(const char **company, const char **port, char *connec
 	SetWindowDirty(WC_CLIENT_LIST, 0);
 	ServerNetworkGameSocketHandler *cs = new ServerNetworkGameSocketHandler(s);
 	cs->client_address = address; // Save the IP of the client
+	return cs;
 }
 
 /**
@@ -529,6 +531,7 @@ void NetworkClose(bool close_admins)
 		FOR_ALL_CLIENT_SOCKETS(cs) {
 			cs->CloseConnection(NETWORK_RECV_STATUS_CONN_LOST);
 		}
+		NetworkServerCloseSharedMap();
 		ServerNetworkGameSocketHandler::CloseListeners();
 		ServerNetworkAdminSocketHandler::CloseListeners();
 	} else if (MyClient::my_client != NULL) {
@@ -113,11 +113,13 @@ ServerNetworkAdminSocketHandler::~ServerNetworkAdminSocketHandler()
  * Handle the acception of a connection.
  * @param s The socket of the new connection.
  * @param address The address of the peer.
+ * @return The handler of the new connection.
  */
-/* static */ void ServerNetworkAdminSocketHandler::AcceptConnection(SOCKET s, const NetworkAddress &address)
+/* static */ ServerNetworkAdminSocketHandler *ServerNetworkAdminSocketHandler::AcceptConnection(SOCKET s, const NetworkAddress &address)
 {
 	ServerNetworkAdminSocketHandler *as = new ServerNetworkAdminSocketHandler(s);
 	as->address = address; // Save the IP of the client
+	return as;
 }
 
 /***********
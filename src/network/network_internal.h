@@ -163,7 +163,7 @@ struct CommandPacket : CommandContainer {
 void NetworkDistributeCommands();
 void NetworkExecuteLocalCommandQueue();
 void NetworkFreeLocalCommandQueue();
-void NetworkSyncCommandQueue(NetworkClientSocket *cs);
+void NetworkSyncCommandQueue(CommandQueue *queue);
 
 void NetworkError(StringID error_string);
 void NetworkTextMessage(NetworkAction action, TextColour colour, bool self_send, const char *name, const char *str = "", int64 data = 0);
@@ -52,35 +52,175 @@ INSTANTIATE_POOL_METHODS(NetworkClientSocket)
 /** Instantiate the listen sockets. */
 template SocketList TCPListenHandler<ServerNetworkGameSocketHandler, PACKET_SERVER_FULL, PACKET_SERVER_BANNED>::sockets;
 
+/** Number of frames a snapshot of the map is handed to clients that start joining after it was made. */
+static const uint NETWORK_SHARED_MAP_WINDOW = 2 * DAY_TICKS;
+
+/**
+ * A snapshot of the map for joining clients. All clients that start to
+ * download the map within a short window of each other share the same
+ * snapshot, so the game is only saved and compressed once for them.
+ */
+struct NetworkSharedMap {
+	uint32 frame;          ///< The frame the snapshot was made at.
+	Packet *packets;       ///< The packets of the savegame; once finished the last is PACKET_SERVER_MAP_DONE.
+	size_t total_size;     ///< Total size of the compressed savegame, valid once finished.
+	bool finished;         ///< Whether all packets of the savegame have been written.
+	bool saving;           ///< Whether the savegame is still being written to this snapshot.
+	uint refcount;         ///< Number of clients, and the server while the snapshot is open, using it.
+	ThreadMutex *mutex;    ///< Mutex for making threaded saving safe.
+	CommandQueue commands; ///< Commands that have to be executed after the snapshot, for clients joining late.
+
+	/** Create a snapshot at the current frame, with one reference for the server. */
+	NetworkSharedMap() : frame(_frame_counter), packets(NULL), total_size(0), finished(false), saving(true), refcount(1)
+	{
+		this->mutex = ThreadMutex::New();
+		NetworkSyncCommandQueue(&this->commands);
+	}
+
+	/** Free all packets of the snapshot. */
+	~NetworkSharedMap()
+	{
+		while (this->packets != NULL) {
+			Packet *p = this->packets->next;
+			delete this->packets;
+			this->packets = p;
+		}
+
+		delete this->mutex;
+	}
+
+	/** Add a reference to this snapshot. */
+	void AddRef()
+	{
+		this->mutex->BeginCritical();
+		this->refcount++;
+		this->mutex->EndCritical();
+	}
+
+	/**
+	 * Remove a reference to this snapshot. When nobody uses it anymore,
+	 * it is freed; or aborted first when it is still being saved.
+	 * @return True when the snapshot is still being saved, but is being aborted now.
+	 */
+	bool Release()
+	{
+		this->mutex->BeginCritical();
+		assert(this->refcount > 0);
+		bool unused = --this->refcount == 0;
+		bool saving = this->saving;
+		this->mutex->EndCritical();
+
+		if (unused && !saving) delete this;
+		return unused && saving;
+	}
+
+	/** Mark that the saving to this snapshot has ended, successful or not. */
+	void SaveDone()
+	{
+		this->mutex->BeginCritical();
+		this->saving = false;
+		bool unused = this->refcount == 0;
+		this->mutex->EndCritical();
+
+		if (unused) delete this;
+	}
+
+	/**
+	 * Check whether nobody uses this snapshot anymore.
+	 * @return True when the saving can be aborted.
+	 */
+	bool IsAbandoned()
+	{
+		this->mutex->BeginCritical();
+		bool abandoned = this->refcount == 0;
+		this->mutex->EndCritical();
+		return abandoned;
+	}
+
+	/**
+	 * Get the total size of the savegame.
+	 * @param size Where to write the size to.
+	 * @return True when the savegame is finished and the size is known.
+	 */
+	bool GetTotalSize(size_t *size)
+	{
+		this->mutex->BeginCritical();
+		bool finished = this->finished;
+		*size = this->total_size;
+		this->mutex->EndCritical();
+		return finished;
+	}
+
+	/**
+	 * Get the packet following a given packet of the savegame.
+	 * @param last The last packet that was handled, or NULL to start at the beginning.
+	 * @return The next packet, or NULL when it has not been written yet.
+	 */
+	Packet *GetPacketAfter(Packet *last)
+	{
+		this->mutex->BeginCritical();
+		Packet *p = (last == NULL) ? this->packets : last->next;
+		this->mutex->EndCritical();
+		return p;
+	}
+};
+
+/** The snapshot of the map new joining clients will get, if any. */
+static NetworkSharedMap *_network_shared_map = NULL;
+
+/** Stop handing out the current snapshot of the map to new joining clients. */
+void NetworkServerCloseSharedMap()
+{
+	if (_network_shared_map == NULL) return;
+
+	_network_shared_map->Release();
+	_network_shared_map = NULL;
+}
+
+/**
+ * Remember a command that is distributed while a snapshot of the map is
+ * open, so clients joining later on get it as well.
+ * @param cp The command that is distributed.
+ */
+void NetworkServerShareCommand(CommandPacket *cp)
+{
+	if (_network_shared_map == NULL) return;
+
+	_network_shared_map->commands.Append(cp);
+}
+
+/**
+ * Get the snapshot of the map new joining clients will get.
+ * @return The snapshot, or NULL when there is none or it is too old.
+ */
+static NetworkSharedMap *GetOpenSharedMap()
+{
+	if (_network_shared_map != NULL && _frame_counter - _network_shared_map->frame > NETWORK_SHARED_MAP_WINDOW) {
+		NetworkServerCloseSharedMap();
+	}
+	return _network_shared_map;
+}
+
 /** Writing a savegame directly to a number of packets. */
 struct PacketWriter : SaveFilter {
-	ServerNetworkGameSocketHandler *cs; ///< Socket we are associated with.
-	Packet *current;                    ///< The packet we're currently writing to.
-	size_t total_size;                  ///< Total size of the compressed savegame.
+	NetworkSharedMap *map; ///< Snapshot we are writing.
+	Packet *current;       ///< The packet we're currently writing to.
+	Packet *last;          ///< The last packet we added to the snapshot.
+	size_t total_size;     ///< Total size of the compressed savegame.
 
 	/**
 	 * Create the packet writer.
-	 * @param cs The socket handler we're making the packets for.
+	 * @param map The snapshot we're making the packets for.
 	 */
-	PacketWriter(ServerNetworkGameSocketHandler *cs) : SaveFilter(NULL), cs(cs), current(NULL), total_size(0)
+	PacketWriter(NetworkSharedMap *map) : SaveFilter(NULL), map(map), current(NULL), last(NULL), total_size(0)
 	{
-		this->cs->savegame_mutex = ThreadMutex::New();
 	}
 
 	/** Make sure everything is cleaned up. */
 	~PacketWriter()
 	{
-		/* Prevent double frees. */
-		if (this->cs != NULL) {
-			if (this->cs->savegame_mutex != NULL) this->cs->savegame_mutex->BeginCritical();
-			this->cs->savegame = NULL;
-			if (this->cs->savegame_mutex != NULL) this->cs->savegame_mutex->EndCritical();
-
-			delete this->cs->savegame_mutex;
-			this->cs->savegame_mutex = NULL;
-		}
-
 		delete this->current;
+		this->map->SaveDone();
 	}
 
 	/** Append the current packet to the queue. */
@@ -88,24 +228,23 @@ struct PacketWriter : SaveFilter {
 	{
 		if (this->current == NULL) return;
 
-		Packet **p = &this->cs->savegame_packets;
-		while (*p != NULL) {
-			p = &(*p)->next;
+		if (this->last == NULL) {
+			this->map->packets = this->current;
+		} else {
+			this->last->next = this->current;
 		}
-		*p = this->current;
+		this->last = this->current;
 
 		this->current = NULL;
 	}
 
 	/* virtual */ void Write(byte *buf, size_t size)
 	{
-		/* We want to abort the saving when the socket is closed. */
-		if (this->cs == NULL) SlError(STR_NETWORK_ERROR_LOSTCONNECTION);
+		/* We want to abort the saving when nobody wants the map anymore. */
+		if (this->map->IsAbandoned()) SlError(STR_NETWORK_ERROR_LOSTCONNECTION);
 
 		if (this->current == NULL) this->current = new Packet(PACKET_SERVER_MAP_DATA);
 
-		if (this->cs->savegame_mutex != NULL) this->cs->savegame_mutex->BeginCritical();
-
 		byte *bufe = buf + size;
 		while (buf != bufe) {
 			size_t to_write = min(SEND_MTU - this->current->size, bufe - buf);
@@ -114,22 +253,22 @@ struct PacketWriter : SaveFilter {
 			buf += to_write;
 
 			if (this->current->size == SEND_MTU) {
+				this->map->mutex->BeginCritical();
 				this->AppendQueue();
+				this->map->mutex->EndCritical();
 				if (buf != bufe) this->current = new Packet(PACKET_SERVER_MAP_DATA);
 			}
 		}
 
-		if (this->cs->savegame_mutex != NULL) this->cs->savegame_mutex->EndCritical();
-
 		this->total_size += size;
 	}
 
 	/* virtual */ void Finish()
 	{
-		/* We want to abort the saving when the socket is closed. */
-		if (this->cs == NULL) SlError(STR_NETWORK_ERROR_LOSTCONNECTION);
+		/* We want to abort the saving when nobody wants the map anymore. */
+		if (this->map->IsAbandoned()) SlError(STR_NETWORK_ERROR_LOSTCONNECTION);
 
-		if (this->cs->savegame_mutex != NULL) this->cs->savegame_mutex->BeginCritical();
+		this->map->mutex->BeginCritical();
 
 		/* Make sure the last packet is flushed. */
 		this->AppendQueue();
@@ -138,15 +277,26 @@ struct PacketWriter : SaveFilter {
 		this->current = new Packet(PACKET_SERVER_MAP_DONE);
 		this->AppendQueue();
 
-		/* Fast-track the size to the client. */
-		Packet *p = new Packet(PACKET_SERVER_MAP_SIZE);
-		p->Send_uint32((uint32)this->total_size);
-		this->cs->NetworkTCPSocketHandler::SendPacket(p);
+		this->map->total_size = this->total_size;
+		this->map->finished = true;
 
-		if (this->cs->savegame_mutex != NULL) this->cs->savegame_mutex->EndCritical();
+		this->map->mutex->EndCritical();
 	}
 };
 
+/**
+ * Make a copy of a savegame packet, as the packets of a snapshot are sent to multiple clients.
+ * @param p The packet to copy.
+ * @return The copy.
+ */
+static Packet *CopySavegamePacket(const Packet *p)
+{
+	Packet *copy = new Packet((PacketType)p->buffer[sizeof(PacketSize)]);
+	memcpy(copy->buffer + copy->size, p->buffer + copy->size, p->size - copy->size);
+	copy->size = p->size;
+	return copy;
+}
+
 
 /**
  * Create a new socket for the server side of the game connection.
@@ -172,24 +322,21 @@ ServerNetworkGameSocketHandler::~ServerNetworkGameSocketHandler()
 	if (_redirect_console_to_client == this->client_id) _redirect_console_to_client = INVALID_CLIENT_ID;
 	OrderBackup::ResetUser(this->client_id);
 
-	if (this->savegame_mutex != NULL) this->savegame_mutex->BeginCritical();
-	if (this->savegame != NULL) this->savegame->cs = NULL;
-	if (this->savegame_mutex != NULL) this->savegame_mutex->EndCritical();
+	bool aborted = false;
+	if (this->savegame != NULL) {
+		/* When nobody else is downloading the snapshot that is handed out,
+		 * stop handing it out so its saving is aborted. References are only
+		 * added and removed by the main thread, so no locking is needed. */
+		if (this->savegame == _network_shared_map && this->savegame->refcount == 2) NetworkServerCloseSharedMap();
+		aborted = this->savegame->Release();
+	}
 
-	/* Make sure the saving is completely cancelled.
+	/* Make sure the aborted saving is completely cancelled.
 	 * Yes, we need to handle the save finish as well
 	 * as the next connection in this "loop" might
 	 * just be requesting the map and such. */
-	WaitTillSaved();
+	if (aborted) WaitTillSaved();
 	ProcessAsyncSaveFinish();
-
-	while (this->savegame_packets != NULL) {
-		Packet *p = this->savegame_packets->next;
-		delete this->savegame_packets;
-		this->savegame_packets = p;
-	}
-
-	delete this->savegame_mutex;
 }
 
 Packet *ServerNetworkGameSocketHandler::ReceivePacket()
@@ -205,13 +352,6 @@ Packet *ServerNetworkGameSocketHandler::ReceivePacket()
 	return p;
 }
 
-void ServerNetworkGameSocketHandler::SendPacket(Packet *packet)
-{
-	if (this->savegame_mutex != NULL) this->savegame_mutex->BeginCritical();
-	this->NetworkTCPSocketHandler::SendPacket(packet);
-	if (this->savegame_mutex != NULL) this->savegame_mutex->EndCritical();
-}
-
 NetworkRecvStatus ServerNetworkGameSocketHandler::CloseConnection(NetworkRecvStatus status)
 {
 	assert(status != NETWORK_RECV_STATUS_OKAY);
@@ -518,49 +658,81 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::SendWait()
 	return NETWORK_RECV_STATUS_OKAY;
 }
 
+/**
+ * Tell the client how large the map is, if that is known already.
+ * This must happen before the client gets the end of the map.
+ */
+void ServerNetworkGameSocketHandler::SendMapSize()
+{
+	size_t size;
+	if (this->savegame_size_sent || !this->savegame->GetTotalSize(&size)) return;
+
+	Packet *p = new Packet(PACKET_SERVER_MAP_SIZE);
+	p->Send_uint32((uint32)size);
+	this->SendPacket(p);
+	this->savegame_size_sent = true;
+}
+
 /** This sends the map to the client */
 NetworkRecvStatus ServerNetworkGameSocketHandler::SendMap()
 {
-	static uint sent_packets; // How many packets we did send succecfully last time
-
 	if (this->status < STATUS_AUTHORIZED) {
 		/* Illegal call, return error and ignore the packet */
 		return this->SendError(NETWORK_ERROR_NOT_AUTHORIZED);
 	}
 
 	if (this->status == STATUS_AUTHORIZED) {
-		this->savegame = new PacketWriter(this);
+		/* Join the snapshot other clients are getting, or make a new one. */
+		NetworkSharedMap *map = GetOpenSharedMap();
+		bool new_map = map == NULL;
+		if (new_map) {
+			/* Only one savegame can be written at a time. */
+			WaitTillSaved();
+			_network_shared_map = map = new NetworkSharedMap();
+		}
+		map->AddRef();
+
+		this->savegame = map;
+		this->savegame_last = NULL;
+		this->savegame_size_sent = false;
+		this->savegame_send_count = 4; // We start with trying 4 packets
 
-		/* Now send the _frame_counter and how many packets are coming */
+		/* Now send the frame of the snapshot */
 		Packet *p = new Packet(PACKET_SERVER_MAP_BEGIN);
-		p->Send_uint32(_frame_counter);
+		p->Send_uint32(map->frame);
 		this->SendPacket(p);
 
-		NetworkSyncCommandQueue(this);
+		/* Everything that has to be executed after the snapshot. */
+		for (CommandPacket *cp = map->commands.Peek(); cp != NULL; cp = cp->next) {
+			this->outgoing_queue.Append(cp);
+		}
 		this->status = STATUS_MAP;
 		/* Mark the start of download */
 		this->last_frame = _frame_counter;
 		this->last_frame_server = _frame_counter;
 
-		sent_packets = 4; // We start with trying 4 packets
-
-		/* Make a dump of the current game */
-		if (SaveWithFilter(this->savegame, true) != SL_OK) usererror("network savedump failed");
+		if (new_map) {
+			/* Make a dump of the current game */
+			if (SaveWithFilter(new PacketWriter(map), true) != SL_OK) usererror("network savedump failed");
+		}
 	}
 
 	if (this->status == STATUS_MAP) {
-		if (this->savegame_mutex != NULL) this->savegame_mutex->BeginCritical();
+		/* Fast-track the size to the client. */
+		this->SendMapSize();
 
 		bool last_packet = false;
 
-		for (uint i = 0; i < sent_packets && this->savegame_packets != NULL; i++) {
-			Packet *p = this->savegame_packets;
+		for (uint i = 0; i < this->savegame_send_count; i++) {
+			Packet *p = this->savegame->GetPacketAfter(this->savegame_last);
+			if (p == NULL) break;
+
+			this->savegame_last = p;
 			last_packet = p->buffer[2] == PACKET_SERVER_MAP_DONE;
 
-			/* Remove the packet from the savegame queue and put it in the real queue. */
-			this->savegame_packets = p->next;
-			p->next = NULL;
-			this->NetworkTCPSocketHandler::SendPacket(p);
+			/* The size must arrive before the end of the map. */
+			if (last_packet) this->SendMapSize();
+			this->SendPacket(CopySavegamePacket(p));
 
 			if (last_packet) {
 				/* There is no more data, so break the for */
@@ -568,36 +740,23 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::SendMap()
 			}
 		}
 
-		if (this->savegame_mutex != NULL) this->savegame_mutex->EndCritical();
-
 		if (last_packet) {
 			/* Done reading, make sure saving is done as well */
 			WaitTillSaved();
 
+			this->savegame->Release();
+			this->savegame = NULL;
+
 			/* Set the status to DONE_MAP, no we will wait for the client
 			 *  to send it is ready (maybe that happens like never ;)) */
 			this->status = STATUS_DONE_MAP;
 
-			/* Find the best candidate for joining, i.e. the first joiner. */
+			/* Let everyone who was waiting start joining; they all share the same new snapshot. */
 			NetworkClientSocket *new_cs;
-			NetworkClientSocket *best = NULL;
 			FOR_ALL_CLIENT_SOCKETS(new_cs) {
 				if (new_cs->status == STATUS_MAP_WAIT) {
-					if (best == NULL || best->GetInfo()->join_date > new_cs->GetInfo()->join_date || (best->GetInfo()->join_date == new_cs->GetInfo()->join_date && best->client_id > new_cs->client_id)) {
-						best = new_cs;
-					}
-				}
-			}
-
-			/* Is there someone else to join? */
-			if (best != NULL) {
-				/* Let the first start joining. */
-				best->status = STATUS_AUTHORIZED;
-				best->SendMap();
-
-				/* And update the rest. */
-				FOR_ALL_CLIENT_SOCKETS(new_cs) {
-					if (new_cs->status == STATUS_MAP_WAIT) new_cs->SendWait();
+					new_cs->status = STATUS_AUTHORIZED;
+					new_cs->SendMap();
 				}
 			}
 		}
@@ -607,8 +766,8 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::SendMap()
 				return NETWORK_RECV_STATUS_CONN_LOST;
 
 			case SPS_ALL_SENT:
-				/* All are sent, increase the sent_packets */
-				if (this->savegame_packets != NULL) sent_packets *= 2;
+				/* All are sent, increase the send count */
+				if (!last_packet) this->savegame_send_count *= 2;
 				break;
 
 			case SPS_PARTLY_SENT:
@@ -616,8 +775,8 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::SendMap()
 				break;
 
 			case SPS_NONE_SENT:
-				/* Not everything is sent, decrease the sent_packets */
-				if (sent_packets > 1) sent_packets /= 2;
+				/* Not everything is sent, decrease the send count */
+				if (this->savegame_send_count > 1) this->savegame_send_count /= 2;
 				break;
 		}
 	}
@@ -975,12 +1134,14 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::Receive_CLIENT_GETMAP(Packet *
 		return this->SendError(NETWORK_ERROR_NOT_AUTHORIZED);
 	}
 
-	/* Check if someone else is receiving the map */
-	FOR_ALL_CLIENT_SOCKETS(new_cs) {
-		if (new_cs->status == STATUS_MAP) {
-			/* Tell the new client to wait */
-			this->status = STATUS_MAP_WAIT;
-			return this->SendWait();
+	/* Check if someone else is receiving a map we cannot share */
+	if (GetOpenSharedMap() == NULL) {
+		FOR_ALL_CLIENT_SOCKETS(new_cs) {
+			if (new_cs->status == STATUS_MAP) {
+				/* Tell the new client to wait */
+				this->status = STATUS_MAP_WAIT;
+				return this->SendWait();
+			}
 		}
 	}
 
@@ -1766,6 +1927,9 @@ void NetworkServer_Tick(bool send_frame)
 	}
 #endif
 
+	/* Stop sharing the snapshot of the map when it gets too old. */
+	GetOpenSharedMap();
+
 	/* Now we are done with the frame, inform the clients that they can
 	 *  do their frame! */
 	FOR_ALL_CLIENT_SOCKETS(cs) {
@@ -51,6 +51,7 @@ protected:
 	NetworkRecvStatus SendWait();
 	NetworkRecvStatus SendNeedGamePassword();
 	NetworkRecvStatus SendNeedCompanyPassword();
+	void SendMapSize();
 
 public:
 	/** Status of a client */
@@ -75,16 +76,16 @@ public:
 	CommandQueue outgoing_queue; ///< The command-queue awaiting delivery
 	int receive_limit;           ///< Amount of bytes that we can receive at this moment
 
-	Packet *savegame_packets;      ///< Packet queue of the savegame; send these "slowly" to the client.
-	struct PacketWriter *savegame; ///< Writer used to write the savegame.
-	ThreadMutex *savegame_mutex;   ///< Mutex for making threaded saving safe.
-	NetworkAddress client_address; ///< IP-address of the client (so he can be banned)
+	struct NetworkSharedMap *savegame; ///< Snapshot of the map the client is downloading.
+	Packet *savegame_last;             ///< Last packet of the snapshot that is queued for the client.
+	uint savegame_send_count;          ///< Number of packets of the snapshot to queue at once.
+	bool savegame_size_sent;           ///< Whether the client has been told the size of the snapshot.
+	NetworkAddress client_address;     ///< IP-address of the client (so he can be banned)
 
 	ServerNetworkGameSocketHandler(SOCKET s);
 	~ServerNetworkGameSocketHandler();
 
 	virtual Packet *ReceivePacket();
-	virtual void SendPacket(Packet *packet);
 	NetworkRecvStatus CloseConnection(NetworkRecvStatus status);
 	void GetClientName(char *client_name, size_t size) const;
 
@@ -107,7 +108,7 @@ public:
 	NetworkRecvStatus SendConfigUpdate();
 
 	static void Send();
-	static void AcceptConnection(SOCKET s, const NetworkAddress &address);
+	static ServerNetworkGameSocketHandler *AcceptConnection(SOCKET s, const NetworkAddress &address);
 	static bool AllowConnection();
 
 	/**
@@ -126,6 +127,8 @@ public:
 
 void NetworkServer_Tick(bool send_frame);
 void NetworkServerSetCompanyPassword(CompanyID company_id, const char *password, bool already_hashed = true);
+void NetworkServerShareCommand(CommandPacket *cp);
+void NetworkServerCloseSharedMap();
 
 /**
  * Iterate over all the sockets from a given starting point.
@@ -23,6 +23,7 @@
 #include "textfile_gui.h"
 
 #include "fileio_func.h"
+#include "spritecache.h"
 #include "fios.h"
 
 /** Create a new GRFTextWrapper. */
@@ -731,6 +732,9 @@ void ScanNewGRFFiles(NewGRFScanCallback *callback)
 {
 	/* First set the modal progress. This ensures that it will eventually let go of the paint mutex. */
 	SetModalProgress(true);
+	/* The scan reads files without the Fio lock, so the sprite decoders must not read meanwhile.
+	 * No new sprites are given to them during modal progress; finish the ones they already have. */
+	FlushSpriteDecoders();
 	/* Only then can we really start, especially by marking the whole screen dirty. Get those other windows hidden!. */
 	MarkWholeScreenDirty();
 
@@ -300,6 +300,7 @@ static void ShutdownGame()
 	if (_game_mode != GM_BOOTSTRAP) ResetNewGRFData();
 
 	/* Close all and any open filehandles */
+	FlushSpriteDecoders();
 	FioCloseAll();
 
 	UninitFreeType();
@@ -1132,10 +1133,16 @@ static void CheckCaches()
 	 * always to aid testing of caches. */
 	if (_debug_desync_level <= 1) return;
 
-	/* Check company infrastructure cache. */
+	/* Check company infrastructure and value caches. */
 	SmallVector<CompanyInfrastructure, 4> old_infrastructure;
+	SmallVector<Money, 4> old_vehicle_value;
+	SmallVector<uint32, 4> old_station_facilities;
 	Company *c;
-	FOR_ALL_COMPANIES(c) MemCpyT(old_infrastructure.Append(), &c->infrastructure);
+	FOR_ALL_COMPANIES(c) {
+		MemCpyT(old_infrastructure.Append(), &c->infrastructure);
+		*old_vehicle_value.Append() = c->vehicle_value;
+		*old_station_facilities.Append() = c->station_facilities;
+	}
 
 	extern void AfterLoadCompanyStats();
 	AfterLoadCompanyStats();
@@ -1145,6 +1152,9 @@ static void CheckCaches()
 		if (MemCmpT(old_infrastructure.Get(i), &c->infrastructure) != 0) {
 			DEBUG(desync, 2, "infrastructure cache mismatch: company %i", (int)c->index);
 		}
+		if (*old_vehicle_value.Get(i) != c->vehicle_value || *old_station_facilities.Get(i) != c->station_facilities) {
+			DEBUG(desync, 2, "company value cache mismatch: company %i", (int)c->index);
+		}
 		i++;
 	}
 
@@ -1369,7 +1379,6 @@ void GameLoop()
 		_switch_mode = SM_NONE;
 	}
 
-	IncreaseSpriteLRU();
 	InteractiveRandom();
 
 	extern int _caret_timer;
@@ -220,12 +220,7 @@ public:
 		: first(NULL), num_orders(num_orders), num_manual_orders(0), num_vehicles(0), first_shared(NULL),
 		  timetable_duration(0) { }
 
-	/**
-	 * Create an order list with the given order chain for the given vehicle.
-	 *  @param chain pointer to the first order of the order chain
-	 *  @param v any vehicle using this orderlist
-	 */
-	OrderList(Order *chain, Vehicle *v) { this->Initialize(chain, v); }
+	OrderList(Order *chain, Vehicle *v);
 
 	/** Destructor. Invalidates OrderList for re-usage by the pool. */
 	~OrderList() {}
@@ -40,6 +40,70 @@ INSTANTIATE_POOL_METHODS(Order)
 OrderListPool _orderlist_pool("OrderList");
 INSTANTIATE_POOL_METHODS(OrderList)
 
+/** Whether BaseStation::order_lists is up to date for all stations. */
+static bool _station_order_lists_valid = false;
+
+/**
+ * Account for adding or removing an order of an order list in the order lists
+ * of the station the order goes to.
+ * @param o The order that is added or removed.
+ * @param list The order list the order is part of.
+ * @param add Whether the order is added to, or removed from, the list.
+ */
+static void UpdateStationOrderList(const Order *o, OrderList *list, bool add)
+{
+	if (!_station_order_lists_valid) return;
+	if (!o->IsType(OT_GOTO_STATION) && !o->IsType(OT_GOTO_WAYPOINT) && !o->IsType(OT_IMPLICIT)) return;
+
+	BaseStation *bs = BaseStation::GetIfValid(o->GetDestination());
+	if (bs == NULL) return;
+
+	StationOrderListRef *ref = bs->order_lists.Begin();
+	while (ref != bs->order_lists.End() && ref->list != list) ref++;
+
+	if (ref == bs->order_lists.End()) {
+		assert(add);
+		ref = bs->order_lists.Append();
+		ref->list = list;
+		ref->num_orders = 0;
+		ref->num_implicit = 0;
+	}
+
+	uint16 &count = o->IsType(OT_IMPLICIT) ? ref->num_implicit : ref->num_orders;
+	if (add) {
+		count++;
+	} else {
+		assert(count > 0);
+		count--;
+		if (ref->num_orders == 0 && ref->num_implicit == 0) bs->order_lists.Erase(ref);
+	}
+}
+
+/** Forget the order lists of the stations; they are rebuilt when needed next. */
+void InvalidateStationOrderLists()
+{
+	_station_order_lists_valid = false;
+}
+
+/**
+ * Make sure BaseStation::order_lists is up to date for all stations.
+ * Once built, the lists are kept up to date as orders are added and removed.
+ */
+void UpdateStationOrderLists()
+{
+	if (_station_order_lists_valid) return;
+
+	BaseStation *bs;
+	FOR_ALL_BASE_STATIONS(bs) bs->order_lists.Clear();
+
+	_station_order_lists_valid = true;
+
+	OrderList *list;
+	FOR_ALL_ORDER_LISTS(list) {
+		for (Order *o = list->GetFirstOrder(); o != NULL; o = o->next) UpdateStationOrderList(o, list, true);
+	}
+}
+
 /** Clean everything up. */
 Order::~Order()
 {
@@ -285,6 +349,18 @@ void Order::AssignOrder(const Order &other)
 	this->max_speed   = other.max_speed;
 }
 
+/**
+ * Create an order list with the given order chain for the given vehicle.
+ * @param chain pointer to the first order of the order chain
+ * @param v any vehicle using this orderlist
+ */
+OrderList::OrderList(Order *chain, Vehicle *v)
+{
+	this->Initialize(chain, v);
+
+	for (Order *o = this->first; o != NULL; o = o->next) UpdateStationOrderList(o, this, true);
+}
+
 /**
  * Recomputes everything.
  * @param chain first order in the chain
@@ -324,6 +400,7 @@ void OrderList::FreeChain(bool keep_orderlist)
 	Order *next;
 	for (Order *o = this->first; o != NULL; o = next) {
 		next = o->next;
+		UpdateStationOrderList(o, this, false);
 		delete o;
 	}
 
@@ -381,6 +458,7 @@ void OrderList::InsertOrderAt(Order *new_order, int index)
 	++this->num_orders;
 	if (!new_order->IsType(OT_IMPLICIT)) ++this->num_manual_orders;
 	this->timetable_duration += new_order->wait_time + new_order->travel_time;
+	UpdateStationOrderList(new_order, this, true);
 
 	/* We can visit oil rigs and buoys that are not our own. They will be shown in
 	 * the list of stations. So, we need to invalidate that window if needed. */
@@ -413,6 +491,7 @@ void OrderList::DeleteOrderAt(int index)
 	--this->num_orders;
 	if (!to_remove->IsType(OT_IMPLICIT)) --this->num_manual_orders;
 	this->timetable_duration -= (to_remove->wait_time + to_remove->travel_time);
+	UpdateStationOrderList(to_remove, this, false);
 	delete to_remove;
 }
 
@@ -1749,6 +1828,7 @@ restart:
 					break;
 				}
 
+				UpdateStationOrderList(order, v->orders.list, false);
 				order->MakeDummy();
 				for (const Vehicle *w = v->FirstShared(); w != NULL; w = w->NextShared()) {
 					/* In GUI, simulate by removing the order and adding it back */
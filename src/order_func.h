@@ -26,6 +26,9 @@ bool UpdateOrderDest(Vehicle *v, const Order *order, int conditional_depth = 0,
 VehicleOrderID ProcessConditionalOrder(const Order *order, const Vehicle *v);
 uint GetOrderDistance(const Order *prev, const Order *cur, const Vehicle *v, int conditional_depth = 0);
 
+void InvalidateStationOrderLists();
+void UpdateStationOrderLists();
+
 void DrawOrderString(const Vehicle *v, const Order *order, int order_index, int y, bool selected, bool timetable, int left, int middle, int right);
 
 #define MIN_SERVINT_PERCENT  5
@@ -7,9 +7,11 @@
  * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
  */
 
-/** @file os_timer.cpp OS/compiler dependant real time tick sampling. */
+/** @file os_timer.cpp OS/compiler dependant real time tick sampling and CPU feature detection. */
 
 #include "stdafx.h"
+#include "core/bitmath_func.hpp"
+#include "cpu.h"
 
 #undef RDTSC_AVAILABLE
 
@@ -74,3 +76,56 @@ uint64 ottd_rdtsc()
 # endif
 uint64 ottd_rdtsc() {return 0;}
 #endif
+
+/* cpuid for MSVC, using the intrinsic */
+#if defined(_MSC_VER) && !defined(WINCE)
+#include <intrin.h>
+static void ottd_cpuid(int info[4], int type)
+{
+	__cpuid(info, type);
+}
+#define CPUID_AVAILABLE
+#endif
+
+/* cpuid for x86 with GCC syntax */
+#if (defined(__i386__) || defined(__x86_64__)) && !defined(__DJGPP__) && !defined(CPUID_AVAILABLE)
+static void ottd_cpuid(int info[4], int type)
+{
+#if defined(__i386__) && defined(__PIC__)
+	/* The ebx register is the PIC register on i386, so it may not be clobbered. */
+	__asm__ __volatile__ (
+		"xchgl %%ebx, %1\n"
+		"cpuid\n"
+		"xchgl %%ebx, %1\n"
+		: "=a" (info[0]), "=r" (info[1]), "=c" (info[2]), "=d" (info[3])
+		: "0" (type), "2" (0)
+	);
+#else
+	__asm__ __volatile__ (
+		"cpuid\n"
+		: "=a" (info[0]), "=b" (info[1]), "=c" (info[2]), "=d" (info[3])
+		: "0" (type), "2" (0)
+	);
+#endif
+}
+#define CPUID_AVAILABLE
+#endif
+
+/* Without cpuid no CPU flags can be determined; assume none are set. */
+#if !defined(CPUID_AVAILABLE)
+static void ottd_cpuid(int info[4], int type)
+{
+	info[0] = info[1] = info[2] = info[3] = 0;
+}
+#endif
+
+bool HasCPUIDFlag(uint type, uint index, uint bit)
+{
+	int cpu_info[4] = {-1};
+	ottd_cpuid(cpu_info, 0);
+	uint max_info_type = cpu_info[0];
+	if (max_info_type < type) return false;
+
+	ottd_cpuid(cpu_info, type);
+	return HasBit(cpu_info[index], bit);
+}
@@ -34,6 +34,8 @@
 #include "../signs_func.h"
 #include "../aircraft.h"
 #include "../object_map.h"
+#include "../station_func.h"
+#include "../order_func.h"
 #include "../object_base.h"
 #include "../tree_map.h"
 #include "../company_func.h"
@@ -52,6 +54,7 @@
 #include "../smallmap_gui.h"
 #include "../news_func.h"
 #include "../error.h"
+#include "../thread/thread.h"
 #include "../pathfinder/yapf/region_common.h"
 #include "../pathfinder/yapf/region.h"
 
@@ -474,6 +477,425 @@ static uint FixVehicleInclination(Vehicle *v, Direction dir)
 	return 1U << GVF_GOINGUP_BIT;
 }
 
+/**
+ * Procedure converting a range of tiles of the map.
+ * @param begin The first tile to convert.
+ * @param end   The tile after the last tile to convert.
+ */
+typedef void TileRangeProc(TileIndex begin, TileIndex end);
+
+/** A range of tiles to run a #TileRangeProc over. */
+struct TileRangeJob {
+	TileRangeProc *proc; ///< The procedure to run.
+	TileIndex begin;     ///< The first tile of the range.
+	TileIndex end;       ///< The tile after the last tile of the range.
+};
+
+/**
+ * Thread entry for converting a range of tiles.
+ * @param arg The #TileRangeJob to run.
+ */
+static void TileRangeJobThread(void *arg)
+{
+	const TileRangeJob *job = (const TileRangeJob *)arg;
+	job->proc(job->begin, job->end);
+}
+
+/** Maximum number of threads to split a pass over the map over. */
+static const uint MAX_TILE_PASS_THREADS = 16;
+
+/**
+ * Run a conversion over the whole map, splitting the map in ranges that
+ * are converted by as many threads as there are cores.
+ * Only use this for conversions that solely change the map array of the
+ * tile being converted, don't look at other (possibly changing) tiles and
+ * don't touch any other state, e.g. pools or the random generator.
+ * @param proc The conversion to run.
+ */
+static void RunTilePass(TileRangeProc *proc)
+{
+	/* Small maps are not worth the trouble of creating threads. */
+	uint num_threads = MapSize() < (1 << 16) ? 1 : ClampU(GetCPUCoreCount(), 1, MAX_TILE_PASS_THREADS);
+
+	TileRangeJob jobs[MAX_TILE_PASS_THREADS];
+	ThreadObject *threads[MAX_TILE_PASS_THREADS];
+	for (uint i = 0; i < num_threads; i++) {
+		jobs[i].proc = proc;
+		jobs[i].begin = (TileIndex)((uint64)MapSize() * i / num_threads);
+		jobs[i].end = (TileIndex)((uint64)MapSize() * (i + 1) / num_threads);
+		threads[i] = NULL;
+	}
+
+	for (uint i = 1; i < num_threads; i++) {
+		if (!ThreadObject::New(&TileRangeJobThread, &jobs[i], &threads[i])) threads[i] = NULL;
+	}
+
+	/* This thread converts the first range and all ranges no thread could be created for. */
+	for (uint i = 0; i < num_threads; i++) {
+		if (threads[i] == NULL) TileRangeJobThread(&jobs[i]);
+	}
+
+	for (uint i = 1; i < num_threads; i++) {
+		if (threads[i] == NULL) continue;
+		threads[i]->Join();
+		delete threads[i];
+	}
+}
+
+/**
+ * Move the construction stage and lift bits of houses to their new place (savegame version 53).
+ * @param begin The first tile to convert.
+ * @param end   The tile after the last tile to convert.
+ */
+static void ConvertHouseTilesV53(TileIndex begin, TileIndex end)
+{
+	for (TileIndex t = begin; t < end; t++) {
+		if (IsTileType(t, MP_HOUSE)) {
+			if (GB(_m[t].m3, 6, 2) != TOWN_HOUSE_COMPLETED) {
+				/* Move the construction stage from m3[7..6] to m5[5..4].
+				 * The construction counter does not have to move. */
+				SB(_m[t].m5, 3, 2, GB(_m[t].m3, 6, 2));
+				SB(_m[t].m3, 6, 2, 0);
+
+				/* The "house is completed" bit is now in m6[2]. */
+				SetHouseCompleted(t, false);
+			} else {
+				/* The "lift has destination" bit has been moved from
+				 * m5[7] to m7[0]. */
+				SB(_me[t].m7, 0, 1, HasBit(_m[t].m5, 7));
+				ClrBit(_m[t].m5, 7);
+
+				/* The "lift is moving" bit has been removed, as it does
+				 * the same job as the "lift has destination" bit. */
+				ClrBit(_m[t].m1, 7);
+
+				/* The position of the lift goes from m1[7..0] to m6[7..2],
+				 * making m1 totally free, now. The lift position does not
+				 * have to be a full byte since the maximum value is 36. */
+				SetLiftPosition(t, GB(_m[t].m1, 0, 6 ));
+
+				_m[t].m1 = 0;
+				_m[t].m3 = 0;
+				SetHouseCompleted(t, true);
+			}
+		}
+	}
+}
+
+/**
+ * Move the animation state of industry tiles to m3 (savegame version 43).
+ * @param begin The first tile to convert.
+ * @param end   The tile after the last tile to convert.
+ */
+static void ConvertIndustryTilesV43(TileIndex begin, TileIndex end)
+{
+	for (TileIndex t = begin; t < end; t++) {
+		if (IsTileType(t, MP_INDUSTRY)) {
+			switch (GetIndustryGfx(t)) {
+				case GFX_POWERPLANT_SPARKS:
+					_m[t].m3 = GB(_m[t].m1, 2, 5);
+					break;
+
+				case GFX_OILWELL_ANIMATED_1:
+				case GFX_OILWELL_ANIMATED_2:
+				case GFX_OILWELL_ANIMATED_3:
+					_m[t].m3 = GB(_m[t].m1, 0, 2);
+					break;
+
+				case GFX_COAL_MINE_TOWER_ANIMATED:
+				case GFX_COPPER_MINE_TOWER_ANIMATED:
+				case GFX_GOLD_MINE_TOWER_ANIMATED:
+					 _m[t].m3 = _m[t].m1;
+					 break;
+
+				default: // No animation states to change
+					break;
+			}
+		}
+	}
+}
+
+/**
+ * Copy the signal type/variant and move the signal states bits (savegame version 64).
+ * @param begin The first tile to convert.
+ * @param end   The tile after the last tile to convert.
+ */
+static void ConvertSignalTilesV64(TileIndex begin, TileIndex end)
+{
+	for (TileIndex t = begin; t < end; t++) {
+		if (IsTileType(t, MP_RAILWAY) && HasSignals(t)) {
+			SetSignalStates(t, GB(_m[t].m2, 4, 4));
+			SetSignalVariant(t, INVALID_TRACK, GetSignalVariant(t, TRACK_X));
+			SetSignalType(t, INVALID_TRACK, GetSignalType(t, TRACK_X));
+			ClrBit(_m[t].m2, 7);
+		}
+	}
+}
+
+/**
+ * Give grassy and rough land trees full density (savegame version 81).
+ * @param begin The first tile to convert.
+ * @param end   The tile after the last tile to convert.
+ */
+static void ConvertTreeTilesV81(TileIndex begin, TileIndex end)
+{
+	for (TileIndex t = begin; t < end; t++) {
+		if (GetTileType(t) == MP_TREES) {
+			TreeGround groundType = (TreeGround)GB(_m[t].m2, 4, 2);
+			if (groundType != TREE_GROUND_SNOW_DESERT) SB(_m[t].m2, 6, 2, 3);
+		}
+	}
+}
+
+/**
+ * Increase the house animation frame from 5 to 7 bits (savegame version 91).
+ * @param begin The first tile to convert.
+ * @param end   The tile after the last tile to convert.
+ */
+static void ConvertHouseTilesV91(TileIndex begin, TileIndex end)
+{
+	for (TileIndex t = begin; t < end; t++) {
+		if (IsTileType(t, MP_HOUSE) && GetHouseType(t) >= NEW_HOUSE_OFFSET) {
+			SB(_m[t].m6, 2, 6, GB(_m[t].m6, 3, 5));
+			SB(_m[t].m3, 5, 1, 0);
+		}
+	}
+}
+
+/**
+ * Move the signal variant bits and clear all PBS reservations (savegame version 100).
+ * @param begin The first tile to convert.
+ * @param end   The tile after the last tile to convert.
+ */
+static void ConvertSignalTilesV100(TileIndex begin, TileIndex end)
+{
+	for (TileIndex t = begin; t < end; t++) {
+		switch (GetTileType(t)) {
+			case MP_RAILWAY:
+				if (HasSignals(t)) {
+					/* move the signal variant */
+					SetSignalVariant(t, TRACK_UPPER, HasBit(_m[t].m2, 2) ? SIG_SEMAPHORE : SIG_ELECTRIC);
+					SetSignalVariant(t, TRACK_LOWER, HasBit(_m[t].m2, 6) ? SIG_SEMAPHORE : SIG_ELECTRIC);
+					ClrBit(_m[t].m2, 2);
+					ClrBit(_m[t].m2, 6);
+				}
+
+				/* Clear PBS reservation on track */
+				if (IsRailDepot(t)) {
+					SetDepotReservation(t, false);
+				} else {
+					SetTrackReservation(t, TRACK_BIT_NONE);
+				}
+				break;
+
+			case MP_ROAD: // Clear PBS reservation on crossing
+				if (IsLevelCrossing(t)) SetCrossingReservation(t, false);
+				break;
+
+			case MP_STATION: // Clear PBS reservation on station
+				if (HasStationRail(t)) SetRailStationReservation(t, false);
+				break;
+
+			case MP_TUNNELBRIDGE: // Clear PBS reservation on tunnels/birdges
+				if (GetTunnelBridgeTransportType(t) == TRANSPORT_RAIL) SetTunnelBridgeReservation(t, false);
+				break;
+
+			default: break;
+		}
+	}
+}
+
+/**
+ * Swap the bits for ground and density of clear and tree tiles (savegame version 135).
+ * @param begin The first tile to convert.
+ * @param end   The tile after the last tile to convert.
+ */
+static void ConvertClearAndTreeTilesV135(TileIndex begin, TileIndex end)
+{
+	for (TileIndex t = begin; t < end; t++) {
+		if (IsTileType(t, MP_CLEAR)) {
+			if (GetRawClearGround(t) == CLEAR_SNOW) {
+				SetClearGroundDensity(t, CLEAR_GRASS, GetClearDensity(t));
+				SetBit(_m[t].m3, 4);
+			} else {
+				ClrBit(_m[t].m3, 4);
+			}
+		}
+		if (IsTileType(t, MP_TREES)) {
+			uint density = GB(_m[t].m2, 6, 2);
+			uint ground = GB(_m[t].m2, 4, 2);
+			uint counter = GB(_m[t].m2, 0, 4);
+			_m[t].m2 = ground << 6 | density << 4 | counter;
+		}
+	}
+}
+
+/**
+ * Move the water class to its unified place (savegame version 146).
+ * @param begin The first tile to convert.
+ * @param end   The tile after the last tile to convert.
+ */
+static void ConvertWaterClassesV146(TileIndex begin, TileIndex end)
+{
+	for (TileIndex t = begin; t < end; t++) {
+		switch (GetTileType(t)) {
+			case MP_STATION:
+				switch (GetStationType(t)) {
+					case STATION_OILRIG:
+					case STATION_DOCK:
+					case STATION_BUOY:
+						SetWaterClass(t, (WaterClass)GB(_m[t].m3, 0, 2));
+						SB(_m[t].m3, 0, 2, 0);
+						break;
+
+					default:
+						SetWaterClass(t, WATER_CLASS_INVALID);
+						break;
+				}
+				break;
+
+			case MP_WATER:
+				SetWaterClass(t, (WaterClass)GB(_m[t].m3, 0, 2));
+				SB(_m[t].m3, 0, 2, 0);
+				break;
+
+			case MP_OBJECT:
+				SetWaterClass(t, WATER_CLASS_INVALID);
+				break;
+
+			default:
+				/* No water class. */
+				break;
+		}
+	}
+}
+
+/**
+ * Move the animation frame of houses, industries and objects to m7 (savegame version 147).
+ * @param begin The first tile to convert.
+ * @param end   The tile after the last tile to convert.
+ */
+static void ConvertAnimationFramesV147(TileIndex begin, TileIndex end)
+{
+	for (TileIndex t = begin; t < end; t++) {
+		switch (GetTileType(t)) {
+			case MP_HOUSE:
+				if (GetHouseType(t) >= NEW_HOUSE_OFFSET) {
+					uint per_proc = _me[t].m7;
+					_me[t].m7 = GB(_m[t].m6, 2, 6) | (GB(_m[t].m3, 5, 1) << 6);
+					SB(_m[t].m3, 5, 1, 0);
+					SB(_m[t].m6, 2, 6, min(per_proc, 63));
+				}
+				break;
+
+			case MP_INDUSTRY: {
+				uint rand = _me[t].m7;
+				_me[t].m7 = _m[t].m3;
+				_m[t].m3 = rand;
+				break;
+			}
+
+			case MP_OBJECT:
+				_me[t].m7 = _m[t].m3;
+				_m[t].m3 = 0;
+				break;
+
+			default:
+				/* For stations/airports it's already at m7 */
+				break;
+		}
+	}
+}
+
+/**
+ * Set the road owner of standard road stops to the owner of the stop (savegame version 172).
+ * @param begin The first tile to convert.
+ * @param end   The tile after the last tile to convert.
+ */
+static void ConvertRoadStopOwnersV172(TileIndex begin, TileIndex end)
+{
+	for (TileIndex t = begin; t < end; t++) {
+		if (!IsStandardRoadStopTile(t)) continue;
+		Owner o = GetTileOwner(t);
+		SetRoadOwner(t, ROADTYPE_ROAD, o);
+		SetRoadOwner(t, ROADTYPE_TRAM, o);
+	}
+}
+
+/**
+ * Fix the owners of water tiles (savegame versions 82 and 83).
+ * @param begin The first tile to convert.
+ * @param end   The tile after the last tile to convert.
+ */
+static void ConvertWaterOwnersV83(TileIndex begin, TileIndex end)
+{
+	bool old_canals = IsSavegameVersionBefore(82);
+	for (TileIndex t = begin; t < end; t++) {
+		/* From version 82, old style canals (above sealevel (0), WATER owner) are no longer supported.
+		 * Replace the owner for those by OWNER_NONE. */
+		if (old_canals && IsTileType(t, MP_WATER) &&
+				GetWaterTileType(t) == WATER_TILE_CLEAR &&
+				GetTileOwner(t) == OWNER_WATER &&
+				TileHeight(t) != 0) {
+			SetTileOwner(t, OWNER_NONE);
+		}
+
+		/*
+		 * Add the 'previous' owner to the ship depots so we can reset it with
+		 * the correct values when it gets destroyed. This prevents that
+		 * someone can remove canals owned by somebody else and it prevents
+		 * making floods using the removal of ship depots.
+		 */
+		if (IsShipDepotTile(t)) {
+			_m[t].m4 = (TileHeight(t) == 0) ? OWNER_WATER : OWNER_NONE;
+		}
+	}
+}
+
+/**
+ * Move the HQ bits and reorder the bits of object tiles (savegame versions 112 and 144).
+ * @param begin The first tile to convert.
+ * @param end   The tile after the last tile to convert.
+ */
+static void ConvertObjectTilesV144(TileIndex begin, TileIndex end)
+{
+	bool old_hq = IsSavegameVersionBefore(112);
+	for (TileIndex t = begin; t < end; t++) {
+		if (!IsTileType(t, MP_OBJECT)) continue;
+
+		/* Check for HQ bit being set, instead of using map accessor,
+		 * since we've already changed it code-wise */
+		if (old_hq && HasBit(_m[t].m5, 7)) {
+			/* Move size and part identification of HQ out of the m5 attribute,
+			 * on new locations */
+			_m[t].m3 = GB(_m[t].m5, 0, 5);
+			_m[t].m5 = OBJECT_HQ;
+		}
+
+		/* Reordering/generalisation of the object bits. */
+		ObjectType type = GetObjectType(t);
+		SB(_m[t].m6, 2, 4, type == OBJECT_HQ ? GB(_m[t].m3, 2, 3) : 0);
+		_m[t].m3 = type == OBJECT_HQ ? GB(_m[t].m3, 1, 1) | GB(_m[t].m3, 0, 1) << 4 : 0;
+
+		/* Make sure those bits are clear as well! */
+		_m[t].m4 = 0;
+		_me[t].m7 = 0;
+	}
+}
+
+static uint64 _afterload_stage_start; ///< The moment the current stage of AfterLoadGame started.
+
+/**
+ * Mark the end of a stage of AfterLoadGame and show how long it took.
+ * @param name Description of what was done in the stage.
+ */
+static void AfterLoadStageDone(const char *name)
+{
+	uint64 now = ottd_rdtsc();
+	DEBUG(sl, 2, "AfterLoadGame: %s took " OTTD_PRINTF64 " cycles", name, now - _afterload_stage_start);
+	_afterload_stage_start = now;
+}
+
 /**
  * Perform a (large) amount of savegame conversion *magic* in order to
  * load older savegames and to fill the caches for various purposes.
@@ -482,6 +904,7 @@ static uint FixVehicleInclination(Vehicle *v, Direction dir)
 bool AfterLoadGame()
 {
 	SetSignalHandlers();
+	_afterload_stage_start = ottd_rdtsc();
 
 	TileIndex map_size = MapSize();
 
@@ -656,6 +1079,7 @@ bool AfterLoadGame()
 	/* Load the sprites */
 	GfxLoadSprites();
 	LoadStringWidthTable();
+	AfterLoadStageDone("names, NewGRFs and sprites");
 
 	/* Copy temporary data to Engine pool */
 	CopyTempEngineData();
@@ -689,6 +1113,7 @@ bool AfterLoadGame()
 
 	/* Update all vehicles */
 	AfterLoadVehicles(true);
+	AfterLoadStageDone("vehicles");
 
 	/* Make sure there is an AI attached to an AI company */
 	{
@@ -849,6 +1274,7 @@ bool AfterLoadGame()
 	/* In version 2.2 of the savegame, we have new airports, so status of all aircraft is reset.
 	 * This has to be called after the oilrig airport_type update above ^^^ ! */
 	if (IsSavegameVersionBefore(2, 2)) UpdateOldAircraft();
+	AfterLoadStageDone("station spread");
 
 	/* In version 6.1 we put the town index in the map-array. To do this, we need
 	 *  to use m2 (16bit big), so we need to clean m2, and that is where this is
@@ -1318,69 +1744,13 @@ bool AfterLoadGame()
 
 	/* From version 53, the map array was changed for house tiles to allow
 	 * space for newhouses grf features. A new byte, m7, was also added. */
-	if (IsSavegameVersionBefore(53)) {
-		for (TileIndex t = 0; t < map_size; t++) {
-			if (IsTileType(t, MP_HOUSE)) {
-				if (GB(_m[t].m3, 6, 2) != TOWN_HOUSE_COMPLETED) {
-					/* Move the construction stage from m3[7..6] to m5[5..4].
-					 * The construction counter does not have to move. */
-					SB(_m[t].m5, 3, 2, GB(_m[t].m3, 6, 2));
-					SB(_m[t].m3, 6, 2, 0);
-
-					/* The "house is completed" bit is now in m6[2]. */
-					SetHouseCompleted(t, false);
-				} else {
-					/* The "lift has destination" bit has been moved from
-					 * m5[7] to m7[0]. */
-					SB(_me[t].m7, 0, 1, HasBit(_m[t].m5, 7));
-					ClrBit(_m[t].m5, 7);
-
-					/* The "lift is moving" bit has been removed, as it does
-					 * the same job as the "lift has destination" bit. */
-					ClrBit(_m[t].m1, 7);
-
-					/* The position of the lift goes from m1[7..0] to m6[7..2],
-					 * making m1 totally free, now. The lift position does not
-					 * have to be a full byte since the maximum value is 36. */
-					SetLiftPosition(t, GB(_m[t].m1, 0, 6 ));
-
-					_m[t].m1 = 0;
-					_m[t].m3 = 0;
-					SetHouseCompleted(t, true);
-				}
-			}
-		}
-	}
+	if (IsSavegameVersionBefore(53)) RunTilePass(&ConvertHouseTilesV53);
 
 	/* Check and update house and town values */
 	UpdateHousesAndTowns();
+	AfterLoadStageDone("houses and towns");
 
-	if (IsSavegameVersionBefore(43)) {
-		for (TileIndex t = 0; t < map_size; t++) {
-			if (IsTileType(t, MP_INDUSTRY)) {
-				switch (GetIndustryGfx(t)) {
-					case GFX_POWERPLANT_SPARKS:
-						_m[t].m3 = GB(_m[t].m1, 2, 5);
-						break;
-
-					case GFX_OILWELL_ANIMATED_1:
-					case GFX_OILWELL_ANIMATED_2:
-					case GFX_OILWELL_ANIMATED_3:
-						_m[t].m3 = GB(_m[t].m1, 0, 2);
-						break;
-
-					case GFX_COAL_MINE_TOWER_ANIMATED:
-					case GFX_COPPER_MINE_TOWER_ANIMATED:
-					case GFX_GOLD_MINE_TOWER_ANIMATED:
-						 _m[t].m3 = _m[t].m1;
-						 break;
-
-					default: // No animation states to change
-						break;
-				}
-			}
-		}
-	}
+	if (IsSavegameVersionBefore(43)) RunTilePass(&ConvertIndustryTilesV43);
 
 	if (IsSavegameVersionBefore(45)) {
 		Vehicle *v;
@@ -1478,17 +1848,7 @@ bool AfterLoadGame()
 		_settings_game.difficulty.number_towns++;
 	}
 
-	if (IsSavegameVersionBefore(64)) {
-		/* copy the signal type/variant and move signal states bits */
-		for (TileIndex t = 0; t < map_size; t++) {
-			if (IsTileType(t, MP_RAILWAY) && HasSignals(t)) {
-				SetSignalStates(t, GB(_m[t].m2, 4, 4));
-				SetSignalVariant(t, INVALID_TRACK, GetSignalVariant(t, TRACK_X));
-				SetSignalType(t, INVALID_TRACK, GetSignalType(t, TRACK_X));
-				ClrBit(_m[t].m2, 7);
-			}
-		}
-	}
+	if (IsSavegameVersionBefore(64)) RunTilePass(&ConvertSignalTilesV64);
 
 	if (IsSavegameVersionBefore(69)) {
 		/* In some old savegames a bit was cleared when it should not be cleared */
@@ -1506,32 +1866,7 @@ bool AfterLoadGame()
 		FOR_ALL_INDUSTRIES(i) i->founder = OWNER_NONE;
 	}
 
-	/* From version 82, old style canals (above sealevel (0), WATER owner) are no longer supported.
-	    Replace the owner for those by OWNER_NONE. */
-	if (IsSavegameVersionBefore(82)) {
-		for (TileIndex t = 0; t < map_size; t++) {
-			if (IsTileType(t, MP_WATER) &&
-					GetWaterTileType(t) == WATER_TILE_CLEAR &&
-					GetTileOwner(t) == OWNER_WATER &&
-					TileHeight(t) != 0) {
-				SetTileOwner(t, OWNER_NONE);
-			}
-		}
-	}
-
-	/*
-	 * Add the 'previous' owner to the ship depots so we can reset it with
-	 * the correct values when it gets destroyed. This prevents that
-	 * someone can remove canals owned by somebody else and it prevents
-	 * making floods using the removal of ship depots.
-	 */
-	if (IsSavegameVersionBefore(83)) {
-		for (TileIndex t = 0; t < map_size; t++) {
-			if (IsShipDepotTile(t)) {
-				_m[t].m4 = (TileHeight(t) == 0) ? OWNER_WATER : OWNER_NONE;
-			}
-		}
-	}
+	if (IsSavegameVersionBefore(83)) RunTilePass(&ConvertWaterOwnersV83);
 
 	if (IsSavegameVersionBefore(74)) {
 		Station *st;
@@ -1561,14 +1896,7 @@ bool AfterLoadGame()
 	 * grassy trees were always drawn fully grassy. Furthermore, trees on rough
 	 * land used to have zero density, now they have full density. Therefore,
 	 * make all grassy/rough land trees have a density of 3. */
-	if (IsSavegameVersionBefore(81)) {
-		for (TileIndex t = 0; t < map_size; t++) {
-			if (GetTileType(t) == MP_TREES) {
-				TreeGround groundType = (TreeGround)GB(_m[t].m2, 4, 2);
-				if (groundType != TREE_GROUND_SNOW_DESERT) SB(_m[t].m2, 6, 2, 3);
-			}
-		}
-	}
+	if (IsSavegameVersionBefore(81)) RunTilePass(&ConvertTreeTilesV81);
 
 
 	if (IsSavegameVersionBefore(93)) {
@@ -1624,39 +1952,7 @@ bool AfterLoadGame()
 	}
 
 	/* The water class was moved/unified. */
-	if (IsSavegameVersionBefore(146)) {
-		for (TileIndex t = 0; t < map_size; t++) {
-			switch (GetTileType(t)) {
-				case MP_STATION:
-					switch (GetStationType(t)) {
-						case STATION_OILRIG:
-						case STATION_DOCK:
-						case STATION_BUOY:
-							SetWaterClass(t, (WaterClass)GB(_m[t].m3, 0, 2));
-							SB(_m[t].m3, 0, 2, 0);
-							break;
-
-						default:
-							SetWaterClass(t, WATER_CLASS_INVALID);
-							break;
-					}
-					break;
-
-				case MP_WATER:
-					SetWaterClass(t, (WaterClass)GB(_m[t].m3, 0, 2));
-					SB(_m[t].m3, 0, 2, 0);
-					break;
-
-				case MP_OBJECT:
-					SetWaterClass(t, WATER_CLASS_INVALID);
-					break;
-
-				default:
-					/* No water class. */
-					break;
-			}
-		}
-	}
+	if (IsSavegameVersionBefore(146)) RunTilePass(&ConvertWaterClassesV146);
 
 	if (IsSavegameVersionBefore(86)) {
 		for (TileIndex t = 0; t < map_size; t++) {
@@ -1756,15 +2052,7 @@ bool AfterLoadGame()
 		}
 	}
 
-	if (IsSavegameVersionBefore(91)) {
-		/* Increase HouseAnimationFrame from 5 to 7 bits */
-		for (TileIndex t = 0; t < map_size; t++) {
-			if (IsTileType(t, MP_HOUSE) && GetHouseType(t) >= NEW_HOUSE_OFFSET) {
-				SB(_m[t].m6, 2, 6, GB(_m[t].m6, 3, 5));
-				SB(_m[t].m3, 5, 1, 0);
-			}
-		}
-	}
+	if (IsSavegameVersionBefore(91)) RunTilePass(&ConvertHouseTilesV91);
 
 	if (IsSavegameVersionBefore(62)) {
 		/* Remove all trams from savegames without tram support.
@@ -1802,42 +2090,7 @@ bool AfterLoadGame()
 	/* Move the signal variant back up one bit for PBS. We don't convert the old PBS
 	 * format here, as an old layout wouldn't work properly anyway. To be safe, we
 	 * clear any possible PBS reservations as well. */
-	if (IsSavegameVersionBefore(100)) {
-		for (TileIndex t = 0; t < map_size; t++) {
-			switch (GetTileType(t)) {
-				case MP_RAILWAY:
-					if (HasSignals(t)) {
-						/* move the signal variant */
-						SetSignalVariant(t, TRACK_UPPER, HasBit(_m[t].m2, 2) ? SIG_SEMAPHORE : SIG_ELECTRIC);
-						SetSignalVariant(t, TRACK_LOWER, HasBit(_m[t].m2, 6) ? SIG_SEMAPHORE : SIG_ELECTRIC);
-						ClrBit(_m[t].m2, 2);
-						ClrBit(_m[t].m2, 6);
-					}
-
-					/* Clear PBS reservation on track */
-					if (IsRailDepot(t)) {
-						SetDepotReservation(t, false);
-					} else {
-						SetTrackReservation(t, TRACK_BIT_NONE);
-					}
-					break;
-
-				case MP_ROAD: // Clear PBS reservation on crossing
-					if (IsLevelCrossing(t)) SetCrossingReservation(t, false);
-					break;
-
-				case MP_STATION: // Clear PBS reservation on station
-					if (HasStationRail(t)) SetRailStationReservation(t, false);
-					break;
-
-				case MP_TUNNELBRIDGE: // Clear PBS reservation on tunnels/birdges
-					if (GetTunnelBridgeTransportType(t) == TRANSPORT_RAIL) SetTunnelBridgeReservation(t, false);
-					break;
-
-				default: break;
-			}
-		}
-	}
+	if (IsSavegameVersionBefore(100)) RunTilePass(&ConvertSignalTilesV100);
 
 	/* Reserve all tracks trains are currently on. */
 	if (IsSavegameVersionBefore(101)) {
@@ -1899,32 +2152,7 @@ bool AfterLoadGame()
 		}
 	}
 
-	if (IsSavegameVersionBefore(112)) {
-		for (TileIndex t = 0; t < map_size; t++) {
-			/* Check for HQ bit being set, instead of using map accessor,
-			 * since we've already changed it code-wise */
-			if (IsTileType(t, MP_OBJECT) && HasBit(_m[t].m5, 7)) {
-				/* Move size and part identification of HQ out of the m5 attribute,
-				 * on new locations */
-				_m[t].m3 = GB(_m[t].m5, 0, 5);
-				_m[t].m5 = OBJECT_HQ;
-			}
-		}
-	}
-	if (IsSavegameVersionBefore(144)) {
-		for (TileIndex t = 0; t < map_size; t++) {
-			if (!IsTileType(t, MP_OBJECT)) continue;
-
-			/* Reordering/generalisation of the object bits. */
-			ObjectType type = GetObjectType(t);
-			SB(_m[t].m6, 2, 4, type == OBJECT_HQ ? GB(_m[t].m3, 2, 3) : 0);
-			_m[t].m3 = type == OBJECT_HQ ? GB(_m[t].m3, 1, 1) | GB(_m[t].m3, 0, 1) << 4 : 0;
-
-			/* Make sure those bits are clear as well! */
-			_m[t].m4 = 0;
-			_me[t].m7 = 0;
-		}
-	}
+	if (IsSavegameVersionBefore(144)) RunTilePass(&ConvertObjectTilesV144);
 
 	if (IsSavegameVersionBefore(147) && Object::GetNumItems() == 0) {
 		/* Make real objects for object tiles. */
@@ -2202,24 +2430,7 @@ bool AfterLoadGame()
 
 	/* The bits for the tree ground and tree density have
 	 * been swapped (m2 bits 7..6 and 5..4. */
-	if (IsSavegameVersionBefore(135)) {
-		for (TileIndex t = 0; t < map_size; t++) {
-			if (IsTileType(t, MP_CLEAR)) {
-				if (GetRawClearGround(t) == CLEAR_SNOW) {
-					SetClearGroundDensity(t, CLEAR_GRASS, GetClearDensity(t));
-					SetBit(_m[t].m3, 4);
-				} else {
-					ClrBit(_m[t].m3, 4);
-				}
-			}
-			if (IsTileType(t, MP_TREES)) {
-				uint density = GB(_m[t].m2, 6, 2);
-				uint ground = GB(_m[t].m2, 4, 2);
-				uint counter = GB(_m[t].m2, 0, 4);
-				_m[t].m2 = ground << 6 | density << 4 | counter;
-			}
-		}
-	}
+	if (IsSavegameVersionBefore(135)) RunTilePass(&ConvertClearAndTreeTilesV135);
 
 	/* Wait counter and load/unload ticks got split. */
 	if (IsSavegameVersionBefore(136)) {
@@ -2322,36 +2533,7 @@ bool AfterLoadGame()
 	}
 
 	/* Move the animation frame to the same location (m7) for all objects. */
-	if (IsSavegameVersionBefore(147)) {
-		for (TileIndex t = 0; t < map_size; t++) {
-			switch (GetTileType(t)) {
-				case MP_HOUSE:
-					if (GetHouseType(t) >= NEW_HOUSE_OFFSET) {
-						uint per_proc = _me[t].m7;
-						_me[t].m7 = GB(_m[t].m6, 2, 6) | (GB(_m[t].m3, 5, 1) << 6);
-						SB(_m[t].m3, 5, 1, 0);
-						SB(_m[t].m6, 2, 6, min(per_proc, 63));
-					}
-					break;
-
-				case MP_INDUSTRY: {
-					uint rand = _me[t].m7;
-					_me[t].m7 = _m[t].m3;
-					_m[t].m3 = rand;
-					break;
-				}
-
-				case MP_OBJECT:
-					_me[t].m7 = _m[t].m3;
-					_m[t].m3 = 0;
-					break;
-
-				default:
-					/* For stations/airports it's already at m7 */
-					break;
-			}
-		}
-	}
+	if (IsSavegameVersionBefore(147)) RunTilePass(&ConvertAnimationFramesV147);
 
 	/* Add (random) colour to all objects. */
 	if (IsSavegameVersionBefore(148)) {
@@ -2728,15 +2910,10 @@ bool AfterLoadGame()
 	}
 
 	/* The road owner of standard road stops was not properly accounted for. */
-	if (IsSavegameVersionBefore(172)) {
-		for (TileIndex t = 0; t < map_size; t++) {
-			if (!IsStandardRoadStopTile(t)) continue;
-			Owner o = GetTileOwner(t);
-			SetRoadOwner(t, ROADTYPE_ROAD, o);
-			SetRoadOwner(t, ROADTYPE_TRAM, o);
-		}
-	}
-	
+	if (IsSavegameVersionBefore(172)) RunTilePass(&ConvertRoadStopOwnersV172);
+
+	AfterLoadStageDone("savegame conversions");
+
 	/*Rebuild the regions from tile data*/
 	DeactivateWaterRegions();
 	if (_settings_game.pf.pathfinder_for_ships == VPF_YAPF){
@@ -2749,15 +2926,21 @@ bool AfterLoadGame()
 		}
 		ActivateWaterRegions();
 	}
+	AfterLoadStageDone("water regions");
 
 	/* Road stops is 'only' updating some caches */
 	AfterLoadRoadStops();
 	AfterLoadLabelMaps();
 	AfterLoadCompanyStats();
+	/* Tiles may have been converted without noting it in the map generations. */
+	InvalidateStationAcceptanceCaches();
+	/* Orders may have been converted while the station order lists were not maintained. */
+	InvalidateStationOrderLists();
 
 	GamelogPrintDebug(1);
 
 	InitializeWindowsAndCaches();
+	AfterLoadStageDone("caches and windows");
 	/* Restore the signals */
 	ResetSignalHandlers();
 	return true;
@@ -2788,6 +2971,8 @@ void ReloadNewGRFData()
 	AfterLoadCompanyStats();
 	/* Check and update house and town values */
 	UpdateHousesAndTowns();
+	/* The acceptance of houses and industry tiles may have changed */
+	InvalidateStationAcceptanceCaches();
 	/* Delete news referring to no longer existing entities */
 	DeleteInvalidEngineNews();
 	/* Update livery selection windows */
@@ -16,6 +16,7 @@
 #include "../tunnelbridge_map.h"
 #include "../tunnelbridge.h"
 #include "../station_base.h"
+#include "../economy_func.h"
 
 #include "saveload.h"
 
@@ -231,6 +232,8 @@ void AfterLoadCompanyStats()
 				break;
 		}
 	}
+
+	RebuildCompanyValueCounts();
 }
 
 
@@ -49,143 +49,83 @@ static const uint MAP_SL_BUF_SIZE = 4096;
 
 static void Load_MAPT()
 {
-	SmallStackSafeStackAlloc<byte, MAP_SL_BUF_SIZE> buf;
-	TileIndex size = MapSize();
-
-	for (TileIndex i = 0; i != size;) {
-		SlArray(buf, MAP_SL_BUF_SIZE, SLE_UINT8);
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _m[i++].type_height = buf[j];
-	}
+	SlStridedArray(&_m[0].type_height, sizeof(*_m), MapSize(), SLE_UINT8);
 }
 
 static void Save_MAPT()
 {
-	SmallStackSafeStackAlloc<byte, MAP_SL_BUF_SIZE> buf;
 	TileIndex size = MapSize();
 
 	SlSetLength(size);
-	for (TileIndex i = 0; i != size;) {
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = _m[i++].type_height;
-		SlArray(buf, MAP_SL_BUF_SIZE, SLE_UINT8);
-	}
+	SlStridedArray(&_m[0].type_height, sizeof(*_m), size, SLE_UINT8);
 }
 
 static void Load_MAP1()
 {
-	SmallStackSafeStackAlloc<byte, MAP_SL_BUF_SIZE> buf;
-	TileIndex size = MapSize();
-
-	for (TileIndex i = 0; i != size;) {
-		SlArray(buf, MAP_SL_BUF_SIZE, SLE_UINT8);
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _m[i++].m1 = buf[j];
-	}
+	SlStridedArray(&_m[0].m1, sizeof(*_m), MapSize(), SLE_UINT8);
 }
 
 static void Save_MAP1()
 {
-	SmallStackSafeStackAlloc<byte, MAP_SL_BUF_SIZE> buf;
 	TileIndex size = MapSize();
 
 	SlSetLength(size);
-	for (TileIndex i = 0; i != size;) {
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = _m[i++].m1;
-		SlArray(buf, MAP_SL_BUF_SIZE, SLE_UINT8);
-	}
+	SlStridedArray(&_m[0].m1, sizeof(*_m), size, SLE_UINT8);
 }
 
 static void Load_MAP2()
 {
-	SmallStackSafeStackAlloc<uint16, MAP_SL_BUF_SIZE> buf;
-	TileIndex size = MapSize();
-
-	for (TileIndex i = 0; i != size;) {
-		SlArray(buf, MAP_SL_BUF_SIZE,
-			/* In those versions the m2 was 8 bits */
-			IsSavegameVersionBefore(5) ? SLE_FILE_U8 | SLE_VAR_U16 : SLE_UINT16
-		);
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _m[i++].m2 = buf[j];
-	}
+	SlStridedArray(&_m[0].m2, sizeof(*_m), MapSize(),
+		/* In those versions the m2 was 8 bits */
+		IsSavegameVersionBefore(5) ? SLE_FILE_U8 | SLE_VAR_U16 : SLE_UINT16
+	);
 }
 
 static void Save_MAP2()
 {
-	SmallStackSafeStackAlloc<uint16, MAP_SL_BUF_SIZE> buf;
 	TileIndex size = MapSize();
 
 	SlSetLength(size * sizeof(uint16));
-	for (TileIndex i = 0; i != size;) {
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = _m[i++].m2;
-		SlArray(buf, MAP_SL_BUF_SIZE, SLE_UINT16);
-	}
+	SlStridedArray(&_m[0].m2, sizeof(*_m), size, SLE_UINT16);
 }
 
 static void Load_MAP3()
 {
-	SmallStackSafeStackAlloc<byte, MAP_SL_BUF_SIZE> buf;
-	TileIndex size = MapSize();
-
-	for (TileIndex i = 0; i != size;) {
-		SlArray(buf, MAP_SL_BUF_SIZE, SLE_UINT8);
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _m[i++].m3 = buf[j];
-	}
+	SlStridedArray(&_m[0].m3, sizeof(*_m), MapSize(), SLE_UINT8);
 }
 
 static void Save_MAP3()
 {
-	SmallStackSafeStackAlloc<byte, MAP_SL_BUF_SIZE> buf;
 	TileIndex size = MapSize();
 
 	SlSetLength(size);
-	for (TileIndex i = 0; i != size;) {
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = _m[i++].m3;
-		SlArray(buf, MAP_SL_BUF_SIZE, SLE_UINT8);
-	}
+	SlStridedArray(&_m[0].m3, sizeof(*_m), size, SLE_UINT8);
 }
 
 static void Load_MAP4()
 {
-	SmallStackSafeStackAlloc<byte, MAP_SL_BUF_SIZE> buf;
-	TileIndex size = MapSize();
-
-	for (TileIndex i = 0; i != size;) {
-		SlArray(buf, MAP_SL_BUF_SIZE, SLE_UINT8);
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _m[i++].m4 = buf[j];
-	}
+	SlStridedArray(&_m[0].m4, sizeof(*_m), MapSize(), SLE_UINT8);
 }
 
 static void Save_MAP4()
 {
-	SmallStackSafeStackAlloc<byte, MAP_SL_BUF_SIZE> buf;
 	TileIndex size = MapSize();
 
 	SlSetLength(size);
-	for (TileIndex i = 0; i != size;) {
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = _m[i++].m4;
-		SlArray(buf, MAP_SL_BUF_SIZE, SLE_UINT8);
-	}
+	SlStridedArray(&_m[0].m4, sizeof(*_m), size, SLE_UINT8);
 }
 
 static void Load_MAP5()
 {
-	SmallStackSafeStackAlloc<byte, MAP_SL_BUF_SIZE> buf;
-	TileIndex size = MapSize();
-
-	for (TileIndex i = 0; i != size;) {
-		SlArray(buf, MAP_SL_BUF_SIZE, SLE_UINT8);
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _m[i++].m5 = buf[j];
-	}
+	SlStridedArray(&_m[0].m5, sizeof(*_m), MapSize(), SLE_UINT8);
 }
 
 static void Save_MAP5()
 {
-	SmallStackSafeStackAlloc<byte, MAP_SL_BUF_SIZE> buf;
 	TileIndex size = MapSize();
 
 	SlSetLength(size);
-	for (TileIndex i = 0; i != size;) {
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = _m[i++].m5;
-		SlArray(buf, MAP_SL_BUF_SIZE, SLE_UINT8);
-	}
+	SlStridedArray(&_m[0].m5, sizeof(*_m), size, SLE_UINT8);
 }
 
 static void Load_MAP6()
@@ -205,46 +145,29 @@ static void Load_MAP6()
 			}
 		}
 	} else {
-		for (TileIndex i = 0; i != size;) {
-			SlArray(buf, MAP_SL_BUF_SIZE, SLE_UINT8);
-			for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _m[i++].m6 = buf[j];
-		}
+		SlStridedArray(&_m[0].m6, sizeof(*_m), size, SLE_UINT8);
 	}
 }
 
 static void Save_MAP6()
 {
-	SmallStackSafeStackAlloc<byte, MAP_SL_BUF_SIZE> buf;
 	TileIndex size = MapSize();
 
 	SlSetLength(size);
-	for (TileIndex i = 0; i != size;) {
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = _m[i++].m6;
-		SlArray(buf, MAP_SL_BUF_SIZE, SLE_UINT8);
-	}
+	SlStridedArray(&_m[0].m6, sizeof(*_m), size, SLE_UINT8);
 }
 
 static void Load_MAP7()
 {
-	SmallStackSafeStackAlloc<byte, MAP_SL_BUF_SIZE> buf;
-	TileIndex size = MapSize();
-
-	for (TileIndex i = 0; i != size;) {
-		SlArray(buf, MAP_SL_BUF_SIZE, SLE_UINT8);
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _me[i++].m7 = buf[j];
-	}
+	SlStridedArray(&_me[0].m7, sizeof(*_me), MapSize(), SLE_UINT8);
 }
 
 static void Save_MAP7()
 {
-	SmallStackSafeStackAlloc<byte, MAP_SL_BUF_SIZE> buf;
 	TileIndex size = MapSize();
 
 	SlSetLength(size);
-	for (TileIndex i = 0; i != size;) {
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = _me[i++].m7;
-		SlArray(buf, MAP_SL_BUF_SIZE, SLE_UINT8);
-	}
+	SlStridedArray(&_me[0].m7, sizeof(*_me), size, SLE_UINT8);
 }
 
 extern const ChunkHandler _map_chunk_handlers[] = {
@@ -27,6 +27,7 @@
 #include "../effectvehicle_base.h"
 #include "../engine_func.h"
 #include "../company_base.h"
+#include "../economy_func.h"
 #include "saveload_internal.h"
 #include "oldloader.h"
 
@@ -455,6 +456,8 @@ static bool FixTTOEngines()
 
 static void FixTTOCompanies()
 {
+	RebuildCompanyValueCounts();
+
 	Company *c;
 	FOR_ALL_COMPANIES(c) {
 		c->cur_economy.company_value = CalculateCompanyValue(c); // company value history is zeroed
@@ -238,8 +238,10 @@
  *  172   23947
  *  173   23967   1.2.0-RC1
  *  174   23973   1.2.x
+ *  175
+ *  176
  */
-extern const uint16 SAVEGAME_VERSION = 175; ///< Current savegame version of OpenTTD.
+extern const uint16 SAVEGAME_VERSION = 176; ///< Current savegame version of OpenTTD.
 
 SavegameType _savegame_type; ///< type of savegame we are loading
 
@@ -283,20 +285,42 @@ struct ReadBuffer {
 	{
 	}
 
-	inline byte ReadByte()
+	/** Refill the (empty) buffer from the filter. */
+	void FillBuffer()
 	{
-		if (this->bufp == this->bufe) {
-			size_t len = this->reader->Read(this->buf, lengthof(this->buf));
-			if (len == 0) SlErrorCorrupt("Unexpected end of chunk");
+		size_t len = this->reader->Read(this->buf, lengthof(this->buf));
+		if (len == 0) SlErrorCorrupt("Unexpected end of chunk");
 
-			this->read += len;
-			this->bufp = this->buf;
-			this->bufe = this->buf + len;
-		}
+		this->read += len;
+		this->bufp = this->buf;
+		this->bufe = this->buf + len;
+	}
+
+	inline byte ReadByte()
+	{
+		if (this->bufp == this->bufe) this->FillBuffer();
 
 		return *this->bufp++;
 	}
 
+	/**
+	 * Read a number of bytes at once.
+	 * @param p      Where to store the read bytes.
+	 * @param length The number of bytes to read.
+	 */
+	void CopyBytes(byte *p, size_t length)
+	{
+		while (length != 0) {
+			if (this->bufp == this->bufe) this->FillBuffer();
+
+			size_t len = min(length, (size_t)(this->bufe - this->bufp));
+			memcpy(p, this->bufp, len);
+			this->bufp += len;
+			p += len;
+			length -= len;
+		}
+	}
+
 	/**
 	 * Get the size of the memory dump made so far.
 	 * @return The size.
@@ -319,6 +343,14 @@ struct MemoryDumper {
 	{
 	}
 
+	/** Start a new chunk of memory to write to; the current one is full. */
+	void AllocateBuffer()
+	{
+		this->buf = CallocT<byte>(MEMORY_CHUNK_SIZE);
+		*this->blocks.Append() = this->buf;
+		this->bufe = this->buf + MEMORY_CHUNK_SIZE;
+	}
+
 	/**
 	 * Write a single byte into the dumper.
 	 * @param b The byte to write.
@@ -326,15 +358,29 @@ struct MemoryDumper {
 	inline void WriteByte(byte b)
 	{
 		/* Are we at the end of this chunk? */
-		if (this->buf == this->bufe) {
-			this->buf = CallocT<byte>(MEMORY_CHUNK_SIZE);
-			*this->blocks.Append() = this->buf;
-			this->bufe = this->buf + MEMORY_CHUNK_SIZE;
-		}
+		if (this->buf == this->bufe) this->AllocateBuffer();
 
 		*this->buf++ = b;
 	}
 
+	/**
+	 * Write a number of bytes at once.
+	 * @param p      The bytes to write.
+	 * @param length The number of bytes to write.
+	 */
+	void CopyBytes(const byte *p, size_t length)
+	{
+		while (length != 0) {
+			if (this->buf == this->bufe) this->AllocateBuffer();
+
+			size_t len = min(length, (size_t)(this->bufe - this->buf));
+			memcpy(this->buf, p, len);
+			this->buf += len;
+			p += len;
+			length -= len;
+		}
+	}
+
 	/**
 	 * Flush this dumper into a writer.
 	 * @param writer The filter we want to use.
@@ -873,10 +919,10 @@ static void SlCopyBytes(void *ptr, size_t length)
 	switch (_sl.action) {
 		case SLA_LOAD_CHECK:
 		case SLA_LOAD:
-			for (; length != 0; length--) *p++ = SlReadByte();
+			_sl.reader->CopyBytes(p, length);
 			break;
 		case SLA_SAVE:
-			for (; length != 0; length--) SlWriteByte(*p++);
+			_sl.dumper->CopyBytes(p, length);
 			break;
 		default: NOT_REACHED();
 	}
@@ -1180,6 +1226,92 @@ void SlArray(void *array, size_t length, VarType conv)
 }
 
 
+/**
+ * Save/Load the elements of an array of which the elements are not next to
+ * each other in memory, like a single member of all items of an array of
+ * structs. 8 and 16 bits elements are written directly into the memory dump
+ * and read directly from the read buffer, without going through the
+ * generic conversion for every element.
+ * @param array  The first element being manipulated.
+ * @param stride The distance in bytes between two elements.
+ * @param length The number of elements.
+ * @param conv   VarType type of the elements.
+ */
+void SlStridedArray(void *array, size_t stride, size_t length, VarType conv)
+{
+	if (_sl.action == SLA_PTRS || _sl.action == SLA_NULL) return;
+
+	/* Automatically calculate the length? */
+	if (_sl.need_length != NL_NONE) {
+		SlSetLength(SlCalcArrayLen(length, conv));
+		/* Determine length only? */
+		if (_sl.need_length == NL_CALCLENGTH) return;
+	}
+
+	byte *a = (byte *)array;
+	size_t size = SlCalcConvFileLen(conv);
+
+	/* Only plain integers of which the size in memory and in the savegame are
+	 * the same can be copied in bulk; the buggy version 0 savegames have their
+	 * 16 bits elements in native byte order, so those can't either. */
+	VarType file_type = GetVarFileType(conv);
+	bool plain = file_type == SLE_FILE_I8 || file_type == SLE_FILE_U8 || file_type == SLE_FILE_I16 || file_type == SLE_FILE_U16;
+	if (!plain || size != SlCalcConvMemLen(conv) || (_sl.action != SLA_SAVE && _sl_version == 0)) {
+		for (; length != 0; length--, a += stride) {
+			if (size == 2 && _sl.action != SLA_SAVE && _sl_version == 0) {
+				SlCopyBytes(a, size);
+			} else {
+				SlSaveLoadConv(a, conv);
+			}
+		}
+		return;
+	}
+
+	while (length != 0) {
+		/* The number of elements that fit in the current buffer in one go. */
+		size_t n;
+		if (_sl.action == SLA_SAVE) {
+			MemoryDumper *d = _sl.dumper;
+			if (d->buf == d->bufe) d->AllocateBuffer();
+			n = min(length, (size_t)(d->bufe - d->buf) / size);
+
+			byte *p = d->buf;
+			if (size == 1) {
+				for (size_t i = 0; i != n; i++, a += stride) *p++ = *a;
+			} else {
+				for (size_t i = 0; i != n; i++, a += stride) {
+					uint16 v = *(const uint16 *)a;
+					*p++ = GB(v, 8, 8);
+					*p++ = GB(v, 0, 8);
+				}
+			}
+			d->buf = p;
+		} else {
+			ReadBuffer *r = _sl.reader;
+			if (r->bufp == r->bufe) r->FillBuffer();
+			n = min(length, (size_t)(r->bufe - r->bufp) / size);
+
+			byte *p = r->bufp;
+			if (size == 1) {
+				for (size_t i = 0; i != n; i++, a += stride) *a = *p++;
+			} else {
+				for (size_t i = 0; i != n; i++, a += stride, p += 2) {
+					*(uint16 *)a = p[0] << 8 | p[1];
+				}
+			}
+			r->bufp = p;
+		}
+
+		if (n == 0) {
+			/* An element is split over two buffers; let the generic code handle that one. */
+			SlSaveLoadConv(a, conv);
+			a += stride;
+			n = 1;
+		}
+		length -= n;
+	}
+}
+
 /**
  * Pointers cannot be saved to a savegame, so this functions gets
  * the index of the item, and if not available, it hussles with
@@ -1286,11 +1418,13 @@ static void *IntToReference(size_t index, SLRefType rt)
 
 /**
  * Return the size in bytes of a list
- * @param list The std::list to find the size of
+ * @param list The std::list or std::deque to find the size of
+ * @tparam PtrList The type of the list.
  */
+template <typename PtrList>
 static inline size_t SlCalcListLen(const void *list)
 {
-	const std::list<void *> *l = (const std::list<void *> *) list;
+	const PtrList *l = (const PtrList *) list;
 
 	int type_size = IsSavegameVersionBefore(69) ? 2 : 4;
 	/* Each entry is saved as type_size bytes, plus type_size bytes are used for the length
@@ -1303,24 +1437,25 @@ static inline size_t SlCalcListLen(const void *list)
  * Save/Load a list.
  * @param list The list being manipulated
  * @param conv SLRefType type of the list (Vehicle *, Station *, etc)
+ * @tparam PtrList The type of the list; a std::list or std::deque of pointers.
  */
+template <typename PtrList>
 static void SlList(void *list, SLRefType conv)
 {
 	/* Automatically calculate the length? */
 	if (_sl.need_length != NL_NONE) {
-		SlSetLength(SlCalcListLen(list));
+		SlSetLength(SlCalcListLen<PtrList>(list));
 		/* Determine length only? */
 		if (_sl.need_length == NL_CALCLENGTH) return;
 	}
 
-	typedef std::list<void *> PtrList;
 	PtrList *l = (PtrList *)list;
 
 	switch (_sl.action) {
 		case SLA_SAVE: {
 			SlWriteUint32((uint32)l->size());
 
-			PtrList::iterator iter;
+			typename PtrList::iterator iter;
 			for (iter = l->begin(); iter != l->end(); ++iter) {
 				void *ptr = *iter;
 				SlWriteUint32((uint32)ReferenceToInt(ptr, conv));
@@ -1342,7 +1477,7 @@ static void SlList(void *list, SLRefType conv)
 			PtrList temp = *l;
 
 			l->clear();
-			PtrList::iterator iter;
+			typename PtrList::iterator iter;
 			for (iter = temp.begin(); iter != temp.end(); ++iter) {
 				void *ptr = IntToReference((size_t)*iter, conv);
 				l->push_back(ptr);
@@ -1408,6 +1543,7 @@ size_t SlCalcObjMemberLength(const void *object, const SaveLoad *sld)
 		case SL_ARR:
 		case SL_STR:
 		case SL_LST:
+		case SL_DEQUE:
 			/* CONDITIONAL saveload types depend on the savegame version */
 			if (!SlIsObjectValidInSavegame(sld)) break;
 
@@ -1416,7 +1552,8 @@ size_t SlCalcObjMemberLength(const void *object, const SaveLoad *sld)
 				case SL_REF: return SlCalcRefLen();
 				case SL_ARR: return SlCalcArrayLen(sld->length, sld->conv);
 				case SL_STR: return SlCalcStringLen(GetVariableAddress(object, sld), sld->length, sld->conv);
-				case SL_LST: return SlCalcListLen(GetVariableAddress(object, sld));
+				case SL_LST: return SlCalcListLen<std::list<void *> >(GetVariableAddress(object, sld));
+				case SL_DEQUE: return SlCalcListLen<std::deque<void *> >(GetVariableAddress(object, sld));
 				default: NOT_REACHED();
 			}
 			break;
@@ -1438,6 +1575,7 @@ bool SlObjectMember(void *ptr, const SaveLoad *sld)
 		case SL_ARR:
 		case SL_STR:
 		case SL_LST:
+		case SL_DEQUE:
 			/* CONDITIONAL saveload types depend on the savegame version */
 			if (!SlIsObjectValidInSavegame(sld)) return false;
 			if (SlSkipVariableOnLoad(sld)) return false;
@@ -1464,7 +1602,8 @@ bool SlObjectMember(void *ptr, const SaveLoad *sld)
 					break;
 				case SL_ARR: SlArray(ptr, sld->length, conv); break;
 				case SL_STR: SlString(ptr, sld->length, sld->conv); break;
-				case SL_LST: SlList(ptr, (SLRefType)conv); break;
+				case SL_LST: SlList<std::list<void *> >(ptr, (SLRefType)conv); break;
+				case SL_DEQUE: SlList<std::deque<void *> >(ptr, (SLRefType)conv); break;
 				default: NOT_REACHED();
 			}
 			break;
@@ -2227,6 +2366,415 @@ struct LZMASaveFilter : SaveFilter {
 
 #endif /* WITH_LZMA */
 
+/********************************************
+ ********** START OF BLOCK CODE *************
+ ********************************************/
+
+#if defined(WITH_ZLIB) || defined(WITH_LZMA)
+
+/** Size of the (uncompressed) blocks that are compressed independently of each other. */
+static const size_t SAVE_BLOCK_SIZE = 1024 * 1024;
+/** Maximum number of blocks in a savegame; 1 GB uncompressed ought to be enough for everybody. */
+static const uint32 SAVE_BLOCK_MAX_COUNT = 1024;
+
+/** The codecs a block of the block format can be compressed with. */
+enum SaveBlockCodec {
+	SBC_ZLIB = 'Z', ///< The blocks are compressed with zlib.
+	SBC_LZMA = 'X', ///< The blocks are compressed with LZMA.
+};
+
+/** A block of the savegame that is compressed independently of the other blocks. */
+struct SaveBlock {
+	byte *data;         ///< The uncompressed data.
+	size_t size;        ///< Number of bytes of uncompressed data.
+	byte *packed;       ///< The compressed data.
+	size_t packed_size; ///< Number of bytes of compressed data.
+	bool failed;        ///< Whether (de)compressing this block failed.
+};
+
+/** Filter collecting the compressed data of a single block in memory. */
+struct SaveBlockWriter : SaveFilter {
+	SaveBlock *block; ///< The block we are writing the compressed data of.
+	size_t capacity;  ///< Number of bytes allocated for the compressed data.
+
+	/**
+	 * Initialise this filter.
+	 * @param block The block to collect the compressed data in.
+	 */
+	SaveBlockWriter(SaveBlock *block) : SaveFilter(NULL), block(block), capacity(0)
+	{
+	}
+
+	/* virtual */ void Write(byte *buf, size_t size)
+	{
+		if (this->block->packed_size + size > this->capacity) {
+			this->capacity = max(this->capacity * 2, this->block->packed_size + size);
+			this->block->packed = ReallocT(this->block->packed, this->capacity);
+		}
+		memcpy(this->block->packed + this->block->packed_size, buf, size);
+		this->block->packed_size += size;
+	}
+};
+
+/** Filter feeding the compressed data of a single block from memory. */
+struct SaveBlockReader : LoadFilter {
+	const byte *bufp; ///< Location we're at reading the compressed data.
+	const byte *bufe; ///< End of the compressed data.
+
+	/**
+	 * Initialise this filter.
+	 * @param block The block to read the compressed data of.
+	 */
+	SaveBlockReader(const SaveBlock *block) : LoadFilter(NULL), bufp(block->packed), bufe(block->packed + block->packed_size)
+	{
+	}
+
+	/* virtual */ size_t Read(byte *buf, size_t size)
+	{
+		size = min(size, (size_t)(this->bufe - this->bufp));
+		memcpy(buf, this->bufp, size);
+		this->bufp += size;
+		return size;
+	}
+
+	/* virtual */ void Reset()
+	{
+		NOT_REACHED();
+	}
+};
+
+/** The (de)compression work of all blocks, shared by the threads doing it. */
+struct SaveBlockJobs {
+	SaveBlock *blocks;    ///< The blocks to (de)compress.
+	uint count;           ///< Number of blocks.
+	uint next;            ///< The next block that has not been claimed by a thread.
+	ThreadMutex *mutex;   ///< Mutex guarding #next.
+	SaveBlockCodec codec; ///< The codec to use.
+	byte compression;     ///< Compression level when compressing.
+	bool compress;        ///< Whether to compress or decompress the blocks.
+
+	/**
+	 * Compress the uncompressed data of a block.
+	 * @param block The block to compress.
+	 */
+	void Compress(SaveBlock *block)
+	{
+		SaveFilter *sf = new SaveBlockWriter(block);
+		try {
+#if defined(WITH_LZMA)
+			if (this->codec == SBC_LZMA) sf = new LZMASaveFilter(sf, this->compression);
+#endif
+#if defined(WITH_ZLIB)
+			if (this->codec == SBC_ZLIB) sf = new ZlibSaveFilter(sf, this->compression);
+#endif
+			sf->Write(block->data, block->size);
+			sf->Finish();
+		} catch (...) {
+			block->failed = true;
+		}
+		delete sf;
+	}
+
+	/**
+	 * Decompress the compressed data of a block.
+	 * @param block The block to decompress.
+	 */
+	void Decompress(SaveBlock *block)
+	{
+		LoadFilter *lf = new SaveBlockReader(block);
+		try {
+#if defined(WITH_LZMA)
+			if (this->codec == SBC_LZMA) lf = new LZMALoadFilter(lf);
+#endif
+#if defined(WITH_ZLIB)
+			if (this->codec == SBC_ZLIB) lf = new ZlibLoadFilter(lf);
+#endif
+			block->failed = lf->Read(block->data, block->size) != block->size;
+		} catch (...) {
+			block->failed = true;
+		}
+		delete lf;
+	}
+
+	/** (De)compress blocks until there are none left. */
+	void Run()
+	{
+		for (;;) {
+			this->mutex->BeginCritical();
+			uint i = this->next++;
+			this->mutex->EndCritical();
+
+			if (i >= this->count) return;
+			if (this->compress) {
+				this->Compress(&this->blocks[i]);
+			} else {
+				this->Decompress(&this->blocks[i]);
+			}
+		}
+	}
+
+	/**
+	 * Thread entry for (de)compressing the blocks.
+	 * @param arg The jobs to work on.
+	 */
+	static void RunThread(void *arg)
+	{
+		((SaveBlockJobs *)arg)->Run();
+	}
+
+	/**
+	 * (De)compress all blocks, using as many threads as there are cores.
+	 * The current thread joins in, so when no threads can be created all
+	 * work is simply done by the current thread.
+	 * @return Whether all blocks were (de)compressed successfully.
+	 */
+	bool RunAll()
+	{
+		this->next = 0;
+		this->mutex = ThreadMutex::New();
+
+		uint num_threads = min(GetCPUCoreCount(), this->count);
+		ThreadObject **threads = CallocT<ThreadObject *>(max(num_threads, 1U));
+		for (uint i = 1; i < num_threads; i++) {
+			if (!ThreadObject::New(&SaveBlockJobs::RunThread, this, &threads[i])) {
+				threads[i] = NULL;
+				break;
+			}
+		}
+
+		this->Run();
+
+		for (uint i = 1; i < num_threads && threads[i] != NULL; i++) {
+			threads[i]->Join();
+			delete threads[i];
+		}
+		free(threads);
+
+		delete this->mutex;
+		this->mutex = NULL;
+
+		for (uint i = 0; i < this->count; i++) {
+			if (this->blocks[i].failed) return false;
+		}
+		return true;
+	}
+};
+
+#if defined(WITH_LZMA)
+/** LZMA is preferred, as it makes the blocks the smallest. */
+static const SaveBlockCodec SAVE_BLOCK_CODEC = SBC_LZMA;
+#else
+static const SaveBlockCodec SAVE_BLOCK_CODEC = SBC_ZLIB;
+#endif
+
+/**
+ * Filter reading the block format. The format is an index with the codec,
+ * the number of blocks and the (un)compressed size of each block, followed
+ * by the compressed data of all blocks. As each block is compressed on its
+ * own, they are all decompressed in parallel.
+ */
+struct BlockLoadFilter : LoadFilter {
+	SaveBlock *blocks; ///< The blocks of the savegame.
+	uint32 count;      ///< Number of blocks.
+	uint32 current;    ///< The block we are reading from.
+	size_t pos;        ///< Position within the current block.
+	bool loaded;       ///< Whether the blocks have been read and decompressed.
+
+	/**
+	 * Initialise this filter.
+	 * @param chain The next filter in this chain.
+	 */
+	BlockLoadFilter(LoadFilter *chain) : LoadFilter(chain), blocks(NULL), count(0), current(0), pos(0), loaded(false)
+	{
+	}
+
+	/** Clean everything up. */
+	~BlockLoadFilter()
+	{
+		this->FreeBlocks();
+	}
+
+	/** Free the memory of all blocks. */
+	void FreeBlocks()
+	{
+		for (uint i = 0; i < this->count; i++) {
+			free(this->blocks[i].data);
+			free(this->blocks[i].packed);
+		}
+		free(this->blocks);
+		this->blocks = NULL;
+		this->count = 0;
+	}
+
+	/**
+	 * Read a big endian 32 bits integer from the chain.
+	 * @return The read integer.
+	 */
+	uint32 ReadUint32()
+	{
+		uint32 v;
+		if (this->chain->Read((byte*)&v, sizeof(v)) != sizeof(v)) SlError(STR_GAME_SAVELOAD_ERROR_FILE_NOT_READABLE);
+		return FROM_BE32(v);
+	}
+
+	/** Read the index and the compressed data of the blocks, and decompress all blocks. */
+	void LoadBlocks()
+	{
+		SaveBlockJobs jobs;
+		jobs.codec = (SaveBlockCodec)this->ReadUint32();
+		switch (jobs.codec) {
+#if defined(WITH_ZLIB)
+			case SBC_ZLIB: break;
+#endif
+#if defined(WITH_LZMA)
+			case SBC_LZMA: break;
+#endif
+			default: SlError(STR_GAME_SAVELOAD_ERROR_BROKEN_INTERNAL_ERROR, "unsupported block codec");
+		}
+
+		uint32 count = this->ReadUint32();
+		if (count > SAVE_BLOCK_MAX_COUNT) SlErrorCorrupt("Too many blocks");
+
+		this->blocks = CallocT<SaveBlock>(count);
+		this->count = count;
+		for (uint i = 0; i < count; i++) {
+			SaveBlock *b = &this->blocks[i];
+			b->size = this->ReadUint32();
+			b->packed_size = this->ReadUint32();
+			if (b->size > SAVE_BLOCK_SIZE || b->packed_size > 2 * SAVE_BLOCK_SIZE) SlErrorCorrupt("Inconsistent block size");
+		}
+
+		for (uint i = 0; i < count; i++) {
+			SaveBlock *b = &this->blocks[i];
+			b->data = MallocT<byte>(b->size);
+			b->packed = MallocT<byte>(b->packed_size);
+			if (this->chain->Read(b->packed, b->packed_size) != b->packed_size) SlError(STR_GAME_SAVELOAD_ERROR_FILE_NOT_READABLE);
+		}
+
+		jobs.blocks = this->blocks;
+		jobs.count = count;
+		jobs.compress = false;
+		if (!jobs.RunAll()) SlError(STR_GAME_SAVELOAD_ERROR_BROKEN_INTERNAL_ERROR, "decompressing block failed");
+
+		/* The compressed data is not needed anymore. */
+		for (uint i = 0; i < count; i++) {
+			free(this->blocks[i].packed);
+			this->blocks[i].packed = NULL;
+		}
+		this->loaded = true;
+	}
+
+	/* virtual */ size_t Read(byte *buf, size_t size)
+	{
+		if (!this->loaded) this->LoadBlocks();
+
+		size_t read = 0;
+		while (read < size && this->current < this->count) {
+			SaveBlock *b = &this->blocks[this->current];
+			size_t len = min(size - read, b->size - this->pos);
+			memcpy(buf + read, b->data + this->pos, len);
+			read += len;
+			this->pos += len;
+
+			if (this->pos == b->size) {
+				/* Done with this block, so release its memory early. */
+				free(b->data);
+				b->data = NULL;
+				this->current++;
+				this->pos = 0;
+			}
+		}
+		return read;
+	}
+
+	/* virtual */ void Reset()
+	{
+		this->FreeBlocks();
+		this->current = 0;
+		this->pos = 0;
+		this->loaded = false;
+		this->chain->Reset();
+	}
+};
+
+/** Filter writing the block format; see #BlockLoadFilter for the layout. */
+struct BlockSaveFilter : SaveFilter {
+	SmallVector<SaveBlock, 16> blocks; ///< The blocks of the savegame.
+	byte compression;                  ///< The requested level of compression.
+
+	/**
+	 * Initialise this filter.
+	 * @param chain             The next filter in this chain.
+	 * @param compression_level The requested level of compression.
+	 */
+	BlockSaveFilter(SaveFilter *chain, byte compression_level) : SaveFilter(chain), compression(compression_level)
+	{
+	}
+
+	/** Clean up what we allocated. */
+	~BlockSaveFilter()
+	{
+		for (SaveBlock *b = this->blocks.Begin(); b != this->blocks.End(); b++) {
+			free(b->data);
+			free(b->packed);
+		}
+	}
+
+	/* virtual */ void Write(byte *buf, size_t size)
+	{
+		while (size > 0) {
+			SaveBlock *b = this->blocks.Length() == 0 ? NULL : this->blocks.End() - 1;
+			if (b == NULL || b->size == SAVE_BLOCK_SIZE) {
+				if (this->blocks.Length() == SAVE_BLOCK_MAX_COUNT) SlError(STR_GAME_SAVELOAD_ERROR_BROKEN_INTERNAL_ERROR, "savegame too big");
+				b = this->blocks.Append();
+				MemSetT(b, 0);
+				b->data = MallocT<byte>(SAVE_BLOCK_SIZE);
+			}
+
+			size_t len = min(size, SAVE_BLOCK_SIZE - b->size);
+			memcpy(b->data + b->size, buf, len);
+			b->size += len;
+			buf += len;
+			size -= len;
+		}
+	}
+
+	/**
+	 * Write a 32 bits integer as big endian to the chain.
+	 * @param v The integer to write.
+	 */
+	void WriteUint32(uint32 v)
+	{
+		v = TO_BE32(v);
+		this->chain->Write((byte*)&v, sizeof(v));
+	}
+
+	/* virtual */ void Finish()
+	{
+		SaveBlockJobs jobs;
+		jobs.blocks = this->blocks.Begin();
+		jobs.count = this->blocks.Length();
+		jobs.codec = SAVE_BLOCK_CODEC;
+		jobs.compression = this->compression;
+		jobs.compress = true;
+		if (!jobs.RunAll()) SlError(STR_GAME_SAVELOAD_ERROR_BROKEN_INTERNAL_ERROR, "compressing block failed");
+
+		this->WriteUint32(SAVE_BLOCK_CODEC);
+		this->WriteUint32(this->blocks.Length());
+		for (const SaveBlock *b = this->blocks.Begin(); b != this->blocks.End(); b++) {
+			this->WriteUint32((uint32)b->size);
+			this->WriteUint32((uint32)b->packed_size);
+		}
+		for (const SaveBlock *b = this->blocks.Begin(); b != this->blocks.End(); b++) {
+			this->chain->Write(b->packed, b->packed_size);
+		}
+
+		this->chain->Finish();
+	}
+};
+
+#endif /* WITH_ZLIB || WITH_LZMA */
+
 /*******************************************
  ************* END OF CODE *****************
  *******************************************/
@@ -2262,6 +2810,16 @@ static const SaveLoadFormat _saveload_formats[] = {
 #else
 	{"zlib",   TO_BE32X('OTTZ'), NULL,                               NULL,                               0, 0, 0},
 #endif
+#if defined(WITH_LZMA)
+	/* Splits the savegame in blocks of 1 MiB that are compressed independently with LZMA, so all cores can be
+	 * used for compressing and decompressing. The savegame gets slightly bigger than with plain LZMA. */
+	{"block",  TO_BE32X('OTTB'), CreateLoadFilter<BlockLoadFilter>,  CreateSaveFilter<BlockSaveFilter>,  0, 2, 9},
+#elif defined(WITH_ZLIB)
+	/* Without LZMA the blocks are compressed with zlib. */
+	{"block",  TO_BE32X('OTTB'), CreateLoadFilter<BlockLoadFilter>,  CreateSaveFilter<BlockSaveFilter>,  0, 6, 9},
+#else
+	{"block",  TO_BE32X('OTTB'), NULL,                               NULL,                               0, 0, 0},
+#endif
 #if defined(WITH_LZMA)
 	/* Level 2 compression is speed wise as fast as zlib level 6 compression (old default), but results in ~10% smaller saves.
 	 * Higher compression levels are possible, and might improve savegame size by up to 25%, but are also up to 10 times slower.
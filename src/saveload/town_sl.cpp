@@ -182,6 +182,9 @@ static const SaveLoad _town_desc[] = {
 
 	SLE_CONDVAR(Town, cargo_produced,       SLE_UINT32,                166, SL_MAX_VERSION),
 
+	SLE_CONDVAR(Town, num_growth_candidates, SLE_UINT8,                176, SL_MAX_VERSION),
+	SLE_CONDARR(Town, growth_candidates,   SLE_UINT32, TOWN_GROWTH_CANDIDATES, 176, SL_MAX_VERSION),
+
 	/* reserve extra space in savegame here. (currently 30 bytes) */
 	SLE_CONDNULL(30, 2, SL_MAX_VERSION),
 
@@ -278,6 +281,8 @@ static void Load_TOWN()
 			SlErrorCorrupt("Invalid town name generator");
 		}
 
+		if (t->num_growth_candidates > TOWN_GROWTH_CANDIDATES) SlErrorCorrupt("Too many town growth candidates");
+
 		if (IsSavegameVersionBefore(166)) continue;
 
 		SlObject(&t->cargo_accepted, GetTileMatrixDesc());
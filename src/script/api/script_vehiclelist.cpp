@@ -16,6 +16,7 @@
 #include "script_station.hpp"
 #include "../../depot_map.h"
 #include "../../vehicle_base.h"
+#include "../../vehiclelist.h"
 
 ScriptVehicleList::ScriptVehicleList()
 {
@@ -29,18 +30,11 @@ ScriptVehicleList_Station::ScriptVehicleList_Station(StationID station_id)
 {
 	if (!ScriptBaseStation::IsValidBaseStation(station_id)) return;
 
-	const Vehicle *v;
-	FOR_ALL_VEHICLES(v) {
-		if ((v->owner == ScriptObject::GetCompany() || ScriptObject::GetCompany() == OWNER_DEITY) && v->IsPrimaryVehicle()) {
-			const Order *order;
+	VehicleList list;
+	BuildStationVehicleList(station_id, VEH_INVALID, false, &list);
 
-			FOR_VEHICLE_ORDERS(v, order) {
-				if ((order->IsType(OT_GOTO_STATION) || order->IsType(OT_GOTO_WAYPOINT)) && order->GetDestination() == station_id) {
-					this->AddItem(v->index);
-					break;
-				}
-			}
-		}
+	for (const Vehicle * const *v = list.Begin(); v != list.End(); v++) {
+		if ((*v)->owner == ScriptObject::GetCompany() || ScriptObject::GetCompany() == OWNER_DEITY) this->AddItem((*v)->index);
 	}
 }
 
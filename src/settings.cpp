@@ -734,7 +734,7 @@ static bool RedrawSmallmap(int32 p1)
 {
 	BuildLandLegend();
 	BuildOwnerLegend();
-	SetWindowClassesDirty(WC_SMALLMAP);
+	InvalidateWindowClassesData(WC_SMALLMAP, 2);
 	return true;
 }
 
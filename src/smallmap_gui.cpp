@@ -563,6 +563,110 @@ static const byte _vehicle_type_colours[6] = {
 };
 
 
+/**
+ * Colours of the groups of tiles shown on the smallmap, so the colour
+ * functions above only have to be called again for tiles that changed.
+ * The cache holds the groups for the current mode, zoom level and
+ * alignment of the smallmap; changing any of these starts afresh.
+ */
+struct SmallMapCache {
+	uint32 *colours; ///< Colours of the groups, see SmallMapWindow::GetTileColours.
+	uint32 *valid;   ///< Bitmap of the groups whose colour is known.
+	uint num_words;  ///< Number of words in #valid.
+	uint refresh;    ///< Next word of #valid to clear in #RefreshPart.
+	uint size_x;     ///< Number of groups in x direction.
+	uint size_y;     ///< Number of groups in y direction.
+	uint offset_x;   ///< X coordinate of the first tile of the first group.
+	uint offset_y;   ///< Y coordinate of the first tile of the first group.
+	uint zoom;       ///< Number of tiles in both directions in a group.
+	int map_type;    ///< Smallmap mode the colours are for.
+
+	/**
+	 * Make sure the cache is for the given groups.
+	 * @param map_type Smallmap mode.
+	 * @param zoom     Number of tiles in both directions in a group.
+	 * @param offset_x X coordinate of the first tile of a group, modulo \a zoom.
+	 * @param offset_y Y coordinate of the first tile of a group, modulo \a zoom.
+	 */
+	void Setup(int map_type, uint zoom, uint offset_x, uint offset_y)
+	{
+		uint size_x = CeilDiv(MapSizeX() - offset_x, zoom);
+		uint size_y = CeilDiv(MapSizeY() - offset_y, zoom);
+		if (this->colours != NULL && this->map_type == map_type && this->zoom == zoom && this->offset_x == offset_x &&
+				this->offset_y == offset_y && this->size_x == size_x && this->size_y == size_y) {
+			return;
+		}
+
+		this->Free();
+		this->map_type = map_type;
+		this->zoom     = zoom;
+		this->offset_x = offset_x;
+		this->offset_y = offset_y;
+		this->size_x   = size_x;
+		this->size_y   = size_y;
+		this->num_words = CeilDiv(size_x * size_y, 32);
+		this->refresh  = 0;
+		this->colours  = MallocT<uint32>(size_x * size_y);
+		this->valid    = CallocT<uint32>(this->num_words);
+	}
+
+	/** Free the cache. */
+	void Free()
+	{
+		free(this->colours);
+		free(this->valid);
+		this->colours = NULL;
+		this->valid = NULL;
+	}
+
+	/** Forget the colours of all groups. */
+	void Clear()
+	{
+		if (this->valid != NULL) MemSetT(this->valid, 0, this->num_words);
+	}
+
+	/**
+	 * Forget the colours of the next part of the groups. Not every change
+	 * that affects the smallmap marks the tile dirty, e.g. a change of
+	 * owner or of the snow on the ground, so now and then every group is
+	 * looked at again.
+	 */
+	void RefreshPart()
+	{
+		if (this->valid == NULL) return;
+
+		uint count = min(this->num_words - this->refresh, CeilDiv(this->num_words, 8));
+		MemSetT(this->valid + this->refresh, 0, count);
+		this->refresh += count;
+		if (this->refresh == this->num_words) this->refresh = 0;
+	}
+
+	/**
+	 * Forget the colour of the group a tile is in.
+	 * @param x X coordinate of the tile.
+	 * @param y Y coordinate of the tile.
+	 */
+	inline void MarkDirty(uint x, uint y)
+	{
+		if (this->valid == NULL || x < this->offset_x || y < this->offset_y) return;
+
+		uint i = (y - this->offset_y) / this->zoom * this->size_x + (x - this->offset_x) / this->zoom;
+		ClrBit(this->valid[i / 32], i % 32);
+	}
+};
+
+static SmallMapCache _smallmap_cache; ///< Colours of the groups of tiles shown on the smallmap.
+
+/**
+ * Mark a tile dirty on the smallmap, so its colour is looked up again
+ * the next time the smallmap is drawn.
+ * @param tile The tile that changed.
+ */
+void MarkSmallMapTileDirty(TileIndex tile)
+{
+	_smallmap_cache.MarkDirty(TileX(tile), TileY(tile));
+}
+
 /** Class managing the smallmap window. */
 class SmallMapWindow : public Window {
 	/** Types of legends in the #WID_SM_LEGEND widget. */
@@ -782,6 +886,7 @@ class SmallMapWindow : public Window {
 
 	/**
 	 * Draws one column of tiles of the small map in a certain mode onto the screen buffer, skipping the shifted rows in between.
+	 * The colours of the tiles come from #_smallmap_cache when they are known.
 	 *
 	 * @param dst Pointer to a part of the screen buffer to write to.
 	 * @param xc The X coordinate of the first tile in the column.
@@ -818,7 +923,13 @@ class SmallMapWindow : public Window {
 			}
 			ta.ClampToMap(); // Clamp to map boundaries (may contain MP_VOID tiles!).
 
-			uint32 val = this->GetTileColours(ta);
+			/* Look up the colours of the tiles, unless they are already known. */
+			uint i = (yc - _smallmap_cache.offset_y) / this->zoom * _smallmap_cache.size_x + (xc - _smallmap_cache.offset_x) / this->zoom;
+			if (!HasBit(_smallmap_cache.valid[i / 32], i % 32)) {
+				_smallmap_cache.colours[i] = this->GetTileColours(ta);
+				SetBit(_smallmap_cache.valid[i / 32], i % 32);
+			}
+			uint32 val = _smallmap_cache.colours[i];
 			uint8 *val8 = (uint8 *)&val;
 			int idx = max(0, -start_pos);
 			for (int pos = max(0, start_pos); pos < end_pos; pos++) {
@@ -947,7 +1058,8 @@ class SmallMapWindow : public Window {
 	 * Basically, the small map is draw column of pixels by column of pixels. The pixels
 	 * are drawn directly into the screen buffer. The final map is drawn in multiple passes.
 	 * The passes are:
-	 * <ol><li>The colours of tiles in the different modes.</li>
+	 * <ol><li>The colours of tiles in the different modes, mostly from #_smallmap_cache.</li>
+	 * <li>Vehicles (in some modes)</li>
 	 * <li>Town names (optional)</li></ol>
 	 *
 	 * @param dpi pointer to pixel to write onto
@@ -969,6 +1081,9 @@ class SmallMapWindow : public Window {
 		int tile_x = this->scroll_x / (int)TILE_SIZE + tile.x;
 		int tile_y = this->scroll_y / (int)TILE_SIZE + tile.y;
 
+		/* All drawn groups of tiles start at tile_x and tile_y plus a multiple of the zoom level. */
+		_smallmap_cache.Setup(this->map_type, this->zoom, (tile_x % this->zoom + this->zoom) % this->zoom, (tile_y % this->zoom + this->zoom) % this->zoom);
+
 		void *ptr = blitter->MoveTo(dpi->dst_ptr, -dx - 4, 0);
 		int x = - dx - 4;
 		int y = 0;
@@ -1067,6 +1182,11 @@ public:
 		this->SmallMapCenterOnCurrentPos();
 	}
 
+	~SmallMapWindow()
+	{
+		_smallmap_cache.Free();
+	}
+
 	/**
 	 * Compute minimal required width of the legends.
 	 * @return Minimally needed width for displaying the smallmap legends in pixels.
@@ -1384,6 +1504,7 @@ public:
 							}
 						}
 					}
+					_smallmap_cache.Clear();
 					this->SetDirty();
 				}
 				break;
@@ -1398,6 +1519,7 @@ public:
 						_legend_land_owners[i].show_on_map = true;
 					}
 				}
+				_smallmap_cache.Clear();
 				this->SetDirty();
 				break;
 
@@ -1411,12 +1533,14 @@ public:
 						_legend_land_owners[i].show_on_map = false;
 					}
 				}
+				_smallmap_cache.Clear();
 				this->SetDirty();
 				break;
 
 			case WID_SM_SHOW_HEIGHT: // Enable/disable showing of heightmap.
 				_smallmap_show_heightmap = !_smallmap_show_heightmap;
 				this->SetWidgetLoweredState(WID_SM_SHOW_HEIGHT, _smallmap_show_heightmap);
+				_smallmap_cache.Clear();
 				this->SetDirty();
 				break;
 		}
@@ -1427,12 +1551,18 @@ public:
 	 * @param data Information about the changed data.
 	 * - data = 0: Displayed industries at the industry chain window have changed.
 	 * - data = 1: Companies have changed.
+	 * - data = 2: The colour scheme has changed.
 	 * @param gui_scope Whether the call is done from GUI scope. You may not do everything when not in GUI scope. See #InvalidateWindowData() for details.
 	 */
 	virtual void OnInvalidateData(int data = 0, bool gui_scope = true)
 	{
 		if (!gui_scope) return;
+		_smallmap_cache.Clear();
 		switch (data) {
+			case 2:
+				/* Only the colours have changed. */
+				break;
+
 			case 1:
 				/* The owner legend has already been rebuilt. */
 				this->ReInit();
@@ -1480,6 +1610,7 @@ public:
 		if (--this->refresh != 0) return;
 
 		this->refresh = FORCE_REFRESH_PERIOD;
+		_smallmap_cache.RefreshPart();
 		this->SetDirty();
 	}
 
@@ -12,9 +12,12 @@
 #ifndef SMALLMAP_GUI_H
 #define SMALLMAP_GUI_H
 
+#include "tile_type.h"
+
 void BuildIndustriesLegend();
 void ShowSmallMap();
 void BuildLandLegend();
 void BuildOwnerLegend();
+void MarkSmallMapTileDirty(TileIndex tile);
 
 #endif /* SMALLMAP_GUI_H */
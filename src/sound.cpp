@@ -119,8 +119,11 @@ static bool SetBankSource(MixerChannel *mc, const SoundEntry *sound)
 	mem[sound->file_size    ] = 0;
 	mem[sound->file_size + 1] = 0;
 
+	/* Sprites may be read at the same time by other threads. */
+	FioBeginCritical();
 	FioSeekToFile(sound->file_slot, sound->file_offset);
 	FioReadBlock(mem, sound->file_size);
+	FioEndCritical();
 
 	/* 16-bit PCM WAV files should be signed by default */
 	if (sound->bits_per_sample == 8) {
@@ -164,7 +167,10 @@ static void StartSound(SoundID sound_id, float pan, uint volume)
 
 	/* NewGRF sound that wasn't loaded yet? */
 	if (sound->rate == 0 && sound->file_slot != 0) {
-		if (!LoadNewGRFSound(sound)) {
+		FioBeginCritical();
+		bool loaded = LoadNewGRFSound(sound);
+		FioEndCritical();
+		if (!loaded) {
 			/* Mark as invalid. */
 			sound->file_slot = 0;
 			return;
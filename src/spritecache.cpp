@@ -17,13 +17,18 @@
 #include "settings_type.h"
 #include "blitter/factory.hpp"
 #include "core/math_func.hpp"
+#include "core/bitmath_func.hpp"
 #include "core/mem_func.hpp"
+#include "core/smallvec_type.hpp"
+#include "thread/thread.h"
+#include "progress.h"
 
 #include "table/sprites.h"
 #include "table/palette_convert.h"
 
 /* Default of 4MB spritecache */
 uint _sprite_cache_size = 4;
+uint _sprite_cache_generation = 0; ///< Changed whenever cached sprite data is freed or moved, i.e. whenever pointers to it may become invalid.
 
 typedef SimpleTinyEnumT<SpriteType, byte> SpriteTypeByte;
 
@@ -31,11 +36,15 @@ struct SpriteCache {
 	void *ptr;
 	size_t file_pos;
 	uint32 id;
+	SpriteID lru_prev;   ///< Next more recently used sprite in the cache; only valid when cached and not a recolour sprite.
+	SpriteID lru_next;   ///< Next less recently used sprite in the cache; only valid when cached and not a recolour sprite.
 	uint16 file_slot;
-	int16 lru;
+	uint16 used_frame;   ///< Value of #_sprite_cache_frame when the sprite was last requested.
 	SpriteTypeByte type; ///< In some cases a single sprite is misused by two NewGRFs. Once as real sprite and once as recolour sprite. If the recolour sprite gets into the cache it might be drawn as real sprite which causes enormous trouble.
 	bool warned;         ///< True iff the user has been warned about incorrect use of this sprite
+	bool queued;         ///< True iff the sprite is queued for or being decoded by a sprite decoder thread.
 	byte container_ver;  ///< Container version of the GRF the sprite is from.
+	uint8 zoom_levels;   ///< Bit mask of the zoom levels the cached sprite is encoded for.
 };
 
 
@@ -72,17 +81,48 @@ static SpriteCache *AllocateSpriteCache(uint index)
 }
 
 
+struct SpriteSlab;
+
+/** Header in front of every block of cached sprite data. */
 struct MemBlock {
-	size_t size;
+	SpriteSlab *slab; ///< Slab the block is carved from, or \c NULL when the block was allocated on its own.
+	size_t size;      ///< Size of the block, including this header.
 	byte data[];
 };
 
-static uint _sprite_lru_counter;
-static MemBlock *_spritecache_ptr;
-static int _compact_cache_counter;
+/**
+ * A chunk of memory that is split into blocks of one size class.
+ * Blocks are handed out from the never used end of the slab first;
+ * blocks that are freed are put in a free list of their slab.
+ */
+struct SpriteSlab {
+	byte *mem;               ///< Memory of the blocks.
+	MemBlock *free_blocks;   ///< Blocks that have been used, but are free again; linked via their data.
+	uint num_used;           ///< Number of blocks in use.
+	uint num_carved;         ///< Number of blocks handed out from the never used end of the slab.
+	byte size_class;         ///< Size class of the blocks in this slab.
+	SpriteSlab *prev;        ///< Previous slab of the size class with free blocks.
+	SpriteSlab *next;        ///< Next slab of the size class with free blocks.
+};
+
+static const size_t MIN_BLOCK_SIZE = 64;             ///< Size of the smallest size class; must be a power of two.
+static const size_t MAX_BLOCK_SIZE = 8 * 1024;       ///< Size of the largest size class; larger blocks are allocated on their own.
+static const size_t SPRITE_SLAB_SIZE = 64 * 1024;    ///< Size of the memory of a slab.
+static const uint SIZE_CLASS_STEPS = 4;              ///< Number of size classes per doubling of the block size.
+static const uint NUM_SIZE_CLASSES = 29;             ///< Number of size classes from #MIN_BLOCK_SIZE up to #MAX_BLOCK_SIZE.
+
+static const SpriteID SPRITE_LRU_END = UINT32_MAX;   ///< Marks the ends of the LRU list.
+
+static SpriteSlab *_spritecache_slabs[NUM_SIZE_CLASSES];     ///< Per size class the slabs that have free blocks.
+static SpriteID _spritecache_lru_first = SPRITE_LRU_END;     ///< Most recently used sprite in the cache.
+static SpriteID _spritecache_lru_last  = SPRITE_LRU_END;     ///< Least recently used sprite in the cache, i.e. the first one to go.
+static SpriteCacheStats _spritecache_stats;                  ///< Statistics about the sprite cache.
+static uint16 _sprite_cache_frame = 0;                       ///< Number of the current frame, for telling which sprites are in use.
+static ZoomLevel _sprite_cache_last_zoom = ZOOM_LVL_GUI;     ///< Zoom level a sprite was last requested to be drawn at.
 
-static void CompactSpriteCache();
 static void *AllocSprite(size_t mem_req);
+static void DeleteEntryFromSpriteCache(uint item);
+static void CancelSpriteDecode(SpriteID sprite);
 
 /**
  * Skip the given amount of sprite graphics data.
@@ -263,7 +303,14 @@ static bool PadSingleSprite(SpriteLoader::Sprite *sprite, ZoomLevel zoom, uint p
 	return true;
 }
 
-static bool PadSprites(SpriteLoader::Sprite *sprite, uint8 sprite_avail)
+/**
+ * Pad the loaded zoom levels of a sprite, so their sizes and offsets match.
+ * @param sprite       The sprite per zoom level.
+ * @param sprite_avail Bit mask of the loaded zoom levels.
+ * @param pad_levels   Bit mask of the loaded zoom levels to actually pad; all loaded zoom levels determine the padding.
+ * @return True iff the padding succeeded.
+ */
+static bool PadSprites(SpriteLoader::Sprite *sprite, uint8 sprite_avail, uint8 pad_levels)
 {
 	/* Get minimum top left corner coordinates. */
 	int min_xoffs = INT32_MAX;
@@ -287,7 +334,7 @@ static bool PadSprites(SpriteLoader::Sprite *sprite, uint8 sprite_avail)
 
 	/* Pad sprites where needed. */
 	for (ZoomLevel zoom = ZOOM_LVL_BEGIN; zoom != ZOOM_LVL_END; zoom++) {
-		if (HasBit(sprite_avail, zoom)) {
+		if (HasBit(sprite_avail & pad_levels, zoom)) {
 			/* Scaling the sprite dimensions in the blitter is done with rounding up,
 			 * so a negative padding here is not an error. */
 			int pad_left   = max(0, sprite[zoom].x_offs - UnScaleByZoom(min_xoffs, zoom));
@@ -304,7 +351,16 @@ static bool PadSprites(SpriteLoader::Sprite *sprite, uint8 sprite_avail)
 	return true;
 }
 
-static bool ResizeSprites(SpriteLoader::Sprite *sprite, uint8 sprite_avail, uint32 file_slot, uint32 file_pos)
+/**
+ * Make the zoom levels of a sprite that are needed for encoding it.
+ * @param sprite       The sprite per zoom level.
+ * @param sprite_avail Bit mask of the loaded zoom levels.
+ * @param file_slot    File slot of the sprite.
+ * @param file_pos     Position of the sprite in the file.
+ * @param zoom_levels  Bit mask of the zoom levels to make.
+ * @return True iff the zoom levels could be made.
+ */
+static bool ResizeSprites(SpriteLoader::Sprite *sprite, uint8 sprite_avail, uint32 file_slot, uint32 file_pos, uint8 zoom_levels)
 {
 	/* Create a fully zoomed image if it does not exist */
 	ZoomLevel first_avail = static_cast<ZoomLevel>(FIND_FIRST_BIT(sprite_avail));
@@ -313,11 +369,15 @@ static bool ResizeSprites(SpriteLoader::Sprite *sprite, uint8 sprite_avail, uint
 		SetBit(sprite_avail, ZOOM_LVL_NORMAL);
 	}
 
+	/* Each zoom level is made from the one before it, so all zoom
+	 * levels up to the most zoomed out requested one are needed. */
+	ZoomLevel last_zoom = static_cast<ZoomLevel>(FindLastBit(zoom_levels | 1 << ZOOM_LVL_NORMAL));
+
 	/* Pad sprites to make sizes match. */
-	if (!PadSprites(sprite, sprite_avail)) return false;
+	if (!PadSprites(sprite, sprite_avail, (2 << last_zoom) - 1)) return false;
 
 	/* Create other missing zoom levels */
-	for (ZoomLevel zoom = ZOOM_LVL_OUT_2X; zoom != ZOOM_LVL_END; zoom++) {
+	for (ZoomLevel zoom = ZOOM_LVL_OUT_2X; zoom <= last_zoom; zoom++) {
 		if (HasBit(sprite_avail, zoom)) {
 			/* Check that size and offsets match the fully zoomed image. */
 			assert(sprite[zoom].width  == UnScaleByZoom(sprite[ZOOM_LVL_NORMAL].width,  zoom));
@@ -366,15 +426,20 @@ static void *ReadRecolourSprite(uint16 file_slot, uint num)
 	return dest;
 }
 
+static void *ReadFallbackSprite(AllocatorProc *allocator, uint8 zoom_levels);
+
 /**
  * Read a sprite from disk.
  * @param sc          Location of sprite.
  * @param id          Sprite number.
  * @param sprite_type Type of sprite.
  * @param allocator   Allocator function to use.
+ * @param buffers     Buffers per zoom level to load the sprite in, or \c NULL for the shared ones.
+ *                    When given, \c NULL is returned instead of a fallback sprite.
+ * @param zoom_levels Bit mask of the zoom levels to encode the sprite for.
  * @return Read sprite data.
  */
-static void *ReadSprite(const SpriteCache *sc, SpriteID id, SpriteType sprite_type, AllocatorProc *allocator)
+static void *ReadSprite(const SpriteCache *sc, SpriteID id, SpriteType sprite_type, AllocatorProc *allocator, ReusableBuffer<SpriteLoader::CommonPixel> *buffers, uint8 zoom_levels)
 {
 	uint8 file_slot = sc->file_slot;
 	size_t file_pos = sc->file_pos;
@@ -388,7 +453,9 @@ static void *ReadSprite(const SpriteCache *sc, SpriteID id, SpriteType sprite_ty
 	SpriteLoader::Sprite sprite[ZOOM_LVL_COUNT];
 	uint8 sprite_avail = 0;
 	sprite[ZOOM_LVL_NORMAL].type = sprite_type;
+	for (ZoomLevel zoom = ZOOM_LVL_BEGIN; zoom != ZOOM_LVL_END; zoom++) sprite[zoom].buffers = buffers;
 
+	FioBeginCritical();
 	SpriteLoaderGrf sprite_loader(sc->container_ver);
 	if (sprite_type != ST_MAPGEN && BlitterFactoryBase::GetCurrentBlitter()->GetScreenDepth() == 32) {
 		/* Try for 32bpp sprites first. */
@@ -397,11 +464,12 @@ static void *ReadSprite(const SpriteCache *sc, SpriteID id, SpriteType sprite_ty
 	if (sprite_avail == 0) {
 		sprite_avail = sprite_loader.LoadSprite(sprite, file_slot, file_pos, sprite_type, false);
 	}
+	FioEndCritical();
 
 	if (sprite_avail == 0) {
-		if (sprite_type == ST_MAPGEN) return NULL;
+		if (sprite_type == ST_MAPGEN || buffers != NULL) return NULL;
 		if (id == SPR_IMG_QUERY) usererror("Okay... something went horribly wrong. I couldn't load the fallback sprite. What should I do?");
-		return (void*)GetRawSprite(SPR_IMG_QUERY, ST_NORMAL, allocator);
+		return ReadFallbackSprite(allocator, zoom_levels);
 	}
 
 	if (sprite_type == ST_MAPGEN) {
@@ -433,12 +501,26 @@ static void *ReadSprite(const SpriteCache *sc, SpriteID id, SpriteType sprite_ty
 	}
 
 	if (sprite_type == ST_NORMAL) {
-		if (!ResizeSprites(sprite, sprite_avail, file_slot, sc->id)) {
+		if (!ResizeSprites(sprite, sprite_avail, file_slot, sc->id, zoom_levels)) {
+			if (buffers != NULL) return NULL;
 			if (id == SPR_IMG_QUERY) usererror("Okay... something went horribly wrong. I couldn't resize the fallback sprite. What should I do?");
-			return (void*)GetRawSprite(SPR_IMG_QUERY, ST_NORMAL, allocator);
+			return ReadFallbackSprite(allocator, zoom_levels);
 		}
 	}
-	return BlitterFactoryBase::GetCurrentBlitter()->Encode(sprite, allocator);
+	return BlitterFactoryBase::GetCurrentBlitter()->Encode(sprite, allocator, zoom_levels);
+}
+
+/**
+ * Read the sprite that is used instead of sprites that cannot be read.
+ * @param allocator   Allocator function to use.
+ * @param zoom_levels Bit mask of the zoom levels to encode the sprite for.
+ * @return Read sprite data.
+ */
+static void *ReadFallbackSprite(AllocatorProc *allocator, uint8 zoom_levels)
+{
+	const SpriteCache *sc = GetSpriteCache(SPR_IMG_QUERY);
+	if (sc->type != ST_NORMAL) usererror("Uhm, would you be so kind not to load a NewGRF that makes the 'query' sprite a non-normal sprite?");
+	return ReadSprite(sc, SPR_IMG_QUERY, ST_NORMAL, allocator, NULL, zoom_levels);
 }
 
 
@@ -542,14 +624,16 @@ bool LoadNextSprite(int load_index, byte file_slot, uint file_sprite_id, byte co
 	}
 
 	SpriteCache *sc = AllocateSpriteCache(load_index);
+	if (sc->ptr != NULL) DeleteEntryFromSpriteCache(load_index);
 	sc->file_slot = file_slot;
 	sc->file_pos = file_pos;
 	sc->ptr = data;
-	sc->lru = 0;
 	sc->id = file_sprite_id;
 	sc->type = type;
 	sc->warned = false;
 	sc->container_ver = container_version;
+	/* Only recolour sprites are read right away; they are only used at the normal zoom level. */
+	sc->zoom_levels = data != NULL ? 1 << ZOOM_LVL_NORMAL : 0;
 
 	return true;
 }
@@ -560,6 +644,7 @@ void DupSprite(SpriteID old_spr, SpriteID new_spr)
 	SpriteCache *scnew = AllocateSpriteCache(new_spr); // may reallocate: so put it first
 	SpriteCache *scold = GetSpriteCache(old_spr);
 
+	if (scnew->ptr != NULL) DeleteEntryFromSpriteCache(new_spr);
 	scnew->file_slot = scold->file_slot;
 	scnew->file_pos = scold->file_pos;
 	scnew->ptr = NULL;
@@ -567,109 +652,185 @@ void DupSprite(SpriteID old_spr, SpriteID new_spr)
 	scnew->type = scold->type;
 	scnew->warned = false;
 	scnew->container_ver = scold->container_ver;
+	scnew->zoom_levels = 0;
 }
 
 /**
- * S_FREE_MASK is used to mask-out lower bits of MemBlock::size
- * If they are non-zero, the block is free.
- * S_FREE_MASK has to ensure MemBlock is correctly aligned -
- * it means 8B (S_FREE_MASK == 7) on 64bit systems!
+ * Get the size class for blocks of the given size.
+ * The block sizes of the classes grow in #SIZE_CLASS_STEPS steps per doubling,
+ * so at most a fifth of a block is wasted by rounding up to its size class.
+ * @param size Size of the block, including its header; at most #MAX_BLOCK_SIZE.
+ * @return The size class.
  */
-static const size_t S_FREE_MASK = sizeof(size_t) - 1;
+static uint GetSizeClass(size_t size)
+{
+	assert(size <= MAX_BLOCK_SIZE);
+	if (size <= MIN_BLOCK_SIZE) return 0;
 
-/* to make sure nobody adds things to MemBlock without checking S_FREE_MASK first */
-assert_compile(sizeof(MemBlock) == sizeof(size_t));
-/* make sure it's a power of two */
-assert_compile((sizeof(size_t) & (sizeof(size_t) - 1)) == 0);
+	uint bit = FindLastBit(size - 1);
+	size_t step = (size_t)1 << (bit - 2);
+	return (bit - FindLastBit(MIN_BLOCK_SIZE)) * SIZE_CLASS_STEPS + (uint)((size - 1 - ((size_t)1 << bit)) / step) + 1;
+}
 
-static inline MemBlock *NextBlock(MemBlock *block)
+/**
+ * Get the size of the blocks of a size class.
+ * @param size_class The size class.
+ * @return Size of the blocks, including their header.
+ */
+static size_t GetSizeClassBlockSize(uint size_class)
 {
-	return (MemBlock*)((byte*)block + (block->size & ~S_FREE_MASK));
+	if (size_class == 0) return MIN_BLOCK_SIZE;
+
+	uint bit = FindLastBit(MIN_BLOCK_SIZE) + (size_class - 1) / SIZE_CLASS_STEPS;
+	return ((size_t)1 << bit) + ((size_class - 1) % SIZE_CLASS_STEPS + 1) * ((size_t)1 << (bit - 2));
 }
 
-static size_t GetSpriteCacheUsage()
-{
-	size_t tot_size = 0;
-	MemBlock *s;
+assert_compile(MAX_BLOCK_SIZE <= SPRITE_SLAB_SIZE / 8);
 
-	for (s = _spritecache_ptr; s->size != 0; s = NextBlock(s)) {
-		if (!(s->size & S_FREE_MASK)) tot_size += s->size;
+/**
+ * Remove a slab from the list of slabs with free blocks.
+ * @param slab The slab to remove.
+ */
+static void UnlinkSpriteSlab(SpriteSlab *slab)
+{
+	if (slab->prev != NULL) {
+		slab->prev->next = slab->next;
+	} else {
+		_spritecache_slabs[slab->size_class] = slab->next;
 	}
-
-	return tot_size;
+	if (slab->next != NULL) slab->next->prev = slab->prev;
 }
 
+/**
+ * Add a slab to the list of slabs with free blocks.
+ * @param slab The slab to add.
+ */
+static void LinkSpriteSlab(SpriteSlab *slab)
+{
+	slab->prev = NULL;
+	slab->next = _spritecache_slabs[slab->size_class];
+	if (slab->next != NULL) slab->next->prev = slab;
+	_spritecache_slabs[slab->size_class] = slab;
+}
 
-void IncreaseSpriteLRU()
+/**
+ * Allocate a block of memory for sprite data.
+ * @param size Size of the block, including its header.
+ * @return The block.
+ */
+static MemBlock *AllocMemBlock(size_t size)
 {
-	/* Increase all LRU values */
-	if (_sprite_lru_counter > 16384) {
-		SpriteID i;
+	if (size > MAX_BLOCK_SIZE) {
+		MemBlock *block = (MemBlock *)MallocT<byte>(size);
+		block->slab = NULL;
+		block->size = size;
+		_spritecache_stats.allocated += size;
+		return block;
+	}
 
-		DEBUG(sprite, 3, "Fixing lru %u, inuse=" PRINTF_SIZE, _sprite_lru_counter, GetSpriteCacheUsage());
+	uint size_class = GetSizeClass(size);
+	size_t block_size = GetSizeClassBlockSize(size_class);
 
-		for (i = 0; i != _spritecache_items; i++) {
-			SpriteCache *sc = GetSpriteCache(i);
-			if (sc->ptr != NULL) {
-				if (sc->lru >= 0) {
-					sc->lru = -1;
-				} else if (sc->lru != -32768) {
-					sc->lru--;
-				}
-			}
-		}
-		_sprite_lru_counter = 0;
+	SpriteSlab *slab = _spritecache_slabs[size_class];
+	if (slab == NULL) {
+		slab = CallocT<SpriteSlab>(1);
+		slab->mem = MallocT<byte>(SPRITE_SLAB_SIZE);
+		slab->size_class = size_class;
+		LinkSpriteSlab(slab);
+		_spritecache_stats.allocated += SPRITE_SLAB_SIZE;
 	}
 
-	/* Compact sprite cache every now and then. */
-	if (++_compact_cache_counter >= 740) {
-		CompactSpriteCache();
-		_compact_cache_counter = 0;
+	MemBlock *block;
+	if (slab->free_blocks != NULL) {
+		block = slab->free_blocks;
+		slab->free_blocks = *(MemBlock **)block->data;
+	} else {
+		block = (MemBlock *)(slab->mem + slab->num_carved * block_size);
+		slab->num_carved++;
 	}
+	slab->num_used++;
+
+	/* Once full, the slab is of no use for allocating anymore. */
+	if (slab->free_blocks == NULL && (slab->num_carved + 1) * block_size > SPRITE_SLAB_SIZE) UnlinkSpriteSlab(slab);
+
+	block->slab = slab;
+	block->size = block_size;
+	return block;
 }
 
 /**
- * Called when holes in the sprite cache should be removed.
- * That is accomplished by moving the cached data.
+ * Free a block of sprite data.
+ * Slabs without any used blocks are given back, so other size classes can use the memory.
+ * @param block The block to free.
  */
-static void CompactSpriteCache()
+static void FreeMemBlock(MemBlock *block)
 {
-	MemBlock *s;
-
-	DEBUG(sprite, 3, "Compacting sprite cache, inuse=" PRINTF_SIZE, GetSpriteCacheUsage());
-
-	for (s = _spritecache_ptr; s->size != 0;) {
-		if (s->size & S_FREE_MASK) {
-			MemBlock *next = NextBlock(s);
-			MemBlock temp;
-			SpriteID i;
+	SpriteSlab *slab = block->slab;
+	if (slab == NULL) {
+		_spritecache_stats.allocated -= block->size;
+		free(block);
+		return;
+	}
 
-			/* Since free blocks are automatically coalesced, this should hold true. */
-			assert(!(next->size & S_FREE_MASK));
+	bool was_full = slab->free_blocks == NULL && (slab->num_carved + 1) * block->size > SPRITE_SLAB_SIZE;
 
-			/* If the next block is the sentinel block, we can safely return */
-			if (next->size == 0) break;
+	slab->num_used--;
+	if (slab->num_used == 0) {
+		if (!was_full) UnlinkSpriteSlab(slab);
+		_spritecache_stats.allocated -= SPRITE_SLAB_SIZE;
+		free(slab->mem);
+		free(slab);
+		return;
+	}
 
-			/* Locate the sprite belonging to the next pointer. */
-			for (i = 0; GetSpriteCache(i)->ptr != next->data; i++) {
-				assert(i != _spritecache_items);
-			}
+	*(MemBlock **)block->data = slab->free_blocks;
+	slab->free_blocks = block;
+	if (was_full) LinkSpriteSlab(slab);
+}
 
-			GetSpriteCache(i)->ptr = s->data; // Adjust sprite array entry
-			/* Swap this and the next block */
-			temp = *s;
-			memmove(s, next, next->size);
-			s = NextBlock(s);
-			*s = temp;
+/**
+ * Remove a sprite from the LRU list.
+ * @param item The sprite to remove; it must be in the list.
+ */
+static void UnlinkSpriteLRU(SpriteID item)
+{
+	SpriteCache *sc = GetSpriteCache(item);
+	if (sc->lru_prev != SPRITE_LRU_END) {
+		GetSpriteCache(sc->lru_prev)->lru_next = sc->lru_next;
+	} else {
+		_spritecache_lru_first = sc->lru_next;
+	}
+	if (sc->lru_next != SPRITE_LRU_END) {
+		GetSpriteCache(sc->lru_next)->lru_prev = sc->lru_prev;
+	} else {
+		_spritecache_lru_last = sc->lru_prev;
+	}
+}
 
-			/* Coalesce free blocks */
-			while (NextBlock(s)->size & S_FREE_MASK) {
-				s->size += NextBlock(s)->size & ~S_FREE_MASK;
-			}
-		} else {
-			s = NextBlock(s);
-		}
+/**
+ * Add a sprite to the LRU list as most recently used sprite.
+ * @param item The sprite to add; it must not be in the list.
+ */
+static void LinkSpriteLRU(SpriteID item)
+{
+	SpriteCache *sc = GetSpriteCache(item);
+	sc->lru_prev = SPRITE_LRU_END;
+	sc->lru_next = _spritecache_lru_first;
+	if (_spritecache_lru_first != SPRITE_LRU_END) {
+		GetSpriteCache(_spritecache_lru_first)->lru_prev = item;
+	} else {
+		_spritecache_lru_last = item;
 	}
+	_spritecache_lru_first = item;
+}
+
+/**
+ * Get the statistics of the sprite cache.
+ * @return The statistics.
+ */
+const SpriteCacheStats &GetSpriteCacheStats()
+{
+	return _spritecache_stats;
 }
 
 /**
@@ -678,80 +839,47 @@ static void CompactSpriteCache()
  */
 static void DeleteEntryFromSpriteCache(uint item)
 {
-	/* Mark the block as free (the block must be in use) */
-	MemBlock *s = (MemBlock*)GetSpriteCache(item)->ptr - 1;
-	assert(!(s->size & S_FREE_MASK));
-	s->size |= S_FREE_MASK;
-	GetSpriteCache(item)->ptr = NULL;
-
-	/* And coalesce adjacent free blocks */
-	for (s = _spritecache_ptr; s->size != 0; s = NextBlock(s)) {
-		if (s->size & S_FREE_MASK) {
-			while (NextBlock(s)->size & S_FREE_MASK) {
-				s->size += NextBlock(s)->size & ~S_FREE_MASK;
-			}
-		}
-	}
+	SpriteCache *sc = GetSpriteCache(item);
+	assert(sc->ptr != NULL);
+
+	/* Recolour sprites are never evicted, so they are not in the LRU list. */
+	if (sc->type != ST_RECOLOUR) UnlinkSpriteLRU(item);
+
+	MemBlock *block = (MemBlock *)sc->ptr - 1;
+	_spritecache_stats.used -= block->size;
+	FreeMemBlock(block);
+	sc->ptr = NULL;
+	_sprite_cache_generation++;
 }
 
+/** Delete the least recently used entry from the sprite cache. */
 static void DeleteEntryFromSpriteCache()
 {
-	uint best = UINT_MAX;
-	int cur_lru;
-
-	DEBUG(sprite, 3, "DeleteEntryFromSpriteCache, inuse=" PRINTF_SIZE, GetSpriteCacheUsage());
-
-	cur_lru = 0xffff;
-	for (SpriteID i = 0; i != _spritecache_items; i++) {
-		SpriteCache *sc = GetSpriteCache(i);
-		if (sc->type != ST_RECOLOUR && sc->ptr != NULL && sc->lru < cur_lru) {
-			cur_lru = sc->lru;
-			best = i;
-		}
-	}
-
 	/* Display an error message and die, in case we found no sprite at all.
 	 * This shouldn't really happen, unless all sprites are locked. */
-	if (best == UINT_MAX) error("Out of sprite memory");
+	if (_spritecache_lru_last == SPRITE_LRU_END) error("Out of sprite memory");
+
+	DEBUG(sprite, 3, "DeleteEntryFromSpriteCache, inuse=" PRINTF_SIZE, _spritecache_stats.used);
 
-	DeleteEntryFromSpriteCache(best);
+	_spritecache_stats.evictions++;
+	DeleteEntryFromSpriteCache(_spritecache_lru_last);
 }
 
 static void *AllocSprite(size_t mem_req)
 {
 	mem_req += sizeof(MemBlock);
+	if (mem_req <= MAX_BLOCK_SIZE) mem_req = GetSizeClassBlockSize(GetSizeClass(mem_req));
 
-	/* Align this to correct boundary. This also makes sure at least one
-	 * bit is not used, so we can use it for other things. */
-	mem_req = Align(mem_req, S_FREE_MASK + 1);
-
-	for (;;) {
-		MemBlock *s;
-
-		for (s = _spritecache_ptr; s->size != 0; s = NextBlock(s)) {
-			if (s->size & S_FREE_MASK) {
-				size_t cur_size = s->size & ~S_FREE_MASK;
-
-				/* Is the block exactly the size we need or
-				 * big enough for an additional free block? */
-				if (cur_size == mem_req ||
-						cur_size >= mem_req + sizeof(MemBlock)) {
-					/* Set size and in use */
-					s->size = mem_req;
-
-					/* Do we need to inject a free block too? */
-					if (cur_size != mem_req) {
-						NextBlock(s)->size = (cur_size - mem_req) | S_FREE_MASK;
-					}
-
-					return s->data;
-				}
-			}
-		}
-
-		/* Reached sentinel, but no block found yet. Delete some old entry. */
+	/* Keep the cached data within the size of the sprite cache. Partly
+	 * used slabs are not counted, so more memory than that may be
+	 * allocated; evicting sprites does not reliably free slabs. */
+	while (_spritecache_stats.used + mem_req > _sprite_cache_size * 1024 * 1024) {
 		DeleteEntryFromSpriteCache();
 	}
+
+	MemBlock *block = AllocMemBlock(mem_req);
+	_spritecache_stats.used += block->size;
+	return block->data;
 }
 
 /**
@@ -760,10 +888,12 @@ static void *AllocSprite(size_t mem_req)
  * @param sprite ID of loaded sprite
  * @param requested requested sprite type
  * @param sc the currently known sprite cache for the requested sprite
+ * @param allocator Allocator function to use.
+ * @param zoom Zoom level the sprite is drawn at, see #GetRawSprite.
  * @return fallback sprite
  * @note this function will do usererror() in the case the fallback sprite isn't available
  */
-static void *HandleInvalidSpriteRequest(SpriteID sprite, SpriteType requested, SpriteCache *sc, AllocatorProc *allocator)
+static void *HandleInvalidSpriteRequest(SpriteID sprite, SpriteType requested, SpriteCache *sc, AllocatorProc *allocator, ZoomLevel zoom)
 {
 	static const char * const sprite_types[] = {
 		"normal",        // ST_NORMAL
@@ -775,7 +905,7 @@ static void *HandleInvalidSpriteRequest(SpriteID sprite, SpriteType requested, S
 	SpriteType available = sc->type;
 	if (requested == ST_FONT && available == ST_NORMAL) {
 		if (sc->ptr == NULL) sc->type = ST_FONT;
-		return GetRawSprite(sprite, sc->type, allocator);
+		return GetRawSprite(sprite, sc->type, allocator, zoom);
 	}
 
 	byte warning_level = sc->warned ? 6 : 0;
@@ -787,7 +917,7 @@ static void *HandleInvalidSpriteRequest(SpriteID sprite, SpriteType requested, S
 			if (sprite == SPR_IMG_QUERY) usererror("Uhm, would you be so kind not to load a NewGRF that makes the 'query' sprite a non-normal sprite?");
 			/* FALL THROUGH */
 		case ST_FONT:
-			return GetRawSprite(SPR_IMG_QUERY, ST_NORMAL, allocator);
+			return GetRawSprite(SPR_IMG_QUERY, ST_NORMAL, allocator, zoom);
 		case ST_RECOLOUR:
 			if (sprite == PALETTE_TO_DARK_BLUE) usererror("Uhm, would you be so kind not to load a NewGRF that makes the 'PALETTE_TO_DARK_BLUE' sprite a non-remap sprite?");
 			return GetRawSprite(PALETTE_TO_DARK_BLUE, ST_RECOLOUR, allocator);
@@ -799,15 +929,32 @@ static void *HandleInvalidSpriteRequest(SpriteID sprite, SpriteType requested, S
 	}
 }
 
+/**
+ * Get the zoom levels a sprite has to be encoded for, to draw it at the given zoom level.
+ * @param type Type of the sprite.
+ * @param zoom Zoom level the sprite is drawn at.
+ * @return Bit mask of the zoom levels.
+ */
+static uint8 GetEncodeZoomLevels(SpriteType type, ZoomLevel zoom)
+{
+	/* Only normal sprites are drawn zoomed out. */
+	if (type != ST_NORMAL) return 1 << ZOOM_LVL_NORMAL;
+	return BlitterFactoryBase::GetCurrentBlitter()->GetSpriteZoomLevels(zoom);
+}
+
 /**
  * Reads a sprite (from disk or sprite cache).
  * If the sprite is not available or of wrong type, a fallback sprite is returned.
+ * Sprites are only encoded for the zoom levels they are drawn at. When a
+ * sprite is only needed for its size, it is encoded for the zoom level
+ * sprites were last drawn at, if it has to be loaded.
  * @param sprite Sprite to read.
  * @param type Expected sprite type.
  * @param allocator Allocator function to use. Set to NULL to use the usual sprite cache.
+ * @param zoom Zoom level the sprite is going to be drawn at, or #ZOOM_LVL_END if only its size is needed.
  * @return Sprite raw data
  */
-void *GetRawSprite(SpriteID sprite, SpriteType type, AllocatorProc *allocator)
+void *GetRawSprite(SpriteID sprite, SpriteType type, AllocatorProc *allocator, ZoomLevel zoom)
 {
 	assert(IsMapgenSpriteID(sprite) == (type == ST_MAPGEN));
 	assert(type < ST_INVALID);
@@ -821,46 +968,314 @@ void *GetRawSprite(SpriteID sprite, SpriteType type, AllocatorProc *allocator)
 
 	SpriteCache *sc = GetSpriteCache(sprite);
 
-	if (sc->type != type) return HandleInvalidSpriteRequest(sprite, type, sc, allocator);
+	if (sc->type != type) return HandleInvalidSpriteRequest(sprite, type, sc, allocator, zoom);
 
 	if (allocator == NULL) {
 		/* Load sprite into/from spritecache */
 
-		/* Update LRU */
-		sc->lru = ++_sprite_lru_counter;
+		if (type == ST_RECOLOUR) {
+			/* Recolour sprites are never evicted, so they are not in the LRU list. */
+			if (sc->ptr != NULL) {
+				_spritecache_stats.hits++;
+				return sc->ptr;
+			}
+			_spritecache_stats.misses++;
+			sc->zoom_levels = GetEncodeZoomLevels(type, ZOOM_LVL_NORMAL);
+			sc->ptr = ReadSprite(sc, sprite, type, AllocSprite, NULL, sc->zoom_levels);
+			return sc->ptr;
+		}
+
+		sc->used_frame = _sprite_cache_frame;
+
+		uint8 zoom_levels;
+		if (zoom == ZOOM_LVL_END) {
+			/* Any zoom level will do. */
+			zoom_levels = sc->ptr != NULL ? sc->zoom_levels : GetEncodeZoomLevels(type, _sprite_cache_last_zoom);
+		} else {
+			zoom_levels = GetEncodeZoomLevels(type, zoom);
+			_sprite_cache_last_zoom = zoom;
+		}
+
+		if (sc->ptr != NULL) {
+			if ((sc->zoom_levels & zoom_levels) == zoom_levels) {
+				/* Move it to the front of the LRU list */
+				_spritecache_stats.hits++;
+				if (_spritecache_lru_first != sprite) {
+					UnlinkSpriteLRU(sprite);
+					LinkSpriteLRU(sprite);
+				}
+				return sc->ptr;
+			}
+
+			/* It is not encoded for this zoom level yet; so encode it
+			 * again for this zoom level and the ones it already had. */
+			zoom_levels |= sc->zoom_levels;
+			DeleteEntryFromSpriteCache(sprite);
+		}
 
-		/* Load the sprite, if it is not loaded, yet */
-		if (sc->ptr == NULL) sc->ptr = ReadSprite(sc, sprite, type, AllocSprite);
+		/* Load the sprite, as it is not loaded, yet. Do not wait for
+		 * a decoder thread; if it is busy with it, its result gets
+		 * thrown away. */
+		if (sc->queued) CancelSpriteDecode(sprite);
+		_spritecache_stats.misses++;
+		sc->ptr = ReadSprite(sc, sprite, type, AllocSprite, NULL, zoom_levels);
+		sc->zoom_levels = zoom_levels;
+		if (sc->ptr != NULL) LinkSpriteLRU(sprite);
 
 		return sc->ptr;
 	} else {
+		uint8 zoom_levels = GetEncodeZoomLevels(type, zoom == ZOOM_LVL_END ? _sprite_cache_last_zoom : zoom);
+
 		/* Do not use the spritecache, but a different allocator. */
-		return ReadSprite(sc, sprite, type, allocator);
+		return ReadSprite(sc, sprite, type, allocator, NULL, zoom_levels);
+	}
+}
+
+
+/** A sprite to be decoded by a sprite decoder thread. */
+struct SpriteDecodeJob {
+	SpriteID id;       ///< The sprite to decode.
+	SpriteCache sc;    ///< Copy of the cache entry of the sprite, with its location.
+	uint8 zoom_levels; ///< Bit mask of the zoom levels to encode the sprite for.
+	void *data;        ///< The decoded sprite, allocated by #DecoderAllocSprite, or \c NULL if it could not be decoded.
+};
+
+static const uint MAX_SPRITE_DECODERS = 4; ///< Maximum number of sprite decoder threads.
+
+static ThreadMutex *_sprite_decoder_mutex = NULL;                 ///< Guards the job lists and #_sprite_decoders_busy.
+static SmallVector<SpriteDecodeJob *, 64> _sprite_decode_queue;   ///< Jobs waiting for a decoder thread; the last one is taken first.
+static SmallVector<SpriteDecodeJob *, 64> _sprite_decode_done;    ///< Jobs that have been decoded, but are not in the cache yet.
+static uint _sprite_decoders = 0;                                  ///< Number of running sprite decoder threads.
+static uint _sprite_decoders_busy = 0;                             ///< Number of jobs that are being decoded.
+static bool _sprite_decoders_started = false;                      ///< Whether starting the sprite decoder threads has been tried.
+
+/**
+ * Allocate memory for a sprite decoded by a sprite decoder thread.
+ * The sprite cache itself may only be used by the main thread.
+ * @param mem_req Number of bytes to allocate.
+ * @return The allocated memory.
+ */
+static void *DecoderAllocSprite(size_t mem_req)
+{
+	MemBlock *block = (MemBlock *)MallocT<byte>(sizeof(MemBlock) + mem_req);
+	block->slab = NULL;
+	block->size = sizeof(MemBlock) + mem_req;
+	return block->data;
+}
+
+/**
+ * Free a job of a sprite decoder thread, including the decoded sprite.
+ * @param job The job to free.
+ */
+static void FreeSpriteDecodeJob(SpriteDecodeJob *job)
+{
+	if (job->data != NULL) free((MemBlock *)job->data - 1);
+	free(job);
+}
+
+/**
+ * Main loop of a sprite decoder thread.
+ * Reading the GRF is done one thread at a time, but the
+ * resizing and encoding of sprites happens in parallel.
+ */
+static void SpriteDecoderThread(void *)
+{
+	ReusableBuffer<SpriteLoader::CommonPixel> buffers[ZOOM_LVL_COUNT];
+
+	_sprite_decoder_mutex->BeginCritical();
+	for (;;) {
+		while (_sprite_decode_queue.Length() == 0) _sprite_decoder_mutex->WaitForSignal();
+
+		SpriteDecodeJob *job = *(_sprite_decode_queue.End() - 1);
+		_sprite_decode_queue.Erase(_sprite_decode_queue.End() - 1);
+		_sprite_decoders_busy++;
+		_sprite_decoder_mutex->EndCritical();
+
+		job->data = ReadSprite(&job->sc, job->id, ST_NORMAL, &DecoderAllocSprite, buffers, job->zoom_levels);
+
+		_sprite_decoder_mutex->BeginCritical();
+		*_sprite_decode_done.Append() = job;
+		_sprite_decoders_busy--;
+	}
+}
+
+/** Start the sprite decoder threads. */
+static void StartSpriteDecoders()
+{
+	_sprite_decoders_started = true;
+	_sprite_decoder_mutex = ThreadMutex::New();
+
+	/* Leave a core for the game itself. */
+	uint num = ClampU(GetCPUCoreCount() - 1, 1, MAX_SPRITE_DECODERS);
+	while (_sprite_decoders < num && ThreadObject::New(&SpriteDecoderThread, NULL)) _sprite_decoders++;
+
+	DEBUG(sprite, 1, "Started %u sprite decoder threads", _sprite_decoders);
+}
+
+/**
+ * Check whether sprites can be decoded in the background, starting the sprite decoder threads when needed.
+ * While there is modal progress, e.g. a threaded NewGRF scan that reads files
+ * without the Fio lock, no sprites are decoded in the background.
+ * @return True iff there are sprite decoder threads that may be given work.
+ */
+bool HasSpriteDecoders()
+{
+	if (!_sprite_decoders_started) StartSpriteDecoders();
+	return _sprite_decoders != 0 && !HasModalProgress();
+}
+
+/**
+ * Request a sprite to be decoded in the background, as it is likely to be drawn soon.
+ * Only normal sprites that are not in the cache yet, or not for the zoom level, are decoded.
+ * @param sprite The sprite to decode.
+ * @param zoom   The zoom level the sprite is likely to be drawn at.
+ */
+void PrefetchSprite(SpriteID sprite, ZoomLevel zoom)
+{
+	if (!SpriteExists(sprite)) return;
+
+	SpriteCache *sc = GetSpriteCache(sprite);
+	if (sc->queued || sc->type != ST_NORMAL) return;
+
+	uint8 zoom_levels = GetEncodeZoomLevels(ST_NORMAL, zoom);
+	if (sc->ptr != NULL) {
+		if ((sc->zoom_levels & zoom_levels) == zoom_levels) return;
+		zoom_levels |= sc->zoom_levels;
 	}
+
+	if (!HasSpriteDecoders()) return;
+
+	SpriteDecodeJob *job = MallocT<SpriteDecodeJob>(1);
+	job->id = sprite;
+	job->sc = *sc;
+	job->zoom_levels = zoom_levels;
+	job->data = NULL;
+	sc->queued = true;
+
+	_sprite_decoder_mutex->BeginCritical();
+	*_sprite_decode_queue.Append() = job;
+	_sprite_decoder_mutex->SendSignal();
+	_sprite_decoder_mutex->EndCritical();
 }
 
+/**
+ * Take a sprite out of the queue of the sprite decoder threads, if it has not been taken yet.
+ * @param sprite The sprite.
+ */
+static void CancelSpriteDecode(SpriteID sprite)
+{
+	_sprite_decoder_mutex->BeginCritical();
+	for (SpriteDecodeJob **job = _sprite_decode_queue.Begin(); job != _sprite_decode_queue.End(); job++) {
+		if ((*job)->id != sprite) continue;
+
+		FreeSpriteDecodeJob(*job);
+		_sprite_decode_queue.Erase(job);
+		GetSpriteCache(sprite)->queued = false;
+		break;
+	}
+	_sprite_decoder_mutex->EndCritical();
+}
 
-static void GfxInitSpriteCache()
+/**
+ * Put the sprites decoded by the sprite decoder threads in the sprite cache.
+ * Sprites that have been requested in this or the previous frame are not
+ * evicted for them; when that would be needed the decoded sprite is dropped.
+ * A decoded sprite replaces a cached one, when it is encoded for at least
+ * the same zoom levels and fits in the sprite cache; otherwise the cached
+ * one is kept.
+ * Must be called once per frame.
+ */
+void ProcessDecodedSprites()
 {
-	/* initialize sprite cache heap */
-	if (_spritecache_ptr == NULL) _spritecache_ptr = (MemBlock*)MallocT<byte>(_sprite_cache_size * 1024 * 1024);
+	_sprite_cache_frame++;
+	if (_sprite_decoders == 0) return;
+
+	_sprite_decoder_mutex->BeginCritical();
+	for (SpriteDecodeJob **it = _sprite_decode_done.Begin(); it != _sprite_decode_done.End(); it++) {
+		SpriteDecodeJob *job = *it;
+		SpriteCache *sc = GetSpriteCache(job->id);
+		sc->queued = false;
+
+		bool replace = sc->ptr != NULL && (sc->zoom_levels & job->zoom_levels) == sc->zoom_levels;
+
+		if (job->data != NULL && (sc->ptr == NULL || replace)) {
+			size_t size = ((MemBlock *)job->data - 1)->size - sizeof(MemBlock);
+			size_t block_size = sizeof(MemBlock) + size;
+			if (block_size <= MAX_BLOCK_SIZE) block_size = GetSizeClassBlockSize(GetSizeClass(block_size));
+
+			/* The block of the replaced sprite is only freed once the decoded one is sure to fit. */
+			size_t freed = replace ? ((MemBlock *)sc->ptr - 1)->size : 0;
+			size_t limit = _sprite_cache_size * 1024 * 1024 + freed;
+
+			while (_spritecache_stats.used + block_size > limit && _spritecache_lru_last != SPRITE_LRU_END && _spritecache_lru_last != job->id &&
+					(uint16)(_sprite_cache_frame - GetSpriteCache(_spritecache_lru_last)->used_frame) > 1) {
+				_spritecache_stats.evictions++;
+				DeleteEntryFromSpriteCache(_spritecache_lru_last);
+			}
+
+			if (_spritecache_stats.used + block_size <= limit) {
+				if (replace) DeleteEntryFromSpriteCache(job->id);
+				sc->ptr = AllocSprite(size);
+				sc->zoom_levels = job->zoom_levels;
+				memcpy(sc->ptr, job->data, size);
+				sc->used_frame = _sprite_cache_frame;
+				LinkSpriteLRU(job->id);
+				_spritecache_stats.prefetched++;
+			}
+		}
 
-	/* A big free block */
-	_spritecache_ptr->size = ((_sprite_cache_size * 1024 * 1024) - sizeof(MemBlock)) | S_FREE_MASK;
-	/* Sentinel block (identified by size == 0) */
-	NextBlock(_spritecache_ptr)->size = 0;
+		FreeSpriteDecodeJob(job);
+	}
+	_sprite_decode_done.Clear();
+	_sprite_decoder_mutex->EndCritical();
+}
+
+/**
+ * Throw away all work of the sprite decoder threads, and wait for the
+ * sprites they are decoding. Needed whenever the sprites they decode
+ * would become invalid, the sprite cache entries are freed or the GRFs
+ * are closed.
+ */
+void FlushSpriteDecoders()
+{
+	if (_sprite_decoders == 0) return;
+
+	_sprite_decoder_mutex->BeginCritical();
+	for (uint i = 0; i < _sprite_decode_queue.Length(); i++) {
+		GetSpriteCache(_sprite_decode_queue[i]->id)->queued = false;
+		FreeSpriteDecodeJob(_sprite_decode_queue[i]);
+	}
+	_sprite_decode_queue.Clear();
+
+	while (_sprite_decoders_busy != 0) {
+		_sprite_decoder_mutex->EndCritical();
+		CSleep(1);
+		_sprite_decoder_mutex->BeginCritical();
+	}
+
+	for (uint i = 0; i < _sprite_decode_done.Length(); i++) {
+		GetSpriteCache(_sprite_decode_done[i]->id)->queued = false;
+		FreeSpriteDecodeJob(_sprite_decode_done[i]);
+	}
+	_sprite_decode_done.Clear();
+	_sprite_decoder_mutex->EndCritical();
 }
 
 void GfxInitSpriteMem()
 {
-	GfxInitSpriteCache();
+	FlushSpriteDecoders();
 
 	/* Reset the spritecache 'pool' */
+	for (uint i = 0; i != _spritecache_items; i++) {
+		if (GetSpriteCache(i)->ptr != NULL) DeleteEntryFromSpriteCache(i);
+	}
+	assert(_spritecache_lru_first == SPRITE_LRU_END && _spritecache_stats.used == 0);
+
 	free(_spritecache);
 	_spritecache_items = 0;
 	_spritecache = NULL;
 
-	_compact_cache_counter = 0;
+	_sprite_cache_generation++;
 }
 
 /**
@@ -869,11 +1284,10 @@ void GfxInitSpriteMem()
  */
 void GfxClearSpriteCache()
 {
-	/* Clear sprite ptr for all cached items */
-	for (uint i = 0; i != _spritecache_items; i++) {
-		SpriteCache *sc = GetSpriteCache(i);
-		if (sc->type != ST_RECOLOUR && sc->ptr != NULL) DeleteEntryFromSpriteCache(i);
-	}
+	FlushSpriteDecoders();
+
+	/* Recolour sprites are not in the LRU list, so they are kept */
+	while (_spritecache_lru_first != SPRITE_LRU_END) DeleteEntryFromSpriteCache(_spritecache_lru_first);
 }
 
 /* static */ ReusableBuffer<SpriteLoader::CommonPixel> SpriteLoader::Sprite::buffer[ZOOM_LVL_COUNT];
@@ -23,11 +23,22 @@ struct Sprite {
 	byte data[];   ///< Sprite data.
 };
 
+/** Statistics about the use of the sprite cache. */
+struct SpriteCacheStats {
+	uint64 hits;       ///< Number of requests for sprites that were in the cache.
+	uint64 misses;     ///< Number of requests for sprites that had to be loaded.
+	uint64 evictions;  ///< Number of sprites removed from the cache to make room for other sprites.
+	uint64 prefetched; ///< Number of sprites decoded in the background and put in the cache.
+	size_t used;       ///< Number of bytes used by cached sprites.
+	size_t allocated;  ///< Number of bytes allocated for the cache, including unused parts of its slabs.
+};
+
 extern uint _sprite_cache_size;
+extern uint _sprite_cache_generation;
 
 typedef void *AllocatorProc(size_t size);
 
-void *GetRawSprite(SpriteID sprite, SpriteType type, AllocatorProc *allocator = NULL);
+void *GetRawSprite(SpriteID sprite, SpriteType type, AllocatorProc *allocator = NULL, ZoomLevel zoom = ZOOM_LVL_END);
 bool SpriteExists(SpriteID sprite);
 
 SpriteType GetSpriteType(SpriteID sprite);
@@ -35,10 +46,17 @@ uint GetOriginFileSlot(SpriteID sprite);
 uint GetMaxSpriteID();
 
 
-static inline const Sprite *GetSprite(SpriteID sprite, SpriteType type)
+/**
+ * Get the data of a sprite.
+ * @param sprite The sprite.
+ * @param type   Type of the sprite.
+ * @param zoom   Zoom level the sprite is going to be drawn at, or #ZOOM_LVL_END if only its size is needed.
+ * @return The sprite data.
+ */
+static inline const Sprite *GetSprite(SpriteID sprite, SpriteType type, ZoomLevel zoom = ZOOM_LVL_END)
 {
 	assert(type != ST_RECOLOUR);
-	return (Sprite*)GetRawSprite(sprite, type);
+	return (Sprite*)GetRawSprite(sprite, type, NULL, zoom);
 }
 
 static inline const byte *GetNonSprite(SpriteID sprite, SpriteType type)
@@ -49,7 +67,12 @@ static inline const byte *GetNonSprite(SpriteID sprite, SpriteType type)
 
 void GfxInitSpriteMem();
 void GfxClearSpriteCache();
-void IncreaseSpriteLRU();
+const SpriteCacheStats &GetSpriteCacheStats();
+
+bool HasSpriteDecoders();
+void PrefetchSprite(SpriteID sprite, ZoomLevel zoom);
+void ProcessDecodedSprites();
+void FlushSpriteDecoders();
 
 void ReadGRFSpriteOffsets(byte container_version);
 size_t GetGRFSpriteOffset(uint32 id);
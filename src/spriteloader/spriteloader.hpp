@@ -32,6 +32,7 @@ public:
 	 * You can only use this struct once at a time when using AllocateData to
 	 * allocate the memory as that will always return the same memory address.
 	 * This to prevent thousands of malloc + frees just to load a sprite.
+	 * Other threads have to provide their own buffers.
 	 */
 	struct Sprite {
 		uint16 height;                   ///< Height of the sprite
@@ -40,13 +41,16 @@ public:
 		int16 y_offs;                    ///< The y-offset of where the sprite will be drawn
 		SpriteType type;                 ///< The sprite type
 		SpriteLoader::CommonPixel *data; ///< The sprite itself
+		ReusableBuffer<SpriteLoader::CommonPixel> *buffers; ///< Buffers per zoom level to allocate the data in, or \c NULL for the shared ones.
+
+		Sprite() : buffers(NULL) {}
 
 		/**
 		 * Allocate the sprite data of this sprite.
 		 * @param zoom Zoom level to allocate the data for.
 		 * @param size the minimum size of the data field.
 		 */
-		void AllocateData(ZoomLevel zoom, size_t size) { this->data = Sprite::buffer[zoom].ZeroAllocate(size); }
+		void AllocateData(ZoomLevel zoom, size_t size) { this->data = (this->buffers != NULL ? this->buffers : Sprite::buffer)[zoom].ZeroAllocate(size); }
 	private:
 		/** Allocated memory to pass sprite data around */
 		static ReusableBuffer<SpriteLoader::CommonPixel> buffer[ZOOM_LVL_COUNT];
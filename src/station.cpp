@@ -24,6 +24,7 @@
 #include "roadstop_base.h"
 #include "industry.h"
 #include "core/random_func.hpp"
+#include "economy_func.h"
 
 #include "table/strings.h"
 
@@ -60,6 +61,8 @@ Station::Station(TileIndex tile) :
 	last_vehicle_type(VEH_INVALID)
 {
 	/* this->random_bits is set in Station::AddFacility() */
+	this->catchment_cells.left = this->catchment_cells.top = 0;
+	this->catchment_cells.right = this->catchment_cells.bottom = -1;
 }
 
 /**
@@ -77,6 +80,9 @@ Station::~Station()
 		return;
 	}
 
+	Rect no_cells = { 0, 0, -1, -1 };
+	this->SetCatchmentCells(no_cells);
+
 	while (!this->loading_vehicles.empty()) {
 		this->loading_vehicles.front()->LeaveStation();
 	}
@@ -163,8 +169,10 @@ void Station::AddFacility(StationFacility new_facility_bit, TileIndex facil_xy)
 		this->xy = facil_xy;
 		this->random_bits = Random();
 	}
+	CountStationFacilities(this, -1);
 	this->facilities |= new_facility_bit;
 	this->owner = _current_company;
+	CountStationFacilities(this, 1);
 	this->build_date = _date;
 }
 
@@ -329,6 +337,8 @@ static bool FindIndustryToDeliver(TileIndex ind_tile, void *user_data)
  */
 void Station::RecomputeIndustriesNear()
 {
+	this->UpdateCatchmentIndex();
+
 	this->industries_near.Clear();
 	if (this->rect.IsEmpty()) return;
 
@@ -356,6 +366,125 @@ void Station::RecomputeIndustriesNear()
 	FOR_ALL_STATIONS(st) st->RecomputeIndustriesNear();
 }
 
+/************************************************************************/
+/*                     Catchment index implementation                   */
+/************************************************************************/
+
+/** Number of bits of a tile coordinate that select the tile within a cell of the catchment index. */
+static const uint CATCHMENT_CELL_BITS = 4;
+
+/** The stations whose catchment area might reach into a cell of the map. */
+typedef SmallVector<Station *, 4> CatchmentCell;
+
+static CatchmentCell *_catchment_index = NULL; ///< The cells of the catchment index, or NULL when no station has been added yet.
+static uint _catchment_index_size_x;           ///< Number of cells of the catchment index along the X axis.
+
+/**
+ * Get a cell of the catchment index.
+ * @param cx The X coordinate of the cell.
+ * @param cy The Y coordinate of the cell.
+ * @return The cell.
+ */
+static inline CatchmentCell *GetCatchmentCell(int cx, int cy)
+{
+	return &_catchment_index[cy * _catchment_index_size_x + cx];
+}
+
+/** Clear the catchment index, e.g. when the stations of a game are removed. */
+void InitializeStations()
+{
+	delete[] _catchment_index;
+	_catchment_index = NULL;
+}
+
+/**
+ * Move the station to other cells of the catchment index.
+ * @param cells The cells, in cell coordinates, the station should be in; left > right when it should be in none.
+ */
+void Station::SetCatchmentCells(const Rect &cells)
+{
+	if (memcmp(&cells, &this->catchment_cells, sizeof(cells)) == 0) return;
+
+	for (int cy = this->catchment_cells.top; cy <= this->catchment_cells.bottom; cy++) {
+		for (int cx = this->catchment_cells.left; cx <= this->catchment_cells.right; cx++) {
+			CatchmentCell *cell = GetCatchmentCell(cx, cy);
+			cell->Erase(cell->Find(this));
+		}
+	}
+
+	if (_catchment_index == NULL && cells.left <= cells.right) {
+		_catchment_index_size_x = MapSizeX() >> CATCHMENT_CELL_BITS;
+		_catchment_index = new CatchmentCell[_catchment_index_size_x * (MapSizeY() >> CATCHMENT_CELL_BITS)];
+	}
+
+	for (int cy = cells.top; cy <= cells.bottom; cy++) {
+		for (int cx = cells.left; cx <= cells.right; cx++) {
+			*GetCatchmentCell(cx, cy)->Append() = this;
+		}
+	}
+
+	this->catchment_cells = cells;
+}
+
+/**
+ * Update the cells of the catchment index this station is in after its
+ * tiles, its catchment radius or its location changed. The station is in
+ * the cells its catchment area reaches and in the cell of its location.
+ */
+void Station::UpdateCatchmentIndex()
+{
+	Rect cells = { 0, 0, -1, -1 };
+
+	if (!this->rect.IsEmpty()) {
+		int rad = _settings_game.station.modified_catchment ? this->GetCatchmentRadius() : (uint)CA_UNMODIFIED;
+		cells.left   = max<int>(this->rect.left   - rad, 0) >> CATCHMENT_CELL_BITS;
+		cells.top    = max<int>(this->rect.top    - rad, 0) >> CATCHMENT_CELL_BITS;
+		cells.right  = min<int>(this->rect.right  + rad, MapMaxX()) >> CATCHMENT_CELL_BITS;
+		cells.bottom = min<int>(this->rect.bottom + rad, MapMaxY()) >> CATCHMENT_CELL_BITS;
+	}
+
+	if (this->xy != INVALID_TILE) {
+		int cx = TileX(this->xy) >> CATCHMENT_CELL_BITS;
+		int cy = TileY(this->xy) >> CATCHMENT_CELL_BITS;
+		if (cells.left > cells.right) {
+			cells.left = cells.right = cx;
+			cells.top = cells.bottom = cy;
+		} else {
+			cells.left   = min(cells.left,   cx);
+			cells.top    = min(cells.top,    cy);
+			cells.right  = max(cells.right,  cx);
+			cells.bottom = max(cells.bottom, cy);
+		}
+	}
+
+	this->SetCatchmentCells(cells);
+}
+
+/**
+ * Get the stations whose catchment area or location might be within an area.
+ * The list is a superset of the stations that actually are, in no particular order.
+ * @param area     The area to get the stations for.
+ * @param stations The list to add the stations to.
+ */
+/* static */ void Station::GetCatchmentCandidates(const TileArea &area, StationList *stations)
+{
+	if (_catchment_index == NULL) return;
+
+	uint left   = TileX(area.tile) >> CATCHMENT_CELL_BITS;
+	uint top    = TileY(area.tile) >> CATCHMENT_CELL_BITS;
+	uint right  = min(TileX(area.tile) + area.w - 1, MapMaxX()) >> CATCHMENT_CELL_BITS;
+	uint bottom = min(TileY(area.tile) + area.h - 1, MapMaxY()) >> CATCHMENT_CELL_BITS;
+
+	for (uint cy = top; cy <= bottom; cy++) {
+		for (uint cx = left; cx <= right; cx++) {
+			const CatchmentCell *cell = GetCatchmentCell(cx, cy);
+			for (Station * const *st = cell->Begin(); st != cell->End(); st++) {
+				stations->Include(*st);
+			}
+		}
+	}
+}
+
 /************************************************************************/
 /*                     StationRect implementation                       */
 /************************************************************************/
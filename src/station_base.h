@@ -17,6 +17,7 @@
 #include "cargopacket.h"
 #include "industry_type.h"
 #include "newgrf_storage.h"
+#include <list>
 
 typedef Pool<BaseStation, StationID, 32, 64000> StationPool;
 extern StationPool _station_pool;
@@ -195,6 +196,15 @@ private:
 
 typedef SmallVector<Industry *, 2> IndustryVector;
 
+/** Cached acceptance of the tiles around a station, @see GetStationAcceptance() */
+struct StationAcceptanceCache {
+	Rect area;                               ///< Tiles the cache was made for.
+	uint32 generation;                       ///< Map generation the cache was made in, or 0 when there is no cache.
+	CargoArray acceptance;                   ///< Acceptance of the tiles whose acceptance only changes when the tile changes.
+	uint32 always_accepted;                  ///< Cargo types always accepted by those tiles.
+	SmallVector<TileIndex, 4> dynamic_tiles; ///< Tiles whose acceptance is determined by NewGRF callbacks, and thus can change at any time.
+};
+
 /** Station data structure */
 struct Station FINAL : SpecializedStation<Station, false> {
 public:
@@ -225,6 +235,8 @@ public:
 	uint32 always_accepted;       ///< Bitmask of always accepted cargo types (by houses, HQs, industry tiles when industry doesn't accept cargo)
 
 	IndustryVector industries_near; ///< Cached list of industries near the station that can accept cargo, @see DeliverGoodsToIndustry()
+	Rect catchment_cells;           ///< NOSAVE: Cells of the catchment index the station is in, @see UpdateCatchmentIndex()
+	StationAcceptanceCache acceptance_cache; ///< NOSAVE: Acceptance of the tiles around the station.
 
 	Station(TileIndex tile = INVALID_TILE);
 	~Station();
@@ -243,6 +255,9 @@ public:
 	uint GetCatchmentRadius() const;
 	Rect GetCatchmentRect() const;
 
+	void UpdateCatchmentIndex();
+	static void GetCatchmentCandidates(const TileArea &area, StationList *stations);
+
 	/* virtual */ inline bool TileBelongsToRailStation(TileIndex tile) const
 	{
 		return IsRailStationTile(tile) && GetStationIndex(tile) == this->index;
@@ -256,6 +271,9 @@ public:
 	/* virtual */ uint32 GetNewGRFVariable(const ResolverObject *object, byte variable, byte parameter, bool *available) const;
 
 	/* virtual */ void GetTileArea(TileArea *ta, StationType type) const;
+
+private:
+	void SetCatchmentCells(const Rect &cells);
 };
 
 #define FOR_ALL_STATIONS(var) FOR_ALL_BASE_STATIONS_OF_TYPE(Station, var)
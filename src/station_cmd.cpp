@@ -49,8 +49,11 @@
 #include "newgrf_airporttiles.h"
 #include "order_backup.h"
 #include "newgrf_house.h"
+#include "economy_func.h"
 #include "company_gui.h"
 #include "widgets/station_widget.h"
+#include "core/sort_func.hpp"
+#include "object_map.h"
 
 #include "table/strings.h"
 
@@ -535,6 +538,98 @@ CargoArray GetAcceptanceAroundTiles(TileIndex tile, int w, int h, int rad, uint3
 	return acceptance;
 }
 
+/**
+ * Check whether the acceptance of a tile can only change when the tile
+ * itself changes, i.e. when no NewGRF callback decides about it.
+ * @param tile The tile to check.
+ * @return true iff the acceptance of the tile can be cached.
+ */
+static bool IsTileAcceptanceCacheable(TileIndex tile)
+{
+	switch (GetTileType(tile)) {
+		case MP_HOUSE:
+			return (HouseSpec::Get(GetHouseType(tile))->callback_mask & (1 << CBM_HOUSE_ACCEPT_CARGO | 1 << CBM_HOUSE_CARGO_ACCEPTANCE)) == 0;
+
+		case MP_INDUSTRY:
+			return (GetIndustryTileSpec(GetIndustryGfx(tile))->callback_mask & (1 << CBM_INDT_ACCEPT_CARGO | 1 << CBM_INDT_CARGO_ACCEPTANCE)) == 0;
+
+		case MP_OBJECT:
+			/* The acceptance of the headquarters depends on its size. */
+			return !IsCompanyHQ(tile);
+
+		default:
+			return true;
+	}
+}
+
+/**
+ * Get the acceptance of the tiles around a station.
+ * The acceptance of tiles that can only change when the tiles themselves
+ * change is cached; the cache is made again once a tile in the blocks of
+ * the map around the station has changed.
+ * @param st              The station to get the acceptance for.
+ * @param always_accepted Bitmask of cargo accepted by houses and headquarters; can be NULL.
+ * @return The acceptance.
+ * @pre !st->rect.IsEmpty()
+ */
+static CargoArray GetStationAcceptance(Station *st, uint32 *always_accepted)
+{
+	StationAcceptanceCache *cache = &st->acceptance_cache;
+
+	/* The same tiles as GetAcceptanceAroundTiles() would look at. */
+	int rad = st->GetCatchmentRadius();
+	Rect area;
+	area.left   = max(st->rect.left - rad, 0);
+	area.top    = max(st->rect.top - rad, 0);
+	area.right  = min(st->rect.right + rad, (int)MapMaxX());
+	area.bottom = min(st->rect.bottom + rad, (int)MapMaxY());
+
+	bool valid = cache->generation != 0 && memcmp(&cache->area, &area, sizeof(area)) == 0;
+	for (int by = area.top >> MAP_BLOCK_BITS; valid && by <= area.bottom >> MAP_BLOCK_BITS; by++) {
+		for (int bx = area.left >> MAP_BLOCK_BITS; bx <= area.right >> MAP_BLOCK_BITS; bx++) {
+			if (_map_block_generation[MapBlockIndex(bx << MAP_BLOCK_BITS, by << MAP_BLOCK_BITS)] >= cache->generation) {
+				valid = false;
+				break;
+			}
+		}
+	}
+
+	if (!valid) {
+		cache->area = area;
+		cache->generation = NewMapGeneration();
+		cache->acceptance.Clear();
+		cache->always_accepted = 0;
+		cache->dynamic_tiles.Clear();
+
+		for (int y = area.top; y <= area.bottom; y++) {
+			for (int x = area.left; x <= area.right; x++) {
+				TileIndex tile = TileXY(x, y);
+				if (IsTileAcceptanceCacheable(tile)) {
+					AddAcceptedCargo(tile, cache->acceptance, &cache->always_accepted);
+				} else {
+					*cache->dynamic_tiles.Append() = tile;
+				}
+			}
+		}
+	}
+
+	CargoArray acceptance = cache->acceptance;
+	uint32 accepted = cache->always_accepted;
+	for (const TileIndex *tile = cache->dynamic_tiles.Begin(); tile != cache->dynamic_tiles.End(); tile++) {
+		AddAcceptedCargo(*tile, acceptance, &accepted);
+	}
+	if (always_accepted != NULL) *always_accepted = accepted;
+
+	return acceptance;
+}
+
+/** Forget the cached acceptance of all stations, e.g. when the NewGRFs or the map changed behind the back of the cache. */
+void InvalidateStationAcceptanceCaches()
+{
+	Station *st;
+	FOR_ALL_STATIONS(st) st->acceptance_cache.generation = 0;
+}
+
 /**
  * Update the acceptance for a station.
  * @param st Station to update
@@ -548,13 +643,7 @@ void UpdateStationAcceptance(Station *st, bool show_msg)
 	/* And retrieve the acceptance. */
 	CargoArray acceptance;
 	if (!st->rect.IsEmpty()) {
-		acceptance = GetAcceptanceAroundTiles(
-			TileXY(st->rect.left, st->rect.top),
-			st->rect.right  - st->rect.left + 1,
-			st->rect.bottom - st->rect.top  + 1,
-			st->GetCatchmentRadius(),
-			&st->always_accepted
-		);
+		acceptance = GetStationAcceptance(st, &st->always_accepted);
 	}
 
 	/* Adjust in case our station only accepts fewer kinds of goods */
@@ -1460,7 +1549,9 @@ CommandCost RemoveFromRailBaseStation(TileArea ta, SmallVector<T *, 4> &affected
 
 		/* if we deleted the whole station, delete the train facility. */
 		if (st->train_station.tile == INVALID_TILE) {
+			CountStationFacilities(st, -1);
 			st->facilities &= ~FACIL_TRAIN;
+			CountStationFacilities(st, 1);
 			SetWindowWidgetDirty(WC_STATION_VIEW, st->index, WID_SV_TRAINS);
 			st->UpdateVirtCoord();
 			DeleteStationIfEmpty(st);
@@ -1584,7 +1675,9 @@ CommandCost RemoveRailStation(T *st, DoCommandFlag flags)
 
 		st->train_station.Clear();
 
+		CountStationFacilities(st, -1);
 		st->facilities &= ~FACIL_TRAIN;
+		CountStationFacilities(st, 1);
 
 		free(st->speclist);
 		st->num_specs = 0;
@@ -1895,7 +1988,9 @@ static CommandCost RemoveRoadStop(TileIndex tile, DoCommandFlag flags)
 			*primary_stop = cur_stop->next;
 			/* removed the only stop? */
 			if (*primary_stop == NULL) {
+				CountStationFacilities(st, -1);
 				st->facilities &= (is_truck ? ~FACIL_TRUCK_STOP : ~FACIL_BUS_STOP);
+				CountStationFacilities(st, 1);
 			}
 		} else {
 			/* tell the predecessor in the list to skip this stop */
@@ -2337,7 +2432,9 @@ static CommandCost RemoveAirport(TileIndex tile, DoCommandFlag flags)
 		st->rect.AfterRemoveRect(st, st->airport);
 
 		st->airport.Clear();
+		CountStationFacilities(st, -1);
 		st->facilities &= ~FACIL_AIRPORT;
+		CountStationFacilities(st, 1);
 
 		SetWindowWidgetDirty(WC_STATION_VIEW, st->index, WID_SV_PLANES);
 
@@ -2539,7 +2636,9 @@ static CommandCost RemoveDock(TileIndex tile, DoCommandFlag flags)
 		st->rect.AfterRemoveTile(st, tile2);
 
 		st->dock_tile = INVALID_TILE;
+		CountStationFacilities(st, -1);
 		st->facilities &= ~FACIL_DOCK;
+		CountStationFacilities(st, 1);
 
 		Company::Get(st->owner)->infrastructure.station -= 2;
 		DirtyCompanyInfrastructureWindows(st->owner);
@@ -3310,9 +3409,19 @@ void StationMonthlyLoop()
 
 void ModifyStationRatingAround(TileIndex tile, Owner owner, int amount, uint radius)
 {
-	Station *st;
+	/* Only the stations located within the radius are affected. */
+	uint x = TileX(tile);
+	uint y = TileY(tile);
+	uint min_x = (x > radius) ? x - radius : 0;
+	uint min_y = (y > radius) ? y - radius : 0;
+	uint max_x = min<uint>(x + radius, MapMaxX());
+	uint max_y = min<uint>(y + radius, MapMaxY());
 
-	FOR_ALL_STATIONS(st) {
+	StationList stations;
+	Station::GetCatchmentCandidates(TileArea(TileXY(min_x, min_y), TileXY(max_x, max_y)), &stations);
+
+	for (Station **st_iter = stations.Begin(); st_iter != stations.End(); st_iter++) {
+		Station *st = *st_iter;
 		if (st->owner == owner &&
 				DistanceManhattan(tile, st->xy) <= radius) {
 			for (CargoID i = 0; i < NUM_CARGO; i++) {
@@ -3401,6 +3510,23 @@ CommandCost CmdRenameStation(TileIndex tile, DoCommandFlag flags, uint32 p1, uin
 	return CommandCost();
 }
 
+/** A station found around a producer, with the first of its tiles that is in reach. */
+struct StationAroundTiles {
+	TileIndex tile; ///< The first tile of the station, in map order, that is in reach of the producer.
+	Station *st;    ///< The station.
+};
+
+/**
+ * Sort stations by their first tile that is in reach of the producer.
+ * @param a The first station.
+ * @param b The second station.
+ * @return Order of the stations.
+ */
+static int CDECL StationAroundTilesSorter(const StationAroundTiles *a, const StationAroundTiles *b)
+{
+	return (int)a->tile - (int)b->tile;
+}
+
 /**
  * Find all stations around a rectangular producer (industry, house, headquarter, ...)
  *
@@ -3425,29 +3551,42 @@ void FindStationsAroundTiles(const TileArea &location, StationList *stations)
 	if (max_x >= MapSizeX()) max_x = MapSizeX() - 1;
 	if (max_y >= MapSizeY()) max_y = MapSizeY() - 1;
 
-	for (uint cy = min_y; cy < max_y; cy++) {
-		for (uint cx = min_x; cx < max_x; cx++) {
-			TileIndex cur_tile = TileXY(cx, cy);
-			if (!IsTileType(cur_tile, MP_STATION)) continue;
-
-			Station *st = Station::GetByTile(cur_tile);
-			/* st can be NULL in case of waypoints */
-			if (st == NULL) continue;
-
-			if (_settings_game.station.modified_catchment) {
-				int rad = st->GetCatchmentRadius();
-				int rad_x = cx - x;
-				int rad_y = cy - y;
+	/* Only the stations whose catchment might reach the producer have to be checked. */
+	StationList candidates;
+	Station::GetCatchmentCandidates(location, &candidates);
 
-				if (rad_x < -rad || rad_x >= rad + location.w) continue;
-				if (rad_y < -rad || rad_y >= rad + location.h) continue;
+	SmallVector<StationAroundTiles, 4> found;
+	for (Station **st_iter = candidates.Begin(); st_iter != candidates.End(); st_iter++) {
+		Station *st = *st_iter;
+		int rad = _settings_game.station.modified_catchment ? st->GetCatchmentRadius() : max_rad;
+
+		/* Search the tiles of the station that are in reach of the producer. */
+		int left   = max<int>(max<int>(min_x, (int)x - rad), st->rect.left);
+		int right  = min<int>(min<int>(max_x, x + location.w + rad) - 1, st->rect.right);
+		int top    = max<int>(max<int>(min_y, (int)y - rad), st->rect.top);
+		int bottom = min<int>(min<int>(max_y, y + location.h + rad) - 1, st->rect.bottom);
+
+		TileIndex first = INVALID_TILE;
+		for (int cy = top; cy <= bottom && first == INVALID_TILE; cy++) {
+			for (int cx = left; cx <= right; cx++) {
+				TileIndex cur_tile = TileXY(cx, cy);
+				if (IsTileType(cur_tile, MP_STATION) && GetStationIndex(cur_tile) == st->index) {
+					first = cur_tile;
+					break;
+				}
 			}
-
-			/* Insert the station in the set. This will fail if it has
-			 * already been added.
-			 */
-			stations->Include(st);
 		}
+		if (first == INVALID_TILE) continue;
+
+		StationAroundTiles *sat = found.Append();
+		sat->tile = first;
+		sat->st = st;
+	}
+
+	/* Add the stations in the order a scan over all tiles around the producer would find them. */
+	QSortT(found.Begin(), found.Length(), &StationAroundTilesSorter);
+	for (const StationAroundTiles *sat = found.Begin(); sat != found.End(); sat++) {
+		stations->Include(sat->st);
 	}
 }
 
@@ -36,6 +36,7 @@
 #include "window_func.h"
 #include "debug.h"
 #include "game/game_text.hpp"
+#include "gfx_func.h"
 #include <stack>
 
 #include "table/strings.h"
@@ -1737,6 +1738,8 @@ bool ReadLanguagePack(const LanguageMetadata *lang)
 
 	_current_language = lang;
 	_current_text_dir = (TextDirection)_current_language->text_dir;
+	/* Layouts of strings depend on the text direction. */
+	ClearStringLayoutCache();
 	const char *c_file = strrchr(_current_language->file, PATHSEPCHAR) + 1;
 	strecpy(_config_language_file, c_file, lastof(_config_language_file));
 	SetCurrentGrfLangID(_current_language->newgrflangid);
@@ -97,6 +97,7 @@ static inline void SetTileType(TileIndex tile, TileType type)
 	 * the upper edges of the map are also VOID tiles. */
 	assert((TileX(tile) == MapMaxX() || TileY(tile) == MapMaxY() || (_settings_game.construction.freeform_edges && (TileX(tile) == 0 || TileY(tile) == 0))) == (type == MP_VOID));
 	SB(_m[tile].type_height, 4, 4, type);
+	MarkMapBlockChanged(tile);
 }
 
 /**
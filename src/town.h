@@ -96,6 +96,9 @@ struct Town : TownPool::PoolItem<&_town_pool> {
 	bool larger_town;              ///< if this is a larger town and should grow more quickly
 	TownLayoutByte layout;         ///< town specific road layout
 
+	TileIndex growth_candidates[TOWN_GROWTH_CANDIDATES]; ///< Road tiles the town recently grew at, oldest first.
+	byte num_growth_candidates;                          ///< Number of valid entries in #growth_candidates.
+
 	std::list<PersistentStorage *> psa_list;
 
 	PartOfSubsidyByte part_of_subsidy; ///< NOSAVE: is this town a source/destination of a subsidy?
@@ -57,6 +57,75 @@ uint32 _town_cargoes_accepted; ///< Bitmap of all cargoes accepted by houses.
 TownPool _town_pool("Town");
 INSTANTIATE_POOL_METHODS(Town)
 
+/** Number of bits of a tile coordinate that select the tile within a cell of the town index. */
+static const uint TOWN_INDEX_CELL_BITS = 5;
+
+/** The towns whose centre lies in a cell of the map. */
+typedef SmallVector<Town *, 4> TownIndexCell;
+
+static TownIndexCell *_town_index = NULL; ///< The cells of the town index, or NULL when it has to be (re)built.
+static uint _town_index_size_x;           ///< Number of cells of the town index along the X axis.
+static uint _town_index_size_y;           ///< Number of cells of the town index along the Y axis.
+
+/**
+ * Get the cell of the town index a tile is in.
+ * @param tile The tile.
+ * @return The cell.
+ */
+static inline TownIndexCell *GetTownIndexCell(TileIndex tile)
+{
+	return &_town_index[(TileY(tile) >> TOWN_INDEX_CELL_BITS) * _town_index_size_x + (TileX(tile) >> TOWN_INDEX_CELL_BITS)];
+}
+
+/** Clear the town index, e.g. when the towns of a game are removed. */
+void InitializeTowns()
+{
+	delete[] _town_index;
+	_town_index = NULL;
+}
+
+/** Build the town index from the towns in the pool, e.g. after loading a game. */
+static void RebuildTownIndex()
+{
+	InitializeTowns();
+
+	_town_index_size_x = MapSizeX() >> TOWN_INDEX_CELL_BITS;
+	_town_index_size_y = MapSizeY() >> TOWN_INDEX_CELL_BITS;
+	_town_index = new TownIndexCell[_town_index_size_x * _town_index_size_y];
+
+	Town *t;
+	FOR_ALL_TOWNS(t) *GetTownIndexCell(t->xy)->Append() = t;
+}
+
+/**
+ * Add a new town to the town index.
+ * @param t The town, with its centre set.
+ */
+static void AddTownToIndex(Town *t)
+{
+	/* The town will be picked up when the index is built. */
+	if (_town_index == NULL) return;
+
+	*GetTownIndexCell(t->xy)->Append() = t;
+}
+
+/**
+ * Remove a town from the town index.
+ * @param t The town that is about to be deleted.
+ */
+static void RemoveTownFromIndex(Town *t)
+{
+	if (_town_index == NULL || t->xy == INVALID_TILE) return;
+
+	TownIndexCell *cell = GetTownIndexCell(t->xy);
+	for (Town **it = cell->Begin(); it != cell->End(); it++) {
+		if (*it == t) {
+			cell->Erase(it);
+			return;
+		}
+	}
+}
+
 Town::~Town()
 {
 	free(this->name);
@@ -64,6 +133,8 @@ Town::~Town()
 
 	if (CleaningPool()) return;
 
+	RemoveTownFromIndex(this);
+
 	/* Delete town authority window
 	 * and remove from list of sorted towns */
 	DeleteWindowById(WC_TOWN_VIEW, this->index);
@@ -172,6 +243,9 @@ Money HouseSpec::GetRemovalCost() const
 // Local
 static int _grow_town_result;
 
+/** Number of road tiles to visit when growing from a place the town grew at recently. */
+static const int TOWN_GROWTH_CANDIDATE_SEARCH = 16;
+
 /* Describe the possible states */
 enum TownGrowthResult {
 	GROWTH_SUCCEED         = -1,
@@ -1275,13 +1349,83 @@ static void GrowTownInTile(TileIndex *tile_ptr, RoadBits cur_rb, DiagDirection t
 	GrowTownWithRoad(t1, tile, rcmd);
 }
 
+/**
+ * Get the number of steps a search for a place to grow may take when
+ * starting at the town centre.
+ * Better roads, 2X2 and 3X3 grid grow quite fast so we give
+ * them a little handicap.
+ * @param t The town to grow.
+ * @return The number of steps.
+ */
+static int GetTownGrowthSearchLength(const Town *t)
+{
+	switch (t->layout) {
+		case TL_BETTER_ROADS:
+			return 10 + t->num_houses * 2 / 9;
+
+		case TL_3X3_GRID:
+		case TL_2X2_GRID:
+			return 10 + t->num_houses * 1 / 9;
+
+		default:
+			return 10 + t->num_houses * 4 / 9;
+	}
+}
+
+/**
+ * Remember a road tile the town just grew at, so the next growth can start there.
+ * When the list is full the oldest place is forgotten.
+ * @param t    The town.
+ * @param tile The road tile.
+ */
+static void AddGrowthCandidate(Town *t, TileIndex tile)
+{
+	for (uint i = 0; i < t->num_growth_candidates; i++) {
+		if (t->growth_candidates[i] == tile) return;
+	}
+
+	if (t->num_growth_candidates == TOWN_GROWTH_CANDIDATES) {
+		MemMoveT(t->growth_candidates, t->growth_candidates + 1, TOWN_GROWTH_CANDIDATES - 1);
+		t->num_growth_candidates--;
+	}
+	t->growth_candidates[t->num_growth_candidates++] = tile;
+}
+
+/**
+ * Forget a place the town could grow at.
+ * @param t     The town.
+ * @param index The index of the place in the list of the town.
+ */
+static void RemoveGrowthCandidate(Town *t, uint index)
+{
+	assert(index < t->num_growth_candidates);
+	t->num_growth_candidates--;
+	MemMoveT(t->growth_candidates + index, t->growth_candidates + index + 1, t->num_growth_candidates - index);
+}
+
+/**
+ * Check whether the town can still start growing at a remembered place.
+ * The map may have changed since, e.g. the road may have been removed.
+ * @param t    The town.
+ * @param tile The remembered road tile.
+ * @return true iff the tile is a road the town may grow from.
+ */
+static bool IsGrowthCandidateValid(const Town *t, TileIndex tile)
+{
+	if (GetTownRoadBits(tile) == ROAD_NONE) return false;
+
+	/* Don't grow from roads of other cities. */
+	return !IsTileType(tile, MP_ROAD) || !IsRoadOwner(tile, ROADTYPE_ROAD, OWNER_TOWN) || Town::GetByTile(tile) == t;
+}
+
 /**
  * Returns "growth" if a house was built, or no if the build failed.
  * @param t town to inquiry
  * @param tile to inquiry
+ * @param search the maximum number of road tiles to visit
  * @return something other than zero(0)if town expansion was possible
  */
-static int GrowTownAtRoad(Town *t, TileIndex tile)
+static int GrowTownAtRoad(Town *t, TileIndex tile, int search)
 {
 	/* Special case.
 	 * @see GrowTownInTile Check the else if
@@ -1290,23 +1434,8 @@ static int GrowTownAtRoad(Town *t, TileIndex tile)
 
 	assert(tile < MapSize());
 
-	/* Number of times to search.
-	 * Better roads, 2X2 and 3X3 grid grow quite fast so we give
-	 * them a little handicap. */
-	switch (t->layout) {
-		case TL_BETTER_ROADS:
-			_grow_town_result = 10 + t->num_houses * 2 / 9;
-			break;
-
-		case TL_3X3_GRID:
-		case TL_2X2_GRID:
-			_grow_town_result = 10 + t->num_houses * 1 / 9;
-			break;
-
-		default:
-			_grow_town_result = 10 + t->num_houses * 4 / 9;
-			break;
-	}
+	/* Number of times to search. */
+	_grow_town_result = search;
 
 	do {
 		RoadBits cur_rb = GetTownRoadBits(tile); // The RoadBits of the current tile
@@ -1314,6 +1443,9 @@ static int GrowTownAtRoad(Town *t, TileIndex tile)
 		/* Try to grow the town from this point */
 		GrowTownInTile(&tile, cur_rb, target_dir, t);
 
+		/* Remember where we grew; there is a fair chance of finding room nearby next time. */
+		if (_grow_town_result == GROWTH_SUCCEED) AddGrowthCandidate(t, tile);
+
 		/* Exclude the source position from the bitmask
 		 * and return if no more road blocks available */
 		cur_rb &= ~DiagDirToRoadBits(ReverseDiagDir(target_dir));
@@ -1391,13 +1523,27 @@ static bool GrowTown(Town *t)
 	/* Current "company" is a town */
 	Backup<CompanyByte> cur_company(_current_company, OWNER_TOWN, FILE_LINE);
 
+	/* First try a short search around one of the places the town grew at
+	 * recently, instead of walking all the way from the town centre to the
+	 * edge of the town. Places where no growth is possible are forgotten. */
+	if (t->num_growth_candidates != 0) {
+		uint index = RandomRange(t->num_growth_candidates);
+		TileIndex tile = t->growth_candidates[index];
+		if (IsGrowthCandidateValid(t, tile) && GrowTownAtRoad(t, tile, TOWN_GROWTH_CANDIDATE_SEARCH) != 0) {
+			cur_company.Restore();
+			return true;
+		}
+		/* The list may have changed while growing; only forget the place if it is still there. */
+		if (index < t->num_growth_candidates && t->growth_candidates[index] == tile) RemoveGrowthCandidate(t, index);
+	}
+
 	TileIndex tile = t->xy; // The tile we are working with ATM
 
 	/* Find a road that we can base the construction on. */
 	const TileIndexDiffC *ptr;
 	for (ptr = _town_coord_mod; ptr != endof(_town_coord_mod); ++ptr) {
 		if (GetTownRoadBits(tile) != ROAD_NONE) {
-			int r = GrowTownAtRoad(t, tile);
+			int r = GrowTownAtRoad(t, tile, GetTownGrowthSearchLength(t));
 			cur_company.Restore();
 			return r != 0;
 		}
@@ -1488,6 +1634,7 @@ void UpdateTownMaxPass(Town *t)
 static void DoCreateTown(Town *t, TileIndex tile, uint32 townnameparts, TownSize size, bool city, TownLayout layout, bool manual)
 {
 	t->xy = tile;
+	AddTownToIndex(t);
 	t->num_houses = 0;
 	t->time_until_rebuild = 10;
 	UpdateTownRadius(t);
@@ -3072,15 +3219,40 @@ CommandCost CheckIfAuthorityAllowsNewStation(TileIndex tile, DoCommandFlag flags
  */
 Town *CalcClosestTownFromTile(TileIndex tile, uint threshold)
 {
-	Town *t;
+	if (_town_index == NULL || _town_index_size_x != MapSizeX() >> TOWN_INDEX_CELL_BITS || _town_index_size_y != MapSizeY() >> TOWN_INDEX_CELL_BITS) {
+		RebuildTownIndex();
+	}
+
 	uint best = threshold;
 	Town *best_town = NULL;
 
-	FOR_ALL_TOWNS(t) {
-		uint dist = DistanceManhattan(tile, t->xy);
-		if (dist < best) {
-			best = dist;
-			best_town = t;
+	int cx = TileX(tile) >> TOWN_INDEX_CELL_BITS;
+	int cy = TileY(tile) >> TOWN_INDEX_CELL_BITS;
+	int max_ring = max(max(cx, (int)_town_index_size_x - 1 - cx), max(cy, (int)_town_index_size_y - 1 - cy));
+
+	/* Search the rings of cells around the cell of the tile. Once all towns
+	 * outside the searched rings are further away than the best town found
+	 * so far, the search is over. Among towns at the same distance the one
+	 * with the lowest index wins, just like a scan over all towns would. */
+	for (int ring = 0; ring <= max_ring; ring++) {
+		if (ring > 0 && ((uint)(ring - 1) << TOWN_INDEX_CELL_BITS) + 1 > best) break;
+
+		for (int y = max(cy - ring, 0); y <= min(cy + ring, (int)_town_index_size_y - 1); y++) {
+			/* Only the first and last row of the ring are complete; other rows only have their ends in the ring. */
+			int step = (y == cy - ring || y == cy + ring) ? 1 : 2 * ring;
+			for (int x = cx - ring; x <= cx + ring; x += step) {
+				if (x < 0 || x >= (int)_town_index_size_x) continue;
+
+				const TownIndexCell *cell = &_town_index[y * _town_index_size_x + x];
+				for (Town * const *it = cell->Begin(); it != cell->End(); it++) {
+					Town *t = *it;
+					uint dist = DistanceManhattan(tile, t->xy);
+					if (dist < best || (dist == best && best_town != NULL && t->index < best_town->index)) {
+						best = dist;
+						best_town = t;
+					}
+				}
+			}
 		}
 	}
 
@@ -106,6 +106,7 @@ enum TownFounding {
 typedef SimpleTinyEnumT<TownFounding, byte> TownFoundingByte;
 
 static const uint MAX_LENGTH_TOWN_NAME_CHARS = 32; ///< The maximum length of a town name in characters including '\0'
+static const uint TOWN_GROWTH_CANDIDATES = 16;     ///< The maximum number of places a town remembers to grow at.
 
 /** Store the maximum and actually transported cargo amount for the current and the last month. */
 template <typename Tstorage>
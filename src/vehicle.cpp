@@ -37,6 +37,7 @@
 #include "network/network.h"
 #include "core/pool_func.hpp"
 #include "economy_base.h"
+#include "economy_func.h"
 #include "articulated_vehicles.h"
 #include "roadstop_base.h"
 #include "core/random_func.hpp"
@@ -718,6 +719,8 @@ void Vehicle::PreDestructor()
 		delete this->cargo_payment;
 	}
 
+	CountVehicleValue(this, -1);
+
 	if (this->IsEngineCountable()) {
 		GroupStatistics::CountEngine(this, -1);
 		if (this->IsPrimaryVehicle()) GroupStatistics::CountVehicle(this, -1);
@@ -847,8 +850,7 @@ void CallVehicleTicks()
 
 	RunVehicleDayProc();
 
-	Station *st;
-	FOR_ALL_STATIONS(st) LoadUnloadStation(st);
+	LoadUnloadStations();
 
 	Vehicle *v;
 	FOR_ALL_VEHICLES(v) {
@@ -1059,7 +1061,9 @@ Vehicle *CheckClickOnVehicle(const ViewPort *vp, int x, int y)
  */
 void DecreaseVehicleValue(Vehicle *v)
 {
+	CountVehicleValue(v, -1);
 	v->value -= v->value >> 8;
+	CountVehicleValue(v, 1);
 	SetWindowDirty(WC_VEHICLE_DETAILS, v->index);
 }
 
@@ -1946,6 +1950,7 @@ void Vehicle::BeginLoading()
 	}
 
 	Station::Get(this->last_station_visited)->loading_vehicles.push_back(this);
+	AddLoadingStation(Station::Get(this->last_station_visited));
 
 	PrepareUnload(this);
 
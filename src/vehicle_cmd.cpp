@@ -30,6 +30,7 @@
 #include "order_backup.h"
 #include "ship.h"
 #include "newgrf.h"
+#include "economy_func.h"
 
 #include "table/strings.h"
 
@@ -132,6 +133,7 @@ CommandCost CmdBuildVehicle(TileIndex tile, DoCommandFlag flags, uint32 p1, uint
 	if (value.Succeeded() && flags & DC_EXEC) {
 		v->unitnumber = unit_num;
 		v->value      = value.GetCost();
+		CountVehicleValue(v, 1);
 
 		InvalidateWindowData(WC_VEHICLE_DEPOT, v->tile);
 		InvalidateWindowClassesData(GetWindowClassForVehicleType(type), 0);
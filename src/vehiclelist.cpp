@@ -12,6 +12,9 @@
 #include "stdafx.h"
 #include "train.h"
 #include "vehiclelist.h"
+#include "base_station_base.h"
+#include "order_func.h"
+#include "core/sort_func.hpp"
 
 /**
  * Pack a VehicleListIdentifier in a single uint32.
@@ -99,6 +102,39 @@ void BuildDepotVehicleList(VehicleType type, TileIndex tile, VehicleList *engine
 	if (wagons != NULL && wagons != engines) wagons->Compact();
 }
 
+/** Sort vehicles by their index, i.e. the order in which FOR_ALL_VEHICLES visits them. */
+static int CDECL VehicleIndexSorter(const Vehicle * const *a, const Vehicle * const *b)
+{
+	return (*a)->index - (*b)->index;
+}
+
+/**
+ * Build a list of the primary vehicles that have orders to a station.
+ * Only the order lists going to the station are visited instead of all vehicles.
+ * @param station          The station or waypoint to get the vehicles of.
+ * @param type             The type of vehicles to add, or VEH_INVALID for all types.
+ * @param include_implicit Whether vehicles with only implicit orders to the station are added.
+ * @param list             The list to add the vehicles to, sorted by vehicle index.
+ */
+void BuildStationVehicleList(StationID station, VehicleType type, bool include_implicit, VehicleList *list)
+{
+	const BaseStation *bs = BaseStation::GetIfValid(station);
+	if (bs == NULL) return;
+
+	UpdateStationOrderLists();
+
+	uint first = list->Length();
+	for (const StationOrderListRef *ref = bs->order_lists.Begin(); ref != bs->order_lists.End(); ref++) {
+		if (ref->num_orders == 0 && !include_implicit) continue;
+
+		for (const Vehicle *v = ref->list->GetFirstSharedVehicle(); v != NULL; v = v->NextShared()) {
+			if ((type == VEH_INVALID || v->type == type) && v->IsPrimaryVehicle()) *list->Append() = v;
+		}
+	}
+
+	QSortT(list->Get(first), list->Length() - first, &VehicleIndexSorter);
+}
+
 /**
  * Generate a list of vehicles based on window type.
  * @param list Pointer to list to add vehicles to
@@ -113,19 +149,7 @@ bool GenerateVehicleSortList(VehicleList *list, const VehicleListIdentifier &vli
 
 	switch (vli.type) {
 		case VL_STATION_LIST:
-			FOR_ALL_VEHICLES(v) {
-				if (v->type == vli.vtype && v->IsPrimaryVehicle()) {
-					const Order *order;
-
-					FOR_VEHICLE_ORDERS(v, order) {
-						if ((order->IsType(OT_GOTO_STATION) || order->IsType(OT_GOTO_WAYPOINT) || order->IsType(OT_IMPLICIT))
-								&& order->GetDestination() == vli.index) {
-							*list->Append() = v;
-							break;
-						}
-					}
-				}
-			}
+			BuildStationVehicleList(vli.index, vli.vtype, true, list);
 			break;
 
 		case VL_SHARED_ORDERS:
@@ -16,6 +16,7 @@
 #include "vehicle_type.h"
 #include "company_type.h"
 #include "tile_type.h"
+#include "station_type.h"
 
 /** Vehicle List type flags */
 enum VehicleListType {
@@ -57,6 +58,7 @@ struct VehicleListIdentifier {
 typedef SmallVector<const Vehicle *, 32> VehicleList;
 
 bool GenerateVehicleSortList(VehicleList *list, const VehicleListIdentifier &identifier);
+void BuildStationVehicleList(StationID station, VehicleType type, bool include_implicit, VehicleList *list);
 void BuildDepotVehicleList(VehicleType type, TileIndex tile, VehicleList *engine_list, VehicleList *wagon_list, bool individual_wagons = false);
 
 #endif /* VEHICLELIST_H */
@@ -46,6 +46,11 @@
 #include "tilehighlight_func.h"
 #include "window_gui.h"
 #include "pathfinder/yapf/region_common.h"
+#include "spritecache.h"
+#include "newgrf_debug.h"
+#include "settings_type.h"
+#include "thread/thread.h"
+#include "smallmap_gui.h"
 
 #include "table/strings.h"
 #include "table/palettes.h"
@@ -67,6 +72,8 @@ struct TileSpriteToDraw {
 	const SubSprite *sub;           ///< only draw a rectangular part of the sprite
 	int32 x;                        ///< screen X coordinate of sprite
 	int32 y;                        ///< screen Y coordinate of sprite
+	const Sprite *sprite;           ///< sprite data, if looked up by #ViewportPrepareSprites
+	const byte *remap;              ///< colour remap, if looked up by #ViewportPrepareSprites
 };
 
 struct ChildScreenSpriteToDraw {
@@ -76,6 +83,8 @@ struct ChildScreenSpriteToDraw {
 	int32 x;
 	int32 y;
 	int next;                       ///< next child to draw (-1 at the end)
+	const Sprite *sprite;           ///< sprite data, if looked up by #ViewportPrepareSprites
+	const byte *remap;              ///< colour remap, if looked up by #ViewportPrepareSprites
 };
 
 /** Parent sprite that should be drawn */
@@ -83,6 +92,8 @@ struct ParentSpriteToDraw {
 	SpriteID image;                 ///< sprite to draw
 	PaletteID pal;                  ///< palette to use
 	const SubSprite *sub;           ///< only draw a rectangular part of the sprite
+	const Sprite *sprite;           ///< sprite data, if looked up by #ViewportPrepareSprites
+	const byte *remap;              ///< colour remap, if looked up by #ViewportPrepareSprites
 
 	int32 x;                        ///< screen X coordinate of sprite
 	int32 y;                        ///< screen Y coordinate of sprite
@@ -98,7 +109,7 @@ struct ParentSpriteToDraw {
 	int zmax;                       ///< maximal world Z coordinate of bounding box
 
 	int first_child;                ///< the first child to draw.
-	bool comparison_done;           ///< Used during sprite sorting: true if sprite has been compared with all other sprites
+	uint32 order;                   ///< Used during sprite sorting: position in the sorting stack, or ORDER_COMPARED/ORDER_RETURNED
 };
 
 /** Enumeration of multi-part foundations */
@@ -143,11 +154,20 @@ struct ViewportDrawer {
 	FoundationPart foundation_part;                  ///< Currently active foundation for ground sprite drawing.
 	int *last_foundation_child[FOUNDATION_PART_END]; ///< Tail of ChildSprite list of the foundations. (index into child_screen_sprites_to_draw)
 	Point foundation_offset[FOUNDATION_PART_END];    ///< Pixel offset for ground sprites on the foundations.
+
+	bool sprites_prepared;                           ///< Whether the sprite data of all collected sprites is looked up already.
 };
 
 static void MarkViewportDirty(const ViewPort *vp, int left, int top, int right, int bottom);
 
-static ViewportDrawer _vd;
+static ViewportDrawer _vd_main;               ///< Drawer used when drawing a viewport at once.
+static ViewportDrawer *_vd = &_vd_main;       ///< Drawer the sprites are currently collected in.
+
+static const uint MAX_VIEWPORT_DRAW_THREADS = 16; ///< Maximum number of threads drawing a viewport at the same time.
+static AutoDeleteSmallVector<ViewportDrawer *, 16> _vd_pieces; ///< Drawers for the pieces of a viewport that is drawn by multiple threads.
+static uint _vd_num_pieces = 0;               ///< Number of pieces in use of #_vd_pieces.
+static bool _vd_collect_pieces = false;       ///< Whether pieces of the viewport are collected for drawing them later.
+static bool _vd_prefetch = false;             ///< Whether sprites are only looked for to prefetch them, instead of collecting them for drawing.
 
 TileHighlightData _thd;
 static TileInfo *_cur_ti;
@@ -488,7 +508,12 @@ static void AddTileSpriteToDraw(SpriteID image, PaletteID pal, int32 x, int32 y,
 {
 	assert((image & SPRITE_MASK) < MAX_SPRITES);
 
-	TileSpriteToDraw *ts = _vd.tile_sprites_to_draw.Append();
+	if (_vd_prefetch) {
+		PrefetchSprite(GB(image, 0, SPRITE_WIDTH), _vd->dpi.zoom);
+		return;
+	}
+
+	TileSpriteToDraw *ts = _vd->tile_sprites_to_draw.Append();
 	ts->image = image;
 	ts->pal = pal;
 	ts->sub = sub;
@@ -512,17 +537,17 @@ static void AddTileSpriteToDraw(SpriteID image, PaletteID pal, int32 x, int32 y,
 static void AddChildSpriteToFoundation(SpriteID image, PaletteID pal, const SubSprite *sub, FoundationPart foundation_part, int extra_offs_x, int extra_offs_y)
 {
 	assert(IsInsideMM(foundation_part, 0, FOUNDATION_PART_END));
-	assert(_vd.foundation[foundation_part] != -1);
-	Point offs = _vd.foundation_offset[foundation_part];
+	assert(_vd->foundation[foundation_part] != -1);
+	Point offs = _vd->foundation_offset[foundation_part];
 
 	/* Change the active ChildSprite list to the one of the foundation */
-	int *old_child = _vd.last_child;
-	_vd.last_child = _vd.last_foundation_child[foundation_part];
+	int *old_child = _vd->last_child;
+	_vd->last_child = _vd->last_foundation_child[foundation_part];
 
 	AddChildSpriteScreen(image, pal, offs.x + extra_offs_x, offs.y + extra_offs_y, false, sub, false);
 
 	/* Switch back to last ChildSprite list */
-	_vd.last_child = old_child;
+	_vd->last_child = old_child;
 }
 
 /**
@@ -541,11 +566,11 @@ static void AddChildSpriteToFoundation(SpriteID image, PaletteID pal, const SubS
 void DrawGroundSpriteAt(SpriteID image, PaletteID pal, int32 x, int32 y, int z, const SubSprite *sub, int extra_offs_x, int extra_offs_y)
 {
 	/* Switch to first foundation part, if no foundation was drawn */
-	if (_vd.foundation_part == FOUNDATION_PART_NONE) _vd.foundation_part = FOUNDATION_PART_NORMAL;
+	if (_vd->foundation_part == FOUNDATION_PART_NONE) _vd->foundation_part = FOUNDATION_PART_NORMAL;
 
-	if (_vd.foundation[_vd.foundation_part] != -1) {
+	if (_vd->foundation[_vd->foundation_part] != -1) {
 		Point pt = RemapCoords(x, y, z);
-		AddChildSpriteToFoundation(image, pal, sub, _vd.foundation_part, pt.x + extra_offs_x * ZOOM_LVL_BASE, pt.y + extra_offs_y * ZOOM_LVL_BASE);
+		AddChildSpriteToFoundation(image, pal, sub, _vd->foundation_part, pt.x + extra_offs_x * ZOOM_LVL_BASE, pt.y + extra_offs_y * ZOOM_LVL_BASE);
 	} else {
 		AddTileSpriteToDraw(image, pal, _cur_ti->x + x, _cur_ti->y + y, _cur_ti->z + z, sub, extra_offs_x * ZOOM_LVL_BASE, extra_offs_y * ZOOM_LVL_BASE);
 	}
@@ -576,22 +601,22 @@ void DrawGroundSprite(SpriteID image, PaletteID pal, const SubSprite *sub, int e
 void OffsetGroundSprite(int x, int y)
 {
 	/* Switch to next foundation part */
-	switch (_vd.foundation_part) {
+	switch (_vd->foundation_part) {
 		case FOUNDATION_PART_NONE:
-			_vd.foundation_part = FOUNDATION_PART_NORMAL;
+			_vd->foundation_part = FOUNDATION_PART_NORMAL;
 			break;
 		case FOUNDATION_PART_NORMAL:
-			_vd.foundation_part = FOUNDATION_PART_HALFTILE;
+			_vd->foundation_part = FOUNDATION_PART_HALFTILE;
 			break;
 		default: NOT_REACHED();
 	}
 
-	/* _vd.last_child == NULL if foundation sprite was clipped by the viewport bounds */
-	if (_vd.last_child != NULL) _vd.foundation[_vd.foundation_part] = _vd.parent_sprites_to_draw.Length() - 1;
+	/* _vd->last_child == NULL if foundation sprite was clipped by the viewport bounds */
+	if (_vd->last_child != NULL) _vd->foundation[_vd->foundation_part] = _vd->parent_sprites_to_draw.Length() - 1;
 
-	_vd.foundation_offset[_vd.foundation_part].x = x * ZOOM_LVL_BASE;
-	_vd.foundation_offset[_vd.foundation_part].y = y * ZOOM_LVL_BASE;
-	_vd.last_foundation_child[_vd.foundation_part] = _vd.last_child;
+	_vd->foundation_offset[_vd->foundation_part].x = x * ZOOM_LVL_BASE;
+	_vd->foundation_offset[_vd->foundation_part].y = y * ZOOM_LVL_BASE;
+	_vd->last_foundation_child[_vd->foundation_part] = _vd->last_child;
 }
 
 /**
@@ -608,15 +633,15 @@ void OffsetGroundSprite(int x, int y)
 static void AddCombinedSprite(SpriteID image, PaletteID pal, int x, int y, int z, const SubSprite *sub)
 {
 	Point pt = RemapCoords(x, y, z);
-	const Sprite *spr = GetSprite(image & SPRITE_MASK, ST_NORMAL);
+	const Sprite *spr = GetSprite(image & SPRITE_MASK, ST_NORMAL, _vd->dpi.zoom);
 
-	if (pt.x + spr->x_offs >= _vd.dpi.left + _vd.dpi.width ||
-			pt.x + spr->x_offs + spr->width <= _vd.dpi.left ||
-			pt.y + spr->y_offs >= _vd.dpi.top + _vd.dpi.height ||
-			pt.y + spr->y_offs + spr->height <= _vd.dpi.top)
+	if (pt.x + spr->x_offs >= _vd->dpi.left + _vd->dpi.width ||
+			pt.x + spr->x_offs + spr->width <= _vd->dpi.left ||
+			pt.y + spr->y_offs >= _vd->dpi.top + _vd->dpi.height ||
+			pt.y + spr->y_offs + spr->height <= _vd->dpi.top)
 		return;
 
-	const ParentSpriteToDraw *pstd = _vd.parent_sprites_to_draw.End() - 1;
+	const ParentSpriteToDraw *pstd = _vd->parent_sprites_to_draw.End() - 1;
 	AddChildSpriteScreen(image, pal, pt.x - pstd->left, pt.y - pstd->top, false, sub, false);
 }
 
@@ -651,18 +676,24 @@ void AddSortableSpriteToDraw(SpriteID image, PaletteID pal, int x, int y, int w,
 
 	assert((image & SPRITE_MASK) < MAX_SPRITES);
 
+	/* The size of the sprite is not known without decoding it, so nothing is clipped when prefetching. */
+	if (_vd_prefetch) {
+		if (image != SPR_EMPTY_BOUNDING_BOX) PrefetchSprite(GB(image, 0, SPRITE_WIDTH), _vd->dpi.zoom);
+		return;
+	}
+
 	/* make the sprites transparent with the right palette */
 	if (transparent) {
 		SetBit(image, PALETTE_MODIFIER_TRANSPARENT);
 		pal = PALETTE_TO_TRANSPARENT;
 	}
 
-	if (_vd.combine_sprites == SPRITE_COMBINE_ACTIVE) {
+	if (_vd->combine_sprites == SPRITE_COMBINE_ACTIVE) {
 		AddCombinedSprite(image, pal, x, y, z, sub);
 		return;
 	}
 
-	_vd.last_child = NULL;
+	_vd->last_child = NULL;
 
 	Point pt = RemapCoords(x, y, z);
 	int tmp_left, tmp_top, tmp_x = pt.x, tmp_y = pt.y;
@@ -674,7 +705,7 @@ void AddSortableSpriteToDraw(SpriteID image, PaletteID pal, int x, int y, int w,
 		top  = tmp_top  = RemapCoords(x + bb_offset_x, y + bb_offset_y, z + dz         ).y;
 		bottom          = RemapCoords(x + w          , y + h          , z + bb_offset_z).y + 1;
 	} else {
-		const Sprite *spr = GetSprite(image & SPRITE_MASK, ST_NORMAL);
+		const Sprite *spr = GetSprite(image & SPRITE_MASK, ST_NORMAL, _vd->dpi.zoom);
 		left = tmp_left = (pt.x += spr->x_offs);
 		right           = (pt.x +  spr->width );
 		top  = tmp_top  = (pt.y += spr->y_offs);
@@ -690,14 +721,14 @@ void AddSortableSpriteToDraw(SpriteID image, PaletteID pal, int x, int y, int w,
 	}
 
 	/* Do not add the sprite to the viewport, if it is outside */
-	if (left   >= _vd.dpi.left + _vd.dpi.width ||
-	    right  <= _vd.dpi.left                 ||
-	    top    >= _vd.dpi.top + _vd.dpi.height ||
-	    bottom <= _vd.dpi.top) {
+	if (left   >= _vd->dpi.left + _vd->dpi.width ||
+	    right  <= _vd->dpi.left                 ||
+	    top    >= _vd->dpi.top + _vd->dpi.height ||
+	    bottom <= _vd->dpi.top) {
 		return;
 	}
 
-	ParentSpriteToDraw *ps = _vd.parent_sprites_to_draw.Append();
+	ParentSpriteToDraw *ps = _vd->parent_sprites_to_draw.Append();
 	ps->x = tmp_x;
 	ps->y = tmp_y;
 
@@ -716,12 +747,11 @@ void AddSortableSpriteToDraw(SpriteID image, PaletteID pal, int x, int y, int w,
 	ps->zmin = z + bb_offset_z;
 	ps->zmax = z + max(bb_offset_z, dz) - 1;
 
-	ps->comparison_done = false;
 	ps->first_child = -1;
 
-	_vd.last_child = &ps->first_child;
+	_vd->last_child = &ps->first_child;
 
-	if (_vd.combine_sprites == SPRITE_COMBINE_PENDING) _vd.combine_sprites = SPRITE_COMBINE_ACTIVE;
+	if (_vd->combine_sprites == SPRITE_COMBINE_PENDING) _vd->combine_sprites = SPRITE_COMBINE_ACTIVE;
 }
 
 /**
@@ -744,8 +774,8 @@ void AddSortableSpriteToDraw(SpriteID image, PaletteID pal, int x, int y, int w,
  */
 void StartSpriteCombine()
 {
-	assert(_vd.combine_sprites == SPRITE_COMBINE_NONE);
-	_vd.combine_sprites = SPRITE_COMBINE_PENDING;
+	assert(_vd->combine_sprites == SPRITE_COMBINE_NONE);
+	_vd->combine_sprites = SPRITE_COMBINE_PENDING;
 }
 
 /**
@@ -754,8 +784,8 @@ void StartSpriteCombine()
  */
 void EndSpriteCombine()
 {
-	assert(_vd.combine_sprites != SPRITE_COMBINE_NONE);
-	_vd.combine_sprites = SPRITE_COMBINE_NONE;
+	assert(_vd->combine_sprites != SPRITE_COMBINE_NONE);
+	_vd->combine_sprites = SPRITE_COMBINE_NONE;
 }
 
 /**
@@ -804,8 +834,13 @@ void AddChildSpriteScreen(SpriteID image, PaletteID pal, int x, int y, bool tran
 {
 	assert((image & SPRITE_MASK) < MAX_SPRITES);
 
+	if (_vd_prefetch) {
+		PrefetchSprite(GB(image, 0, SPRITE_WIDTH), _vd->dpi.zoom);
+		return;
+	}
+
 	/* If the ParentSprite was clipped by the viewport bounds, do not draw the ChildSprites either */
-	if (_vd.last_child == NULL) return;
+	if (_vd->last_child == NULL) return;
 
 	/* make the sprites transparent with the right palette */
 	if (transparent) {
@@ -813,9 +848,9 @@ void AddChildSpriteScreen(SpriteID image, PaletteID pal, int x, int y, bool tran
 		pal = PALETTE_TO_TRANSPARENT;
 	}
 
-	*_vd.last_child = _vd.child_screen_sprites_to_draw.Length();
+	*_vd->last_child = _vd->child_screen_sprites_to_draw.Length();
 
-	ChildScreenSpriteToDraw *cs = _vd.child_screen_sprites_to_draw.Append();
+	ChildScreenSpriteToDraw *cs = _vd->child_screen_sprites_to_draw.Append();
 	cs->image = image;
 	cs->pal = pal;
 	cs->sub = sub;
@@ -826,15 +861,15 @@ void AddChildSpriteScreen(SpriteID image, PaletteID pal, int x, int y, bool tran
 	/* Append the sprite to the active ChildSprite list.
 	 * If the active ParentSprite is a foundation, update last_foundation_child as well.
 	 * Note: ChildSprites of foundations are NOT sequential in the vector, as selection sprites are added at last. */
-	if (_vd.last_foundation_child[0] == _vd.last_child) _vd.last_foundation_child[0] = &cs->next;
-	if (_vd.last_foundation_child[1] == _vd.last_child) _vd.last_foundation_child[1] = &cs->next;
-	_vd.last_child = &cs->next;
+	if (_vd->last_foundation_child[0] == _vd->last_child) _vd->last_foundation_child[0] = &cs->next;
+	if (_vd->last_foundation_child[1] == _vd->last_child) _vd->last_foundation_child[1] = &cs->next;
+	_vd->last_child = &cs->next;
 }
 
 static void AddStringToDraw(int x, int y, StringID string, uint64 params_1, uint64 params_2, Colours colour, uint16 width)
 {
 	assert(width != 0);
-	StringSpriteToDraw *ss = _vd.string_sprites_to_draw.Append();
+	StringSpriteToDraw *ss = _vd->string_sprites_to_draw.Append();
 	ss->string = string;
 	ss->x = x;
 	ss->y = y;
@@ -859,7 +894,7 @@ static void AddStringToDraw(int x, int y, StringID string, uint64 params_1, uint
 static void DrawSelectionSprite(SpriteID image, PaletteID pal, const TileInfo *ti, int z_offset, FoundationPart foundation_part)
 {
 	/* FIXME: This is not totally valid for some autorail highlights that extend over the edges of the tile. */
-	if (_vd.foundation[foundation_part] == -1) {
+	if (_vd->foundation[foundation_part] == -1) {
 		/* draw on real ground */
 		AddTileSpriteToDraw(image, pal, ti->x, ti->y, ti->z + z_offset);
 	} else {
@@ -1059,14 +1094,14 @@ static void ViewportAddLandscape()
 	_cur_ti = &ti;
 
 	/* Transform into tile coordinates and round to closest full tile */
-	x = ((_vd.dpi.top >> (1 + ZOOM_LVL_SHIFT)) - (_vd.dpi.left >> (2 + ZOOM_LVL_SHIFT))) & ~TILE_UNIT_MASK;
-	y = ((_vd.dpi.top >> (1 + ZOOM_LVL_SHIFT)) + (_vd.dpi.left >> (2 + ZOOM_LVL_SHIFT)) - TILE_SIZE) & ~TILE_UNIT_MASK;
+	x = ((_vd->dpi.top >> (1 + ZOOM_LVL_SHIFT)) - (_vd->dpi.left >> (2 + ZOOM_LVL_SHIFT))) & ~TILE_UNIT_MASK;
+	y = ((_vd->dpi.top >> (1 + ZOOM_LVL_SHIFT)) + (_vd->dpi.left >> (2 + ZOOM_LVL_SHIFT)) - TILE_SIZE) & ~TILE_UNIT_MASK;
 
 	/* determine size of area */
 	{
 		Point pt = RemapCoords(x, y, 241);
-		width = (_vd.dpi.left + _vd.dpi.width - pt.x + 95 * ZOOM_LVL_BASE) >> (6 + ZOOM_LVL_SHIFT);
-		height = (_vd.dpi.top + _vd.dpi.height - pt.y) >> (5 + ZOOM_LVL_SHIFT) << 1;
+		width = (_vd->dpi.left + _vd->dpi.width - pt.x + 95 * ZOOM_LVL_BASE) >> (6 + ZOOM_LVL_SHIFT);
+		height = (_vd->dpi.top + _vd->dpi.height - pt.y) >> (5 + ZOOM_LVL_SHIFT) << 1;
 	}
 
 	assert(width > 0);
@@ -1108,11 +1143,11 @@ static void ViewportAddLandscape()
 				}
 			}
 
-			_vd.foundation_part = FOUNDATION_PART_NONE;
-			_vd.foundation[0] = -1;
-			_vd.foundation[1] = -1;
-			_vd.last_foundation_child[0] = NULL;
-			_vd.last_foundation_child[1] = NULL;
+			_vd->foundation_part = FOUNDATION_PART_NONE;
+			_vd->foundation[0] = -1;
+			_vd->foundation[1] = -1;
+			_vd->last_foundation_child[0] = NULL;
+			_vd->last_foundation_child[1] = NULL;
 
 			_tile_type_procs[tt]->draw_tile_proc(&ti);
 
@@ -1288,33 +1323,153 @@ void ViewportSign::MarkDirty(ZoomLevel maxzoom) const
 	}
 }
 
-static void ViewportDrawTileSprites(const TileSpriteToDrawVector *tstdv)
+/**
+ * Look up the sprite data and colour remap of a collected sprite.
+ * @param s    The sprite to look up.
+ * @param zoom The zoom level the sprite is drawn at.
+ */
+template <typename T>
+static inline void ViewportPrepareSprite(T *s, ZoomLevel zoom)
+{
+	s->remap = GetSpriteColourRemap(s->image, s->pal);
+	s->sprite = GetSprite(GB(s->image, 0, SPRITE_WIDTH), ST_NORMAL, zoom);
+}
+
+/**
+ * Look up the sprite data of all sprites collected by a drawer, so they can
+ * be drawn without accessing the sprite cache.
+ * @param vd The drawer to prepare.
+ * @note The looked up data is only valid as long as #_sprite_cache_generation does not change.
+ */
+static void ViewportPrepareSprites(ViewportDrawer *vd)
 {
-	const TileSpriteToDraw *tsend = tstdv->End();
-	for (const TileSpriteToDraw *ts = tstdv->Begin(); ts != tsend; ++ts) {
-		DrawSpriteViewport(ts->image, ts->pal, ts->x, ts->y, ts->sub);
+	for (TileSpriteToDraw *ts = vd->tile_sprites_to_draw.Begin(); ts != vd->tile_sprites_to_draw.End(); ts++) {
+		ViewportPrepareSprite(ts, vd->dpi.zoom);
 	}
+	for (ParentSpriteToDraw *ps = vd->parent_sprites_to_draw.Begin(); ps != vd->parent_sprites_to_draw.End(); ps++) {
+		if (ps->image != SPR_EMPTY_BOUNDING_BOX) ViewportPrepareSprite(ps, vd->dpi.zoom);
+	}
+	for (ChildScreenSpriteToDraw *cs = vd->child_screen_sprites_to_draw.Begin(); cs != vd->child_screen_sprites_to_draw.End(); cs++) {
+		ViewportPrepareSprite(cs, vd->dpi.zoom);
+	}
+	vd->sprites_prepared = true;
 }
 
-/** Sort parent sprites pointer array */
+/**
+ * Draw a sprite collected by a drawer.
+ * @param vd The drawer the sprite is collected in.
+ * @param s  The sprite to draw.
+ * @param x  Left coordinate of the sprite in the viewport, scaled by zoom.
+ * @param y  Top coordinate of the sprite in the viewport, scaled by zoom.
+ */
+template <typename T>
+static inline void ViewportDrawSprite(const ViewportDrawer *vd, const T *s, int x, int y)
+{
+	if (vd->sprites_prepared) {
+		DrawSpriteViewport(&vd->dpi, s->sprite, s->remap, s->image, x, y, s->sub);
+	} else {
+		const byte *remap = GetSpriteColourRemap(s->image, s->pal);
+		DrawSpriteViewport(&vd->dpi, GetSprite(GB(s->image, 0, SPRITE_WIDTH), ST_NORMAL, vd->dpi.zoom), remap, s->image, x, y, s->sub);
+	}
+}
+
+static void ViewportDrawTileSprites(const ViewportDrawer *vd)
+{
+	const TileSpriteToDraw *tsend = vd->tile_sprites_to_draw.End();
+	for (const TileSpriteToDraw *ts = vd->tile_sprites_to_draw.Begin(); ts != tsend; ++ts) {
+		ViewportDrawSprite(vd, ts, ts->x, ts->y);
+	}
+}
+
+/** Entry of the list of parent sprites ordered by the sum of their minimal X and Y coordinates. */
+struct ParentSpriteSortEntry {
+	int32 key;              ///< xmin + ymin of the sprite.
+	ParentSpriteToDraw *ps; ///< The sprite.
+	uint next;              ///< Index of the next entry in the list.
+};
+
+/** Sort the entries of the sprite list by their key. */
+static int CDECL ParentSpriteSortEntrySorter(const ParentSpriteSortEntry *a, const ParentSpriteSortEntry *b)
+{
+	return a->key - b->key;
+}
+
+/** Sort parent sprites by their position in the sorting stack. */
+static int CDECL ParentSpriteOrderSorter(ParentSpriteToDraw * const *a, ParentSpriteToDraw * const *b)
+{
+	return (*a)->order < (*b)->order ? -1 : (*a)->order > (*b)->order;
+}
+
+static const uint32 ORDER_COMPARED = UINT32_MAX;     ///< Sprite is compared, but the sprites moved in front of it still have to be drawn.
+static const uint32 ORDER_RETURNED = UINT32_MAX - 1; ///< Sprite is sorted; other copies of it in the stack are to be skipped.
+
+/**
+ * Sort parent sprites pointer array.
+ * A sprite is drawn after all sprites that are not definitely behind it, or
+ * for overlapping bounding boxes after those with a lower X+Y+Z. Sprites are
+ * moved in front of the first sprite that has to be drawn after them.
+ *
+ * Sprites are mostly in order already, so the order still to be drawn is kept
+ * as a stack onto which the few moved sprites are pushed. Only sprites whose
+ * xmin + ymin is at most xmax + ymax of the current one can have to be drawn
+ * before it, so the unsorted sprites are kept in a list ordered by xmin + ymin
+ * and only its head is searched.
+ */
 static void ViewportSortParentSprites(ParentSpriteToSortVector *psdv)
 {
-	ParentSpriteToDraw **psdvend = psdv->End();
-	ParentSpriteToDraw **psd = psdv->Begin();
-	while (psd != psdvend) {
-		ParentSpriteToDraw *ps = *psd;
+	uint count = psdv->Length();
+	if (count < 2) return;
 
-		if (ps->comparison_done) {
-			psd++;
-			continue;
-		}
+	ParentSpriteToSortVector sprite_order;
+	SmallVector<ParentSpriteSortEntry, 64> sprite_list;
+	uint32 next_order = 0;
 
-		ps->comparison_done = true;
+	for (ParentSpriteToDraw **psd = psdv->End(); psd != psdv->Begin();) {
+		ParentSpriteToDraw *ps = *--psd;
+		ps->order = next_order++;
+		*sprite_order.Append() = ps;
 
-		for (ParentSpriteToDraw **psd2 = psd + 1; psd2 != psdvend; psd2++) {
-			ParentSpriteToDraw *ps2 = *psd2;
+		ParentSpriteSortEntry *entry = sprite_list.Append();
+		entry->key = ps->xmin + ps->ymin;
+		entry->ps = ps;
+	}
+
+	QSortT(sprite_list.Begin(), count, &ParentSpriteSortEntrySorter);
+	for (uint i = 0; i < count; i++) sprite_list[i].next = i + 1;
+	uint list_head = 0;
+
+	ParentSpriteToSortVector preceding;
+	ParentSpriteToDraw **out = psdv->Begin();
 
-			if (ps2->comparison_done) continue;
+	while (sprite_order.Length() != 0) {
+		ParentSpriteToDraw *ps = *(sprite_order.End() - 1);
+		sprite_order.Erase(sprite_order.End() - 1);
+
+		if (ps->order == ORDER_RETURNED) continue;
+
+		if (ps->order == ORDER_COMPARED) {
+			/* All sprites that had to be drawn before this one are drawn. */
+			*out++ = ps;
+			ps->order = ORDER_RETURNED;
+			continue;
+		}
+
+		/* Search the unsorted sprites that have to be drawn before this one.
+		 * The minimal coordinates can be larger than the maximal ones, so use
+		 * the larger of both to be sure to find the sprite itself in the list. */
+		preceding.Clear();
+		int32 max_key = max(ps->xmin, ps->xmax) + max(ps->ymin, ps->ymax);
+		uint *link = &list_head;
+		while (*link != count && sprite_list[*link].key <= max_key) {
+			ParentSpriteSortEntry *entry = &sprite_list[*link];
+			ParentSpriteToDraw *ps2 = entry->ps;
+
+			if (ps2 == ps) {
+				/* Remove the sprite itself from the list of unsorted sprites. */
+				*link = entry->next;
+				continue;
+			}
+			link = &entry->next;
 
 			/* Decide which comparator to use, based on whether the bounding
 			 * boxes overlap
@@ -1344,28 +1499,42 @@ static void ViewportSortParentSprites(ParentSpriteToSortVector *psdv)
 				}
 			}
 
-			/* Move ps2 in front of ps */
-			ParentSpriteToDraw *temp = ps2;
-			for (ParentSpriteToDraw **psd3 = psd2; psd3 > psd; psd3--) {
-				*psd3 = *(psd3 - 1);
-			}
-			*psd = temp;
+			*preceding.Append() = ps2;
+		}
+
+		if (preceding.Length() == 0) {
+			*out++ = ps;
+			ps->order = ORDER_RETURNED;
+			continue;
+		}
+
+		/* Draw this sprite after the preceding ones. Those are moved in front
+		 * of it, each one in front of the one found before it. */
+		ps->order = ORDER_COMPARED;
+		*sprite_order.Append() = ps;
+
+		QSortT(preceding.Begin(), preceding.Length(), &ParentSpriteOrderSorter, true);
+		for (ParentSpriteToDraw **psd = preceding.Begin(); psd != preceding.End(); psd++) {
+			(*psd)->order = next_order++;
+			*sprite_order.Append() = *psd;
 		}
 	}
+
+	assert(out == psdv->End());
 }
 
-static void ViewportDrawParentSprites(const ParentSpriteToSortVector *psd, const ChildScreenSpriteToDrawVector *csstdv)
+static void ViewportDrawParentSprites(const ViewportDrawer *vd)
 {
-	const ParentSpriteToDraw * const *psd_end = psd->End();
-	for (const ParentSpriteToDraw * const *it = psd->Begin(); it != psd_end; it++) {
+	const ParentSpriteToDraw * const *psd_end = vd->parent_sprites_to_sort.End();
+	for (const ParentSpriteToDraw * const *it = vd->parent_sprites_to_sort.Begin(); it != psd_end; it++) {
 		const ParentSpriteToDraw *ps = *it;
-		if (ps->image != SPR_EMPTY_BOUNDING_BOX) DrawSpriteViewport(ps->image, ps->pal, ps->x, ps->y, ps->sub);
+		if (ps->image != SPR_EMPTY_BOUNDING_BOX) ViewportDrawSprite(vd, ps, ps->x, ps->y);
 
 		int child_idx = ps->first_child;
 		while (child_idx >= 0) {
-			const ChildScreenSpriteToDraw *cs = csstdv->Get(child_idx);
+			const ChildScreenSpriteToDraw *cs = vd->child_screen_sprites_to_draw.Get(child_idx);
 			child_idx = cs->next;
-			DrawSpriteViewport(cs->image, cs->pal, ps->left + cs->x, ps->top + cs->y, cs->sub);
+			ViewportDrawSprite(vd, cs, ps->left + cs->x, ps->top + cs->y);
 		}
 	}
 }
@@ -1467,59 +1636,114 @@ static void ViewportDrawStrings(DrawPixelInfo *dpi, const StringSpriteToDrawVect
 	}
 }
 
-void ViewportDoDraw(const ViewPort *vp, int left, int top, int right, int bottom)
+/**
+ * Collect the sprites of a part of a viewport in the current drawer.
+ * @param vp     The viewport to draw.
+ * @param left   Left edge of the part, in virtual coordinates.
+ * @param top    Top edge of the part, in virtual coordinates.
+ * @param right  Right edge of the part, in virtual coordinates.
+ * @param bottom Bottom edge of the part, in virtual coordinates.
+ */
+static void ViewportCollectSprites(const ViewPort *vp, int left, int top, int right, int bottom)
 {
 	DrawPixelInfo *old_dpi = _cur_dpi;
-	_cur_dpi = &_vd.dpi;
+	_cur_dpi = &_vd->dpi;
 
-	_vd.dpi.zoom = vp->zoom;
+	_vd->dpi.zoom = vp->zoom;
 	int mask = ScaleByZoom(-1, vp->zoom);
 
-	_vd.combine_sprites = SPRITE_COMBINE_NONE;
+	_vd->combine_sprites = SPRITE_COMBINE_NONE;
+	_vd->sprites_prepared = false;
 
-	_vd.dpi.width = (right - left) & mask;
-	_vd.dpi.height = (bottom - top) & mask;
-	_vd.dpi.left = left & mask;
-	_vd.dpi.top = top & mask;
-	_vd.dpi.pitch = old_dpi->pitch;
-	_vd.last_child = NULL;
+	_vd->dpi.width = (right - left) & mask;
+	_vd->dpi.height = (bottom - top) & mask;
+	_vd->dpi.left = left & mask;
+	_vd->dpi.top = top & mask;
+	_vd->dpi.pitch = old_dpi->pitch;
+	_vd->last_child = NULL;
 
-	int x = UnScaleByZoom(_vd.dpi.left - (vp->virtual_left & mask), vp->zoom) + vp->left;
-	int y = UnScaleByZoom(_vd.dpi.top - (vp->virtual_top & mask), vp->zoom) + vp->top;
+	int x = UnScaleByZoom(_vd->dpi.left - (vp->virtual_left & mask), vp->zoom) + vp->left;
+	int y = UnScaleByZoom(_vd->dpi.top - (vp->virtual_top & mask), vp->zoom) + vp->top;
 
-	_vd.dpi.dst_ptr = BlitterFactoryBase::GetCurrentBlitter()->MoveTo(old_dpi->dst_ptr, x - old_dpi->left, y - old_dpi->top);
+	_vd->dpi.dst_ptr = BlitterFactoryBase::GetCurrentBlitter()->MoveTo(old_dpi->dst_ptr, x - old_dpi->left, y - old_dpi->top);
 
 	ViewportAddLandscape();
-	ViewportAddVehicles(&_vd.dpi);
+	ViewportAddVehicles(&_vd->dpi);
 
-	ViewportAddTownNames(&_vd.dpi);
-	ViewportAddStationNames(&_vd.dpi);
-	ViewportAddSigns(&_vd.dpi);
+	ViewportAddTownNames(&_vd->dpi);
+	ViewportAddStationNames(&_vd->dpi);
+	ViewportAddSigns(&_vd->dpi);
 
-	DrawTextEffects(&_vd.dpi);
+	DrawTextEffects(&_vd->dpi);
 
-	if (_vd.tile_sprites_to_draw.Length() != 0) ViewportDrawTileSprites(&_vd.tile_sprites_to_draw);
+	_cur_dpi = old_dpi;
+}
+
+/**
+ * Sort and draw the sprites collected by a drawer.
+ * When the sprites are prepared by #ViewportPrepareSprites this neither
+ * accesses the sprite cache nor any other global state, so then different
+ * drawers can be drawn by different threads.
+ * @param vd The drawer to draw.
+ */
+static void ViewportDrawSprites(ViewportDrawer *vd)
+{
+	if (vd->tile_sprites_to_draw.Length() != 0) ViewportDrawTileSprites(vd);
 
-	ParentSpriteToDraw *psd_end = _vd.parent_sprites_to_draw.End();
-	for (ParentSpriteToDraw *it = _vd.parent_sprites_to_draw.Begin(); it != psd_end; it++) {
-		*_vd.parent_sprites_to_sort.Append() = it;
+	ParentSpriteToDraw *psd_end = vd->parent_sprites_to_draw.End();
+	for (ParentSpriteToDraw *it = vd->parent_sprites_to_draw.Begin(); it != psd_end; it++) {
+		*vd->parent_sprites_to_sort.Append() = it;
 	}
 
-	ViewportSortParentSprites(&_vd.parent_sprites_to_sort);
-	ViewportDrawParentSprites(&_vd.parent_sprites_to_sort, &_vd.child_screen_sprites_to_draw);
+	ViewportSortParentSprites(&vd->parent_sprites_to_sort);
+	ViewportDrawParentSprites(vd);
+}
+
+/**
+ * Draw the strings and debug overlays of a drawer on top of its sprites, and empty the drawer.
+ * @param vd The drawer to finish.
+ */
+static void ViewportDrawOverlays(ViewportDrawer *vd)
+{
+	DrawPixelInfo *old_dpi = _cur_dpi;
+	_cur_dpi = &vd->dpi;
 
-	if (_draw_bounding_boxes) ViewportDrawBoundingBoxes(&_vd.parent_sprites_to_sort);
+	if (_draw_bounding_boxes) ViewportDrawBoundingBoxes(&vd->parent_sprites_to_sort);
 	if (_draw_dirty_blocks) ViewportDrawDirtyBlocks();
 
-	if (_vd.string_sprites_to_draw.Length() != 0) ViewportDrawStrings(&_vd.dpi, &_vd.string_sprites_to_draw);
+	if (vd->string_sprites_to_draw.Length() != 0) ViewportDrawStrings(&vd->dpi, &vd->string_sprites_to_draw);
 
 	_cur_dpi = old_dpi;
 
-	_vd.string_sprites_to_draw.Clear();
-	_vd.tile_sprites_to_draw.Clear();
-	_vd.parent_sprites_to_draw.Clear();
-	_vd.parent_sprites_to_sort.Clear();
-	_vd.child_screen_sprites_to_draw.Clear();
+	vd->string_sprites_to_draw.Clear();
+	vd->tile_sprites_to_draw.Clear();
+	vd->parent_sprites_to_draw.Clear();
+	vd->parent_sprites_to_sort.Clear();
+	vd->child_screen_sprites_to_draw.Clear();
+}
+
+void ViewportDoDraw(const ViewPort *vp, int left, int top, int right, int bottom)
+{
+	ViewportCollectSprites(vp, left, top, right, bottom);
+	ViewportDrawSprites(_vd);
+	ViewportDrawOverlays(_vd);
+}
+
+/**
+ * Collect the sprites of a part of a viewport in a new piece, to be drawn later.
+ * @param vp     The viewport to draw.
+ * @param left   Left edge of the part, in virtual coordinates.
+ * @param top    Top edge of the part, in virtual coordinates.
+ * @param right  Right edge of the part, in virtual coordinates.
+ * @param bottom Bottom edge of the part, in virtual coordinates.
+ */
+static void ViewportCollectPiece(const ViewPort *vp, int left, int top, int right, int bottom)
+{
+	if (_vd_num_pieces == _vd_pieces.Length()) *_vd_pieces.Append() = new ViewportDrawer();
+
+	_vd = _vd_pieces[_vd_num_pieces++];
+	ViewportCollectSprites(vp, left, top, right, bottom);
+	_vd = &_vd_main;
 }
 
 /**
@@ -1539,15 +1763,197 @@ static void ViewportDrawChk(const ViewPort *vp, int left, int top, int right, in
 			ViewportDrawChk(vp, t, top, right, bottom);
 		}
 	} else {
-		ViewportDoDraw(vp,
-			ScaleByZoom(left - vp->left, vp->zoom) + vp->virtual_left,
-			ScaleByZoom(top - vp->top, vp->zoom) + vp->virtual_top,
-			ScaleByZoom(right - vp->left, vp->zoom) + vp->virtual_left,
-			ScaleByZoom(bottom - vp->top, vp->zoom) + vp->virtual_top
-		);
+		int l = ScaleByZoom(left - vp->left, vp->zoom) + vp->virtual_left;
+		int t = ScaleByZoom(top - vp->top, vp->zoom) + vp->virtual_top;
+		int r = ScaleByZoom(right - vp->left, vp->zoom) + vp->virtual_left;
+		int b = ScaleByZoom(bottom - vp->top, vp->zoom) + vp->virtual_top;
+
+		if (_vd_collect_pieces) {
+			ViewportCollectPiece(vp, l, t, r, b);
+		} else {
+			ViewportDoDraw(vp, l, t, r, b);
+		}
 	}
 }
 
+/** Band of the screen drawn by a single thread; the range of pieces in #_vd_pieces within it. */
+struct ViewportDrawBand {
+	uint first; ///< First piece of the band.
+	uint last;  ///< One past the last piece of the band.
+};
+
+static bool _vd_threads_started = false;        ///< Whether the viewport draw threads have been started.
+static uint _vd_num_threads = 0;                ///< Number of viewport draw threads, besides the main thread.
+static ThreadMutex *_vd_band_mutex = NULL;      ///< Mutex for handing out bands; signalled when there are bands to draw.
+static ThreadMutex *_vd_done_mutex = NULL;      ///< Mutex for #_vd_bands_done; signalled when all bands are drawn.
+static const ViewportDrawBand *_vd_bands;       ///< Bands of the viewport that is being drawn.
+static uint _vd_num_bands = 0;                  ///< Number of bands in #_vd_bands.
+static uint _vd_next_band = 0;                  ///< Next band in #_vd_bands to hand out.
+static uint _vd_bands_done = 0;                 ///< Number of bands in #_vd_bands that have been drawn.
+
+/**
+ * Draw the sprites of all pieces in a band of the screen.
+ * @param band The band to draw.
+ */
+static void ViewportDrawBandSprites(const ViewportDrawBand *band)
+{
+	for (uint i = band->first; i != band->last; i++) ViewportDrawSprites(_vd_pieces[i]);
+}
+
+/**
+ * Mark a band as drawn, and wake the main thread when it was the last one.
+ * @param num_bands The number of bands that are being drawn.
+ */
+static void ViewportBandDone(uint num_bands)
+{
+	_vd_done_mutex->BeginCritical();
+	if (++_vd_bands_done == num_bands) _vd_done_mutex->SendSignal();
+	_vd_done_mutex->EndCritical();
+}
+
+/**
+ * Thread that draws the bands of viewports it is handed, for as long as the game runs.
+ * The threads are kept around rather than started for every viewport that
+ * is drawn, as that would mean creating and joining threads for every
+ * dirty part of a viewport, every frame.
+ */
+static void ViewportDrawThread(void *)
+{
+	_vd_band_mutex->BeginCritical();
+	for (;;) {
+		while (_vd_next_band == _vd_num_bands) _vd_band_mutex->WaitForSignal();
+
+		const ViewportDrawBand *band = &_vd_bands[_vd_next_band++];
+		uint num_bands = _vd_num_bands;
+		/* A signal only wakes one thread; let it wake the next one. */
+		if (_vd_next_band != _vd_num_bands) _vd_band_mutex->SendSignal();
+		_vd_band_mutex->EndCritical();
+
+		ViewportDrawBandSprites(band);
+		ViewportBandDone(num_bands);
+
+		_vd_band_mutex->BeginCritical();
+	}
+}
+
+/** Start the viewport draw threads, leaving one core for the main thread that draws as well. */
+static void StartViewportDrawThreads()
+{
+	_vd_threads_started = true;
+	_vd_band_mutex = ThreadMutex::New();
+	_vd_done_mutex = ThreadMutex::New();
+
+	uint num = min<uint>(GetCPUCoreCount(), MAX_VIEWPORT_DRAW_THREADS) - 1;
+	while (_vd_num_threads < num && ThreadObject::New(&ViewportDrawThread, NULL)) _vd_num_threads++;
+}
+
+/**
+ * Draw the sprites of the bands with the viewport draw threads, while this
+ * thread draws bands as well; the bands no other thread took are drawn by
+ * this thread.
+ * @param bands     The bands to draw.
+ * @param num_bands The number of bands.
+ */
+static void ViewportDrawBandsThreaded(const ViewportDrawBand *bands, uint num_bands)
+{
+	_vd_done_mutex->BeginCritical();
+	_vd_bands_done = 0;
+	_vd_done_mutex->EndCritical();
+
+	_vd_band_mutex->BeginCritical();
+	_vd_bands = bands;
+	_vd_num_bands = num_bands;
+	_vd_next_band = 0;
+	_vd_band_mutex->SendSignal();
+
+	while (_vd_next_band != _vd_num_bands) {
+		const ViewportDrawBand *band = &_vd_bands[_vd_next_band++];
+		_vd_band_mutex->EndCritical();
+
+		ViewportDrawBandSprites(band);
+		ViewportBandDone(num_bands);
+
+		_vd_band_mutex->BeginCritical();
+	}
+	_vd_band_mutex->EndCritical();
+
+	_vd_done_mutex->BeginCritical();
+	while (_vd_bands_done != num_bands) _vd_done_mutex->WaitForSignal();
+	_vd_done_mutex->EndCritical();
+
+	_vd_band_mutex->BeginCritical();
+	_vd_num_bands = 0;
+	_vd_next_band = 0;
+	_vd_band_mutex->EndCritical();
+}
+
+/**
+ * Draw a part of a viewport by splitting it into horizontal bands that are each drawn by their own thread.
+ * Collecting the sprites calls into NewGRFs and the sprite cache is not thread
+ * safe, so the sprites of all bands are collected and looked up beforehand by
+ * this thread. Only sorting and blitting them is done in parallel. Strings are
+ * drawn at the end, again by this thread.
+ * @param vp        The viewport to draw.
+ * @param left      Left edge of the part, in screen coordinates.
+ * @param top       Top edge of the part, in screen coordinates.
+ * @param right     Right edge of the part, in screen coordinates.
+ * @param bottom    Bottom edge of the part, in screen coordinates.
+ * @param num_bands Number of bands to split the part into.
+ */
+static void ViewportDrawThreaded(const ViewPort *vp, int left, int top, int right, int bottom, uint num_bands)
+{
+	ViewportDrawBand bands[MAX_VIEWPORT_DRAW_THREADS];
+
+	_vd_collect_pieces = true;
+	_vd_num_pieces = 0;
+	for (uint i = 0; i < num_bands; i++) {
+		bands[i].first = _vd_num_pieces;
+		int band_top = top + (bottom - top) * (int)i / (int)num_bands;
+		int band_bottom = top + (bottom - top) * (int)(i + 1) / (int)num_bands;
+		ViewportDrawChk(vp, left, band_top, right, band_bottom);
+		bands[i].last = _vd_num_pieces;
+	}
+	_vd_collect_pieces = false;
+
+	uint generation = _sprite_cache_generation;
+	for (uint i = 0; i < _vd_num_pieces; i++) ViewportPrepareSprites(_vd_pieces[i]);
+
+	if (!_vd_threads_started) StartViewportDrawThreads();
+
+	bool prepared = _sprite_cache_generation == generation;
+	if (!prepared) {
+		/* Not all sprites fit in the sprite cache at once; so look
+		 * them up again while drawing, and do so in this thread. */
+		for (uint i = 0; i < _vd_num_pieces; i++) _vd_pieces[i]->sprites_prepared = false;
+	}
+
+	if (prepared && _vd_num_threads != 0) {
+		ViewportDrawBandsThreaded(bands, num_bands);
+	} else {
+		for (uint i = 0; i < num_bands; i++) ViewportDrawBandSprites(&bands[i]);
+	}
+
+	for (uint i = 0; i < _vd_num_pieces; i++) ViewportDrawOverlays(_vd_pieces[i]);
+	_vd_num_pieces = 0;
+}
+
+/**
+ * Get the number of bands to split a part of a viewport into, each drawn by its own thread.
+ * @param width  Width of the part, in screen pixels.
+ * @param height Height of the part, in screen pixels.
+ * @return The number of bands; 1 when the part is drawn at once.
+ */
+static uint GetViewportDrawBands(int width, int height)
+{
+	/* Small parts are not worth the trouble of creating threads. */
+	if (!_settings_client.gui.threaded_viewport || width * height < 256 * 256) return 1;
+
+	/* Which sprites are under the mouse is tracked while drawing them. */
+	if (_newgrf_debug_sprite_picker.mode == SPM_REDRAW) return 1;
+
+	return ClampU(min<uint>(GetCPUCoreCount(), height / 32), 1, MAX_VIEWPORT_DRAW_THREADS);
+}
+
 static inline void ViewportDraw(const ViewPort *vp, int left, int top, int right, int bottom)
 {
 	if (right <= vp->left || bottom <= vp->top) return;
@@ -1562,7 +1968,12 @@ static inline void ViewportDraw(const ViewPort *vp, int left, int top, int right
 	if (top < vp->top) top = vp->top;
 	if (bottom > vp->top + vp->height) bottom = vp->top + vp->height;
 
-	ViewportDrawChk(vp, left, top, right, bottom);
+	uint num_bands = GetViewportDrawBands(right - left, bottom - top);
+	if (num_bands > 1) {
+		ViewportDrawThreaded(vp, left, top, right, bottom, num_bands);
+	} else {
+		ViewportDrawChk(vp, left, top, right, bottom);
+	}
 }
 
 /**
@@ -1605,6 +2016,77 @@ static inline void ClampViewportToMap(const ViewPort *vp, int &x, int &y)
 	y -= vp->virtual_height / 2;
 }
 
+/**
+ * Prefetch the sprites of a part of the map, by going through it as if it were drawn.
+ * @param vp     The viewport to prefetch for.
+ * @param left   Left edge of the part, in virtual coordinates.
+ * @param top    Top edge of the part, in virtual coordinates.
+ * @param right  Right edge of the part, in virtual coordinates.
+ * @param bottom Bottom edge of the part, in virtual coordinates.
+ */
+static void ViewportPrefetchArea(const ViewPort *vp, int left, int top, int right, int bottom)
+{
+	if (left >= right || top >= bottom) return;
+
+	DrawPixelInfo *old_dpi = _cur_dpi;
+	_cur_dpi = &_vd->dpi;
+
+	_vd->dpi.zoom = vp->zoom;
+	int mask = ScaleByZoom(-1, vp->zoom);
+
+	_vd->combine_sprites = SPRITE_COMBINE_NONE;
+	_vd->dpi.width = (right - left) & mask;
+	_vd->dpi.height = (bottom - top) & mask;
+	_vd->dpi.left = left & mask;
+	_vd->dpi.top = top & mask;
+	_vd->last_child = NULL;
+
+	ViewportAddLandscape();
+	ViewportAddVehicles(&_vd->dpi);
+
+	_cur_dpi = old_dpi;
+}
+
+/**
+ * Let the sprite decoder threads decode the sprites just outside a viewport,
+ * so they are ready when the viewport is scrolled or zoomed out. This is
+ * done again whenever the viewport gets close to the edge of the area of
+ * which the sprites were prefetched last time.
+ * @param vp The viewport.
+ */
+static void PrefetchViewport(ViewportData *vp)
+{
+	int margin_x = vp->virtual_width / 4;
+	int margin_y = vp->virtual_height / 4;
+	int left = vp->virtual_left;
+	int top = vp->virtual_top;
+	int right = left + vp->virtual_width;
+	int bottom = top + vp->virtual_height;
+
+	Rect &area = vp->prefetched;
+	if (vp->zoom == vp->prefetched_zoom &&
+			left - margin_x / 2 >= area.left && right + margin_x / 2 <= area.right &&
+			top - margin_y / 2 >= area.top && bottom + margin_y / 2 <= area.bottom) {
+		return;
+	}
+
+	if (!HasSpriteDecoders()) return;
+
+	area.left = left - margin_x;
+	area.top = top - margin_y;
+	area.right = right + margin_x;
+	area.bottom = bottom + margin_y;
+	vp->prefetched_zoom = vp->zoom;
+
+	/* What is inside the viewport is being drawn anyway. */
+	_vd_prefetch = true;
+	ViewportPrefetchArea(vp, area.left, area.top, area.right, top);
+	ViewportPrefetchArea(vp, area.left, bottom, area.right, area.bottom);
+	ViewportPrefetchArea(vp, area.left, top, left, bottom);
+	ViewportPrefetchArea(vp, right, top, area.right, bottom);
+	_vd_prefetch = false;
+}
+
 /**
  * Update the viewport position being displayed.
  * @param w %Window owning the viewport.
@@ -1643,6 +2125,8 @@ void UpdateViewportPosition(Window *w)
 
 		SetViewportPosition(w, w->viewport->scrollpos_x, w->viewport->scrollpos_y);
 	}
+
+	PrefetchViewport(w->viewport);
 }
 
 /**
@@ -1713,7 +2197,7 @@ void ConstrainAllViewportsZoom()
 }
 
 /**
- * Mark a tile given by its index dirty for repaint.
+ * Mark a tile given by its index dirty for repaint, both in the viewports and on the smallmap.
  * @param tile The tile to mark dirty.
  * @ingroup dirty
  */
@@ -1726,6 +2210,7 @@ void MarkTileDirtyByTile(TileIndex tile)
 		pt.x - 31  * ZOOM_LVL_BASE + 67  * ZOOM_LVL_BASE,
 		pt.y - 122 * ZOOM_LVL_BASE + 154 * ZOOM_LVL_BASE
 	);
+	MarkSmallMapTileDirty(tile);
 }
 
 /**
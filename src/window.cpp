@@ -21,6 +21,7 @@
 #include "zoom_func.h"
 #include "vehicle_base.h"
 #include "window_func.h"
+#include "spritecache.h"
 #include "tilehighlight_func.h"
 #include "network/network.h"
 #include "querystring_gui.h"
@@ -2613,6 +2614,7 @@ void UpdateWindows()
 		}
 	}
 
+	ProcessDecodedSprites();
 	DrawDirtyBlocks();
 
 	FOR_ALL_WINDOWS_FROM_BACK(w) {
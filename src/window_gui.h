@@ -239,6 +239,8 @@ struct ViewportData : ViewPort {
 	int32 scrollpos_y;        ///< Currently shown y coordinate (virtual screen coordinate of topleft corner of the viewport).
 	int32 dest_scrollpos_x;   ///< Current destination x coordinate to display (virtual screen coordinate of topleft corner of the viewport).
 	int32 dest_scrollpos_y;   ///< Current destination y coordinate to display (virtual screen coordinate of topleft corner of the viewport).
+	Rect prefetched;          ///< Area around the viewport of which the sprites have been prefetched, in virtual coordinates.
+	ZoomLevel prefetched_zoom; ///< Zoom level the sprites in #prefetched have been prefetched for.
 };
 
 /**